@@ -21,6 +21,7 @@
 #include "attack.h"
 #include "cave.h"
 #include "cmds.h"
+#include "game-event.h"
 #include "monster/mon-make.h"
 #include "monster/mon-msg.h"
 #include "monster/mon-timed.h"
@@ -445,6 +446,7 @@ static void ranged_helper(int item, int dir, int range, int shots, ranged_attack
 
 			Term_xtra(TERM_XTRA_DELAY, msec);
 			cave_light_spot(cave, y, x);
+			event_flush();
 
 			Term_fresh();
 			if (p_ptr->redraw) redraw_stuff(p_ptr);
@@ -2401,12 +2401,15 @@ void cave_set_feat(struct cave *c, int y, int x, int feat)
 	 * honors those... */
 
 	c->feat[y][x] = feat;
+	c->feat_changes++;
 
 	if (feat >= FEAT_DOOR_HEAD)
 		c->info[y][x] |= CAVE_WALL;
 	else
 		c->info[y][x] &= ~CAVE_WALL;
 
+	cave_empty_update(c, y, x);
+
 	if (character_dungeon) {
 		cave_note_spot(c, y, x);
 		cave_light_spot(c, y, x);
@@ -2463,7 +2466,8 @@ bool cave_in_bounds_fully(struct cave *c, int y, int x)
  * This algorithm is similar to, but slightly different from, the one used
  * by "update_view_los()", and very different from the one used by "los()".
  */
-int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
+static int project_path_aux(u16b *gp, int range, int y1, int x1, int y2,
+		int x2, int flg)
 {
 	int y, x;
 
@@ -2691,6 +2695,76 @@ int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
 }
 
 
+/*
+ * Recently computed projection paths.  A path depends only on its ends, its
+ * range, PROJECT_THRU and the walls it crosses, so an entry stays good until
+ * a feature in the cave changes.  Paths using PROJECT_STOP depend on where
+ * the monsters are as well, and aren't kept.
+ */
+#define PATH_CACHE_SIZE	512
+#define PATH_CACHE_LEN	MAX_RANGE_LGE
+
+struct path_cache_entry {
+	const struct cave *c;	/* Cave the path was found in, or NULL */
+	u32b feat_changes;	/* c->feat_changes at the time */
+
+	byte y1, x1, y2, x2;
+	byte range;
+	byte thru;
+
+	byte n;
+	u16b grids[PATH_CACHE_LEN];
+};
+
+static struct path_cache_entry path_cache[PATH_CACHE_SIZE];
+
+static void path_cache_clear(void)
+{
+	C_WIPE(path_cache, PATH_CACHE_SIZE, struct path_cache_entry);
+}
+
+int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
+{
+	struct path_cache_entry *e;
+	byte thru = (flg & PROJECT_THRU) ? 1 : 0;
+	u32b h;
+	int n;
+
+	/* Only keep the paths that can be looked up reliably */
+	if ((flg & PROJECT_STOP) || range < 0 || range > PATH_CACHE_LEN ||
+			y1 < 0 || y1 > 255 || x1 < 0 || x1 > 255 ||
+			y2 < 0 || y2 > 255 || x2 < 0 || x2 > 255)
+		return project_path_aux(gp, range, y1, x1, y2, x2, flg);
+
+	h = ((u32b)y1 << 24) | ((u32b)x1 << 16) | ((u32b)y2 << 8) | (u32b)x2;
+	h = (h ^ ((u32b)range << 1) ^ thru) * 2654435761U;
+	e = &path_cache[(h >> 16) & (PATH_CACHE_SIZE - 1)];
+
+	if (e->c == cave && e->feat_changes == cave->feat_changes &&
+			e->y1 == y1 && e->x1 == x1 && e->y2 == y2 && e->x2 == x2 &&
+			e->range == range && e->thru == thru)
+	{
+		memcpy(gp, e->grids, e->n * sizeof *gp);
+		return e->n;
+	}
+
+	n = project_path_aux(gp, range, y1, x1, y2, x2, flg);
+
+	e->c = cave;
+	e->feat_changes = cave->feat_changes;
+	e->y1 = y1;
+	e->x1 = x1;
+	e->y2 = y2;
+	e->x2 = x2;
+	e->range = range;
+	e->thru = thru;
+	e->n = n;
+	memcpy(e->grids, gp, n * sizeof *gp);
+
+	return n;
+}
+
+
 /*
  * Determine if a bolt spell cast from (y1,x1) to (y2,x2) will arrive
  * at the final destination, assuming that no monster gets in the way,
@@ -2836,6 +2910,9 @@ struct cave *cave_new(void) {
 }
 
 void cave_free(struct cave *c) {
+	path_cache_clear();
+	cave_empty_index_free(c);
+
 	mem_free(c->info);
 	mem_free(c->info2);
 	mem_free(c->feat);
@@ -2847,6 +2924,109 @@ void cave_free(struct cave *c) {
 	mem_free(c);
 }
 
+/**
+ * An index of the empty squares of a cave, so that one can be picked at
+ * random in constant time.  Squares are stored as y * DUNGEON_WID + x; pos[]
+ * gives where each square is in squares[], or -1 if it isn't there.
+ *
+ * The index is built on first use by cave_find_empty() and from then on
+ * kept up to date by cave_empty_update(), which must be called whenever a
+ * square's feature, monster or objects change.
+ */
+struct cave_index {
+	int n;
+	int *squares;
+	int *pos;
+};
+
+static void cave_empty_index_build(struct cave *c)
+{
+	struct cave_index *idx = mem_zalloc(sizeof *idx);
+	int y, x;
+
+	idx->squares = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, int);
+	idx->pos = C_ZNEW(DUNGEON_HGT * DUNGEON_WID, int);
+
+	for (y = 0; y < DUNGEON_HGT; y++) {
+		for (x = 0; x < DUNGEON_WID; x++) {
+			int g = y * DUNGEON_WID + x;
+
+			if (cave_in_bounds(c, y, x) && cave_isempty(c, y, x)) {
+				idx->pos[g] = idx->n;
+				idx->squares[idx->n++] = g;
+			} else {
+				idx->pos[g] = -1;
+			}
+		}
+	}
+
+	c->empty = idx;
+}
+
+void cave_empty_index_free(struct cave *c)
+{
+	if (!c->empty) return;
+
+	FREE(c->empty->squares);
+	FREE(c->empty->pos);
+	FREE(c->empty);
+}
+
+/**
+ * Bring the index of empty squares up to date for the square at (y, x).
+ */
+void cave_empty_update(struct cave *c, int y, int x)
+{
+	struct cave_index *idx = c->empty;
+	int g = y * DUNGEON_WID + x;
+	bool empty;
+
+	if (!idx) return;
+
+	empty = cave_in_bounds(c, y, x) && cave_isempty(c, y, x);
+
+	if (empty && idx->pos[g] < 0) {
+		idx->pos[g] = idx->n;
+		idx->squares[idx->n++] = g;
+	} else if (!empty && idx->pos[g] >= 0) {
+		/* Move the last square into the hole */
+		int last = idx->squares[--idx->n];
+
+		idx->squares[idx->pos[g]] = last;
+		idx->pos[last] = idx->pos[g];
+		idx->pos[g] = -1;
+	}
+}
+
+/**
+ * Pick an empty square at random, optionally within y1 <= y < y2,
+ * x1 <= x < x2.  Returns FALSE if there are no empty squares, or none turned
+ * up within the range after a reasonable number of tries.
+ */
+bool cave_find_empty(struct cave *c, int *y, int *x, int y1, int y2, int x1,
+		int x2)
+{
+	struct cave_index *idx;
+	int tries;
+
+	if (!c->empty) cave_empty_index_build(c);
+	idx = c->empty;
+
+	for (tries = 0; tries < 100 && idx->n; tries++) {
+		int g = idx->squares[randint0(idx->n)];
+		int gy = g / DUNGEON_WID;
+		int gx = g % DUNGEON_WID;
+
+		if (gy < y1 || gy >= y2 || gx < x1 || gx >= x2) continue;
+
+		*y = gy;
+		*x = gx;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
 /**
  * FEATURE PREDICATES
  *
@@ -109,6 +109,7 @@ enum
 
 #define ff_has(f, flag)        flag_has_dbg(f, FF_SIZE, flag, #f, #flag)
 #define ff_next(f, flag)       flag_next(f, FF_SIZE, flag)
+#define ff_count(f)            flag_count(f, FF_SIZE)
 #define ff_is_empty(f)         flag_is_empty(f, FF_SIZE)
 #define ff_is_full(f)          flag_is_full(f, FF_SIZE)
 #define ff_is_inter(f1, f2)    flag_is_inter(f1, f2, FF_SIZE)
@@ -209,6 +210,10 @@ struct cave {
 	
 	u16b feeling_squares; /* Keep track of how many feeling squares the player has visited */
 
+	u32b feat_changes; /* Bumped whenever a feature changes, for caches */
+
+	struct cave_index *empty; /* Empty squares, while generating a level */
+
 	byte (*info)[256];
 	byte (*info2)[256];
 	byte (*feat)[DUNGEON_WID];
@@ -252,6 +257,11 @@ extern struct cave *cave;
 extern struct cave *cave_new(void);
 extern void cave_free(struct cave *c);
 
+extern void cave_empty_update(struct cave *c, int y, int x);
+extern bool cave_find_empty(struct cave *c, int *y, int *x, int y1, int y2,
+	int x1, int x2);
+extern void cave_empty_index_free(struct cave *c);
+
 extern struct feature *cave_feat(struct cave *c, int y, int x);
 extern void cave_set_feat(struct cave *c, int y, int x, int feat);
 extern void cave_note_spot(struct cave *c, int y, int x);
@@ -27,6 +27,7 @@
 #include "generate.h"
 #include "grafmode.h"
 #include "init.h"
+#include "journal.h"
 #include "monster/mon-list.h"
 #include "monster/mon-make.h"
 #include "monster/mon-spell.h"
@@ -957,18 +958,28 @@ static void process_player(void)
 	    cmd_get_nrepeats() > 0 ||
 	    (player_is_resting(p_ptr) && !(turn & 0x7F)))
 	{
-		ui_event e;
+		bool abort;
 
-		/* Do not wait */
-		inkey_scan = SCAN_INSTANT;
+		if (journal_is_replaying()) {
+			/* Interrupt where the player did */
+			abort = journal_replay_interrupt();
+		} else {
+			ui_event e;
 
-		/* Check for a key */
-		e = inkey_ex();
-		if (e.type != EVT_NONE) {
+			/* Do not wait */
+			inkey_scan = SCAN_INSTANT;
+
+			/* Check for a key */
+			e = inkey_ex();
+			abort = (e.type != EVT_NONE);
+		}
+
+		if (abort) {
 			/* Flush and disturb */
 			flush();
 			disturb(p_ptr, 0, 0);
 			msg("Cancelled.");
+			journal_record_interrupt();
 		}
 	}
 
@@ -1592,7 +1603,11 @@ void play_game(void)
 
 	p_ptr->is_dead = TRUE;
 
-	if (savefile[0] && file_exists(savefile)) {
+	/* Replays start from one of the journal's checkpoints */
+	if (journal_is_replaying()) {
+		if (!savefile_load(journal_replay_savefile()))
+			quit("broken journal checkpoint");
+	} else if (savefile[0] && file_exists(savefile)) {
 		if (!savefile_load(savefile))
 			quit("broken savefile");
 
@@ -1728,6 +1743,9 @@ void play_game(void)
 	/* Hack -- Enforce "delayed death" */
 	if (p_ptr->chp < 0) p_ptr->is_dead = TRUE;
 
+	/* Start recording (or check the replay) */
+	journal_begin();
+
 	/* Process */
 	while (TRUE)
 	{
@@ -40,6 +40,7 @@ extern const char *inscrip_text[];
 extern const char *copyright;
 extern bool arg_wizard;
 extern bool arg_rebalance;
+extern bool arg_journal;
 extern int arg_graphics;
 extern bool arg_graphics_nice;
 extern bool character_generated;
@@ -122,6 +123,7 @@ extern struct keypress *inkey_next;
 
 /* randart.c */
 extern errr do_randart(u32b randart_seed, bool full);
+extern bool randart_verbose;
 
 /* score.c */
 extern void enter_score(time_t *death_time);
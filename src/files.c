@@ -23,6 +23,7 @@
 #include "files.h"
 #include "game-cmd.h"
 #include "history.h"
+#include "journal.h"
 #include "object/tvalsval.h"
 #include "object/pval.h"
 #include "option.h"
@@ -1662,9 +1663,10 @@ void save_game(void)
 	signals_ignore_tstp();
 
 	/* Save the player */
-	if (savefile_save(savefile))
+	if (savefile_save(savefile)) {
 		prt("Saving game... done.", 0, 0);
-	else
+		journal_checkpoint();
+	} else
 		prt("Saving game... failed!", 0, 0);
 
 	/* Allow suspend again */
@@ -20,6 +20,7 @@
 #include "attack.h"
 #include "cmds.h"
 #include "game-cmd.h"
+#include "journal.h"
 #include "object/object.h"
 #include "object/tvalsval.h"
 #include "spells.h"
@@ -27,16 +28,40 @@
 
 errr (*cmd_get_hook)(cmd_context c, bool wait);
 
+/*
+ * The command queue is a ring buffer which starts out in static storage and
+ * grows (doubling) up to CMD_QUEUE_MAX entries when producers such as the
+ * borg or a scripted front end submit commands faster than they are drained.
+ */
 #define CMD_QUEUE_SIZE 20
-#define prev_cmd_idx(idx) ((idx + CMD_QUEUE_SIZE - 1) % CMD_QUEUE_SIZE)
+#define CMD_QUEUE_MAX 1280
+#define prev_cmd_idx(idx) ((idx + cmd_queue_size - 1) % cmd_queue_size)
 
 static int cmd_head = 0;
 static int cmd_tail = 0;
-static game_command cmd_queue[CMD_QUEUE_SIZE];
+static game_command cmd_queue_base[CMD_QUEUE_SIZE];
+static game_command *cmd_queue = cmd_queue_base;
+static int cmd_queue_size = CMD_QUEUE_SIZE;
+
+/*
+ * Buffers replaced by cmd_queue_reserve() while a handler may still be using
+ * its arguments.  Handlers nest (stores run commands from inside one), so
+ * these are only released once the outermost handler has returned.  The
+ * queue can only double a few times before reaching CMD_QUEUE_MAX, which
+ * bounds how many there can be.
+ */
+#define CMD_QUEUE_RETIRED 8
+static game_command *cmd_queue_retired[CMD_QUEUE_RETIRED];
+static int cmd_queue_num_retired = 0;
+
+static struct cmd_queue_stats queue_stats;
 
 static bool repeat_prev_allowed = FALSE;
 static bool repeating = FALSE;
 
+/* Number of command handlers currently running (stores nest commands) */
+static int cmd_depth = 0;
+
 /* A simple list of commands and their handling functions. */
 struct command_info
 {
@@ -161,20 +186,87 @@ const char *cmd_get_verb(cmd_code cmd)
 	return NULL;
 }
 
+/*
+ * Return the argument types which argument `n` of the given command accepts.
+ */
+int cmd_arg_type(cmd_code cmd, int n)
+{
+	size_t i;
+
+	assert(n < CMD_MAX_ARGS);
+
+	for (i = 0; i < N_ELEMENTS(game_cmds); i++) {
+		if (game_cmds[i].cmd == cmd)
+			return game_cmds[i].arg_type[n];
+	}
+	return arg_NONE;
+}
+
 game_command *cmd_get_top(void)
 {
 	return &cmd_queue[prev_cmd_idx(cmd_head)];
 }
 
+/*
+ * Return the number of commands waiting to be carried out.
+ */
+static int cmd_queue_count(void)
+{
+	return (cmd_head - cmd_tail + cmd_queue_size) % cmd_queue_size;
+}
 
 /*
- * Insert the given command into the command queue.
+ * Make room for at least `n` more commands, growing the queue if needed.
+ *
+ * One slot is always kept free so that a full queue can be told apart from
+ * an empty one, and so that the last command taken off the queue stays
+ * available for repeating.  Returns FALSE if the queue would exceed
+ * CMD_QUEUE_MAX.
  */
-errr cmd_insert_s(game_command *cmd)
+static bool cmd_queue_reserve(int n)
 {
-	/* If queue full, return error */
-	if (cmd_head + 1 == cmd_tail) return 1;
-	if (cmd_head + 1 == CMD_QUEUE_SIZE && cmd_tail == 0) return 1;
+	int count = cmd_queue_count();
+	int size = cmd_queue_size;
+	game_command *new_queue;
+	int i;
+
+	if (count + n < cmd_queue_size) return TRUE;
+
+	while (count + n >= size && size < CMD_QUEUE_MAX)
+		size *= 2;
+	if (size > CMD_QUEUE_MAX) size = CMD_QUEUE_MAX;
+	if (count + n >= size) return FALSE;
+
+	/* Linearise, keeping the last command taken so it can be repeated */
+	new_queue = C_ZNEW(size, game_command);
+	for (i = 0; i <= count; i++)
+		new_queue[i] = cmd_queue[(prev_cmd_idx(cmd_tail) + i) % cmd_queue_size];
+
+	/* Running commands may still point into the old buffer */
+	if (cmd_queue != cmd_queue_base)
+	{
+		assert(cmd_queue_num_retired < CMD_QUEUE_RETIRED);
+		cmd_queue_retired[cmd_queue_num_retired++] = cmd_queue;
+	}
+
+	cmd_queue = new_queue;
+	cmd_queue_size = size;
+	cmd_tail = 1;
+	cmd_head = count + 1;
+
+	queue_stats.grows++;
+	queue_stats.capacity = size - 1;
+
+	return TRUE;
+}
+
+/*
+ * Copy a command into the slot at the head of the queue and advance it.
+ * Space must already have been reserved.
+ */
+static errr cmd_queue_push(const game_command *cmd)
+{
+	int count;
 
 	/* Insert command into queue. */
 	if (cmd->command != CMD_REPEAT)
@@ -183,23 +275,112 @@ errr cmd_insert_s(game_command *cmd)
 	}
 	else
 	{
-		int cmd_prev = cmd_head - 1;
+		int cmd_prev = prev_cmd_idx(cmd_head);
 
 		if (!repeat_prev_allowed) return 1;
 
 		/* If we're repeating a command, we duplicate the previous command 
 		   in the next command "slot". */
-		if (cmd_prev < 0) cmd_prev = CMD_QUEUE_SIZE - 1;
-		
 		if (cmd_queue[cmd_prev].command != CMD_NULL)
 			cmd_queue[cmd_head] = cmd_queue[cmd_prev];
 	}
 
+	/* Remember whether this was queued by a command or by the UI */
+	cmd_queue[cmd_head].depth = cmd_depth;
+
 	/* Advance point in queue, wrapping around at the end */
 	cmd_head++;
-	if (cmd_head == CMD_QUEUE_SIZE) cmd_head = 0;
+	if (cmd_head == cmd_queue_size) cmd_head = 0;
 
-	return 0;	
+	queue_stats.inserted++;
+	count = cmd_queue_count();
+	if (count > queue_stats.high_water)
+		queue_stats.high_water = count;
+
+	return 0;
+}
+
+/*
+ * Insert the given command into the command queue.
+ */
+errr cmd_insert_s(game_command *cmd)
+{
+	/* If queue full and can't grow, return error */
+	if (!cmd_queue_reserve(1))
+	{
+		queue_stats.rejected++;
+		return 1;
+	}
+
+	return cmd_queue_push(cmd);
+}
+
+/*
+ * Insert `n` commands into the command queue in order.
+ *
+ * Either all of the commands are queued or, if there isn't room for them
+ * all, none are and an error is returned so the caller can retry later.
+ */
+errr cmd_insert_batch(const game_command *cmds, size_t n)
+{
+	size_t i;
+
+	if (n == 0) return 0;
+
+	if (n > CMD_QUEUE_MAX || !cmd_queue_reserve((int) n))
+	{
+		queue_stats.rejected += n;
+		return 1;
+	}
+
+	queue_stats.batches++;
+	for (i = 0; i < n; i++)
+		cmd_queue_push(&cmds[i]);
+
+	return 0;
+}
+
+/*
+ * Return how many more commands can be queued before insertion fails.
+ */
+int cmd_queue_space(void)
+{
+	return CMD_QUEUE_MAX - 1 - cmd_queue_count();
+}
+
+/*
+ * Fill in the queue statistics, for producers which want to apply
+ * backpressure rather than lose commands.
+ */
+void cmd_queue_get_stats(struct cmd_queue_stats *stats)
+{
+	*stats = queue_stats;
+	stats->queued = cmd_queue_count();
+	stats->capacity = cmd_queue_size - 1;
+}
+
+/*
+ * Free the buffers left behind by the queue growing.
+ */
+static void cmd_queue_release(void)
+{
+	while (cmd_queue_num_retired > 0)
+		FREE(cmd_queue_retired[--cmd_queue_num_retired]);
+}
+
+/*
+ * Release any memory used by the command queue and reset it to empty.
+ */
+void cmd_queue_free(void)
+{
+	if (cmd_queue != cmd_queue_base) mem_free(cmd_queue);
+	cmd_queue_release();
+
+	cmd_queue = cmd_queue_base;
+	cmd_queue_size = CMD_QUEUE_SIZE;
+	cmd_head = cmd_tail = 0;
+	C_WIPE(cmd_queue_base, CMD_QUEUE_SIZE, game_command);
+	WIPE(&queue_stats, struct cmd_queue_stats);
 }
 
 /*
@@ -216,15 +397,15 @@ errr cmd_get(cmd_context c, game_command **cmd, bool wait)
 		return 0;
 	}
 
-	/* If there are no commands queued, ask the UI for one. */
-	if (cmd_head == cmd_tail) 
+	/* If there are no commands queued, ask the journal or the UI for one. */
+	if (cmd_head == cmd_tail && !journal_replay_next(c))
 		cmd_get_hook(c, wait);
 
 	/* If we have a command ready, set it and return success. */
 	if (cmd_head != cmd_tail)
 	{
 		*cmd = &cmd_queue[cmd_tail++];
-		if (cmd_tail == CMD_QUEUE_SIZE) cmd_tail = 0;
+		if (cmd_tail == cmd_queue_size) cmd_tail = 0;
 
 		return 0;
 	}
@@ -233,6 +414,22 @@ errr cmd_get(cmd_context c, game_command **cmd, bool wait)
 	return 1;
 }
 
+/*
+ * Run `fn` on the arguments of `cmd`, which must be on the queue.
+ *
+ * The handler may queue and run further commands itself, so `cmd` may have
+ * moved by the time this returns; its old buffer stays valid until the
+ * outermost handler is done.
+ */
+void cmd_run_handler(cmd_handler_fn fn, game_command *cmd)
+{
+	cmd_depth++;
+	fn(cmd->command, cmd->arg);
+	cmd_depth--;
+
+	if (!cmd_depth) cmd_queue_release();
+}
+
 /* Return the index of the given command in the command array. */
 static int cmd_idx(cmd_code code)
 {
@@ -366,6 +563,9 @@ void process_command(cmd_context ctx, bool no_request)
 {
 	game_command *cmd;
 
+	/* Repeats of a command aren't fresh commands */
+	bool fresh = !repeating;
+
 	/* Reset so that when selecting items, we look in the default location */
 	p_ptr->command_wrk = 0;
 
@@ -436,6 +636,10 @@ void process_command(cmd_context ctx, bool no_request)
 				char tmp[80] = "";
 
 				object_type *o_ptr = object_from_item_idx(cmd->arg[0].item);
+
+				/* Already know what to inscribe */
+				if (cmd->arg_present[1])
+					break;
 			
 				object_desc(o_name, sizeof(o_name), o_ptr, ODESC_PREFIX | ODESC_FULL);
 				msg("Inscribing %s.", o_name);
@@ -657,6 +861,13 @@ void process_command(cmd_context ctx, bool no_request)
 			}
 		}
 
+		/*
+		 * Journal the command.  Those queued by other commands (which have
+		 * since finished) are left out, as replaying will queue them again.
+		 */
+		if (fresh && cmd->depth <= cmd_depth)
+			journal_record_cmd(ctx, cmd);
+
 		/* Command repetition */
 		if (game_cmds[idx].repeat_allowed)
 		{
@@ -677,7 +888,10 @@ void process_command(cmd_context ctx, bool no_request)
 		repeat_prev_allowed = TRUE;
 
 		if (game_cmds[idx].fn)
-			game_cmds[idx].fn(cmd->command, cmd->arg);
+			cmd_run_handler(game_cmds[idx].fn, cmd);
+
+		/* The queue may have grown while the command ran */
+		cmd = &cmd_queue[prev_cmd_idx(cmd_tail)];
 
 		/* If the command hasn't changed nrepeats, count this execution. */
 		if (cmd->nrepeats > 0 && oldrepeats == cmd_get_nrepeats())
@@ -178,6 +178,9 @@ typedef struct game_command
 
 	/* Types of the arguments passed */
 	enum cmd_arg_type arg_type[CMD_MAX_ARGS];
+
+	/* Number of commands being carried out when this one was queued */
+	int depth;
 } game_command;
 
 /* 
@@ -193,6 +196,11 @@ typedef void (*cmd_handler_fn)(cmd_code code, cmd_arg args[]);
  */
 const char *cmd_get_verb(cmd_code cmd);
 
+/**
+ * Returns the argument types allowed for argument `n` of a command.
+ */
+int cmd_arg_type(cmd_code cmd, int n);
+
 /**
  * Returns the top command on the queue.
  */
@@ -203,9 +211,38 @@ game_command *cmd_get_top(void);
  */
 extern errr (*cmd_get_hook)(cmd_context c, bool wait);
 
+/*
+ * Counters describing how the command queue is being used.
+ */
+struct cmd_queue_stats
+{
+	int queued;		/* Commands currently waiting */
+	int capacity;		/* Commands the queue can hold before growing */
+	int high_water;		/* Most commands ever waiting at once */
+	u32b inserted;		/* Commands successfully queued */
+	u32b rejected;		/* Commands refused because the queue was full */
+	u32b batches;		/* Successful cmd_insert_batch() calls */
+	u32b grows;		/* Times the queue has been enlarged */
+};
+
 /* Inserts a command in the queue to be carried out. */
 errr cmd_insert_s(game_command *cmd);
 
+/* Inserts several commands, all or nothing. */
+errr cmd_insert_batch(const game_command *cmds, size_t n);
+
+/* Number of commands that can still be queued. */
+int cmd_queue_space(void);
+
+/* Fetch usage counters for the command queue. */
+void cmd_queue_get_stats(struct cmd_queue_stats *stats);
+
+/* Free the command queue and reset it. */
+void cmd_queue_free(void);
+
+/* Run a handler on a queued command's arguments. */
+void cmd_run_handler(cmd_handler_fn fn, game_command *cmd);
+
 /* 
  * Convenience functions.
  * Insert a command with params in the queue to be carried out.
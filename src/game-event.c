@@ -22,87 +22,164 @@
 
 struct event_handler_entry
 {
-	struct event_handler_entry *next;	
 	game_event_handler *fn;
 	void *user;
 };
 
-static struct event_handler_entry *event_handlers[N_GAME_EVENTS];
+/*
+ * Handlers for one event type, kept in a contiguous array in the order they
+ * were added.  Dispatch walks it backwards so the newest handler is still
+ * called first.
+ */
+struct event_handler_list
+{
+	struct event_handler_entry *entries;
+	size_t count;
+	size_t alloc;
+};
+
+static struct event_handler_list event_handlers[N_GAME_EVENTS];
+static struct game_event_stats event_stats[N_GAME_EVENTS];
+
+/*
+ * Handlers removed while a dispatch is in progress are only blanked, so
+ * that the arrays being walked don't shift underneath the dispatcher; they
+ * are compacted away once the outermost dispatch has finished.
+ */
+static int dispatch_depth = 0;
+static bool handlers_dead = FALSE;
+
+
+/*
+ * Coalescing mode.  While it is on, the events which only ask the UI to
+ * redraw something are held back and delivered once each by event_flush(),
+ * and map points are merged into a set of distinct dirty grids.
+ */
+#define EVENT_MAP_MAX_POINTS	1024
+#define EVENT_MAP_HASH_SIZE	(EVENT_MAP_MAX_POINTS * 2)
+
+static bool coalescing = FALSE;
+static bool flushing = FALSE;
+static bool pending[N_GAME_EVENTS];
+
+static struct {
+	int x, y;
+} map_points[EVENT_MAP_MAX_POINTS];
+static u32b map_hash[EVENT_MAP_HASH_SIZE];
+static size_t map_count = 0;
+static bool map_full = FALSE;
+
+
+static void compact_handlers(void)
+{
+	int type;
+
+	for (type = 0; type < N_GAME_EVENTS; type++) {
+		struct event_handler_list *list = &event_handlers[type];
+		size_t i, n = 0;
+
+		for (i = 0; i < list->count; i++)
+			if (list->entries[i].fn)
+				list->entries[n++] = list->entries[i];
+
+		list->count = n;
+	}
+
+	handlers_dead = FALSE;
+}
 
 static void game_event_dispatch(game_event_type type, game_event_data *data)
 {
-	struct event_handler_entry *this = event_handlers[type];
+	struct event_handler_list *list = &event_handlers[type];
+	size_t i;
+
+	event_stats[type].dispatched++;
+
+	dispatch_depth++;
 
 	/* 
-	 * Send the word out to all interested event handlers.
+	 * Send the word out to all interested event handlers.  Handlers added
+	 * during the dispatch go on the end of the array and so aren't called
+	 * this time round.
 	 */
-	while (this)
+	for (i = list->count; i-- > 0; )
 	{
+		/* Copy out the entry, as the handler may grow the array */
+		struct event_handler_entry this = list->entries[i];
+
+		if (!this.fn) continue;
+
 		/* Call the handler with the relevant data */
-		this->fn(type, data, this->user);
-		this = this->next;
+		event_stats[type].calls++;
+		this.fn(type, data, this.user);
 	}
+
+	dispatch_depth--;
+
+	if (!dispatch_depth && handlers_dead)
+		compact_handlers();
 }
 
 void event_add_handler(game_event_type type, game_event_handler *fn, void *user)
 {
-	struct event_handler_entry *new;
+	struct event_handler_list *list = &event_handlers[type];
 
 	assert(fn != NULL);
 
-	/* Make a new entry */
-	new = mem_alloc(sizeof *new);
-	new->fn = fn;
-	new->user = user;
+	if (list->count == list->alloc)
+	{
+		list->alloc = list->alloc ? list->alloc * 2 : 4;
+		list->entries = mem_realloc(list->entries,
+				list->alloc * sizeof *list->entries);
+	}
 
-	/* Add it to the head of the appropriate list */
-	new->next = event_handlers[type];
-	event_handlers[type] = new;
+	/* Add it to the end of the appropriate array */
+	list->entries[list->count].fn = fn;
+	list->entries[list->count].user = user;
+	list->count++;
 }
 
 void event_remove_handler(game_event_type type, game_event_handler *fn, void *user)
 {
-	struct event_handler_entry *prev = NULL;
-	struct event_handler_entry *this = event_handlers[type];
+	struct event_handler_list *list = &event_handlers[type];
+	size_t i;
 
-	/* Look for the entry in the list */
-	while (this)
+	/* Look for the newest matching entry */
+	for (i = list->count; i-- > 0; )
 	{
+		struct event_handler_entry *this = &list->entries[i];
+
 		/* Check if this is the entry we want to remove */
 		if (this->fn == fn && this->user == user)
 		{
-			if (!prev)
+			if (dispatch_depth)
 			{
-				event_handlers[type] = this->next;
+				this->fn = NULL;
+				handlers_dead = TRUE;
 			}
 			else
 			{
-				prev->next = this->next;
+				memmove(this, this + 1,
+						(list->count - i - 1) * sizeof *this);
+				list->count--;
 			}
 
-			mem_free(this);
 			return;
 		}
-
-		prev = this;
-		this = this->next;
 	}
 }
 
 void event_remove_all_handlers(void)
 {
 	int type;
-	struct event_handler_entry *handler, *next;
 
 	for (type = 0; type < N_GAME_EVENTS; type++) {
-		handler = event_handlers[type];
-		while (handler) {
-			next = handler->next;
-			mem_free(handler);
-			handler = next;
-		}
-		event_handlers[type] = NULL;
+		FREE(event_handlers[type].entries);
+		event_handlers[type].count = 0;
+		event_handlers[type].alloc = 0;
 	}
+
+	handlers_dead = FALSE;
 }
 
 void event_add_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user)
@@ -124,8 +201,141 @@ void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_
 
 
 
+/*
+ * Events which carry no data and only ask the UI to redraw something, so
+ * that several signals before the next flush can be delivered as one.
+ */
+static bool event_can_coalesce(game_event_type type)
+{
+	if (type >= EVENT_STATS && type <= EVENT_STATE)
+		return TRUE;
+
+	if (type >= EVENT_INVENTORY && type <= EVENT_MESSAGE)
+		return TRUE;
+
+	return FALSE;
+}
+
+/*
+ * Add a grid to the dirty set, returning FALSE if it was already there.
+ */
+static bool map_mark(int x, int y)
+{
+	u32b key = ((((u32b)y & 0xFFFF) << 16) | ((u32b)x & 0xFFFF)) + 1;
+	u32b i = (key * 2654435761U) & (EVENT_MAP_HASH_SIZE - 1);
+
+	while (map_hash[i])
+	{
+		if (map_hash[i] == key) return FALSE;
+		i = (i + 1) & (EVENT_MAP_HASH_SIZE - 1);
+	}
+
+	/* Too many grids to be worth doing one at a time */
+	if (map_count == EVENT_MAP_MAX_POINTS)
+	{
+		map_full = TRUE;
+		return TRUE;
+	}
+
+	map_hash[i] = key;
+	map_points[map_count].x = x;
+	map_points[map_count].y = y;
+	map_count++;
+
+	return TRUE;
+}
+
+static void map_clear(void)
+{
+	if (map_count) C_WIPE(map_hash, EVENT_MAP_HASH_SIZE, u32b);
+	map_count = 0;
+	map_full = FALSE;
+}
+
+void event_set_coalescing(bool on)
+{
+	if (!on) event_flush();
+	coalescing = on;
+}
+
+bool event_is_coalescing(void)
+{
+	return coalescing;
+}
+
+void event_flush(void)
+{
+	int type;
+	size_t i;
+
+	/* Events signalled by the handlers go straight through */
+	if (flushing) return;
+	flushing = TRUE;
+
+	for (type = 0; type < N_GAME_EVENTS; type++)
+	{
+		if (!pending[type]) continue;
+
+		pending[type] = FALSE;
+		game_event_dispatch(type, NULL);
+	}
+
+	if (map_full)
+	{
+		game_event_data data;
+		data.point.x = -1;
+		data.point.y = -1;
+
+		game_event_dispatch(EVENT_MAP, &data);
+	}
+	else
+	{
+		for (i = 0; i < map_count; i++)
+		{
+			game_event_data data;
+			data.point.x = map_points[i].x;
+			data.point.y = map_points[i].y;
+
+			game_event_dispatch(EVENT_MAP, &data);
+		}
+	}
+
+	map_clear();
+	flushing = FALSE;
+}
+
+void event_get_stats(game_event_type type, struct game_event_stats *stats)
+{
+	*stats = event_stats[type];
+}
+
+void event_reset_stats(void)
+{
+	C_WIPE(event_stats, N_GAME_EVENTS, struct game_event_stats);
+}
+
+
+
 void event_signal(game_event_type type)
 {
+	event_stats[type].signalled++;
+
+	if (coalescing && !flushing)
+	{
+		if (event_can_coalesce(type))
+		{
+			if (pending[type])
+				event_stats[type].coalesced++;
+
+			pending[type] = TRUE;
+			return;
+		}
+
+		/* Anything held back belongs before the end of an update */
+		if (type == EVENT_END)
+			event_flush();
+	}
+
 	game_event_dispatch(type, NULL);
 }
 
@@ -134,6 +344,7 @@ void event_signal_flag(game_event_type type, bool flag)
 	game_event_data data;
 	data.flag = flag;
 
+	event_stats[type].signalled++;
 	game_event_dispatch(type, &data);
 }
 
@@ -144,6 +355,24 @@ void event_signal_point(game_event_type type, int x, int y)
 	data.point.x = x;
 	data.point.y = y;
 
+	event_stats[type].signalled++;
+
+	if (coalescing && !flushing && type == EVENT_MAP)
+	{
+		/* A whole-map redraw covers every grid */
+		if (x == -1 && y == -1)
+		{
+			if (map_full) event_stats[type].coalesced++;
+			map_full = TRUE;
+		}
+		else if (map_full || !map_mark(x, y))
+		{
+			event_stats[type].coalesced++;
+		}
+
+		return;
+	}
+
 	game_event_dispatch(type, &data);
 }
 
@@ -153,6 +382,7 @@ void event_signal_string(game_event_type type, const char *s)
 	game_event_data data;
 	data.string = s;
 
+	event_stats[type].signalled++;
 	game_event_dispatch(type, &data);
 }
 
@@ -163,6 +393,6 @@ void event_signal_birthpoints(int stats[6], int remaining)
 	data.birthstats.stats = stats;
 	data.birthstats.remaining = remaining;
 
+	event_stats[EVENT_BIRTHPOINTS].signalled++;
 	game_event_dispatch(EVENT_BIRTHPOINTS, &data);
 }
-
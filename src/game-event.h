@@ -109,4 +109,27 @@ void event_signal_string(game_event_type, const char *s);
 void event_signal_flag(game_event_type type, bool flag);
 void event_signal(game_event_type);
 
+/*
+ * Counters kept for each event type, for profiling.  An event which is
+ * "coalesced" was merged into one already waiting to be delivered.
+ */
+struct game_event_stats
+{
+	u32b signalled;		/* Times the event was signalled */
+	u32b coalesced;		/* Signals merged into a pending one */
+	u32b dispatched;	/* Times the handlers were run */
+	u32b calls;		/* Individual handler calls */
+};
+
+/*
+ * In coalescing mode redraw-only events and EVENT_MAP points are held back
+ * until event_flush() (or EVENT_END) and then delivered once each.
+ */
+void event_set_coalescing(bool on);
+bool event_is_coalescing(void);
+void event_flush(void);
+
+void event_get_stats(game_event_type type, struct game_event_stats *stats);
+void event_reset_stats(void);
+
 #endif /* INCLUDED_GAME_EVENT_H */
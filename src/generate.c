@@ -44,6 +44,11 @@ static struct room_template *room_templates;
  */
 static int *cave_squares = NULL;
 
+/**
+ * Where cave_generate() should describe the level it builds, if anywhere.
+ */
+static struct level_summary *gen_summary = NULL;
+
 static bool town_gen(struct cave *c, struct player *p);
 
 static bool default_gen(struct cave *c, struct player *p);
@@ -192,6 +197,10 @@ struct dun_data {
 
 	/* Number of pits/nests on the level */
 	int pit_num;
+
+	/* Vaults built on the level, for level summaries */
+	int vault_n;
+	const char *vault_name[LEVEL_SUMMARY_VAULTS];
 };
 
 
@@ -462,6 +471,7 @@ static bool cave_find_in_range(struct cave *c, int *y, int y1, int y2,
  */
 static bool find_empty(struct cave *c, int *y, int *x)
 {
+	if (cave_find_empty(c, y, x, 0, c->height, 0, c->width)) return TRUE;
 	return cave_find(c, y, x, cave_isempty);
 }
 
@@ -471,6 +481,7 @@ static bool find_empty(struct cave *c, int *y, int *x)
  */
 static bool find_empty_range(struct cave *c, int *y, int y1, int y2, int *x, int x1, int x2)
 {
+	if (cave_find_empty(c, y, x, y1, y2, x1, x2)) return TRUE;
 	return cave_find_in_range(c, y, y1, y2, x, x1, x2, cave_isempty);
 }
 
@@ -2277,6 +2288,11 @@ static bool build_vault_type(struct cave*c, int y0, int x0, int typ, const char
 
 	ROOM_LOG("%s (%s)", label, v_ptr->name);
 
+	/* Remember it for the level summary */
+	if (dun->vault_n < LEVEL_SUMMARY_VAULTS)
+		dun->vault_name[dun->vault_n] = v_ptr->name;
+	dun->vault_n++;
+
 	/* Boost the rating */
 	c->mon_rating += v_ptr->rat;
 
@@ -3174,78 +3190,151 @@ static void init_cavern(struct cave *c, struct player *p, int density) {
 	}
 }
 
+/*
+ * The cellular automaton works on a bitmap of the walls in the cavern, one
+ * bit per square, so that a whole word of squares can be updated at once.
+ */
+#ifdef HAVE_STDINT_H
+typedef u64b cavern_word;
+#else
+typedef u32b cavern_word;
+#endif
+
+#define CAVERN_WORD_BITS	((int)(8 * sizeof(cavern_word)))
+
 /**
- * Return the number of walls (0-8) adjacent to this square.
+ * Add three bitmaps bitwise, giving the low and high bits of each sum.
  */
-static int count_adj_walls(struct cave *c, int y, int x) {
-	int yd, xd;
-	int count = 0;
+static void cavern_add3(cavern_word a, cavern_word b, cavern_word c,
+		cavern_word *lo, cavern_word *hi) {
+	cavern_word t = a ^ b;
+	*lo = t ^ c;
+	*hi = (a & b) | (t & c);
+}
 
-	for (yd = -1; yd <= 1; yd++) {
-		for (xd = -1; xd <= 1; xd++) {
-			if (yd == 0 && xd == 0) continue;
-			if (cave_isfloor(c, y + yd, x + xd)) continue;
-			count++;
+/**
+ * Run one pass of the cellular automata rules (4,5) from one wall bitmap
+ * into another.
+ *
+ * For each word of squares the eight neighbours are lined up by shifting
+ * the rows above, below and alongside, and summed with bitwise adders; a
+ * square with more than five walls around it becomes wall, one with fewer
+ * than four becomes floor, and the rest stay as they are.  The outermost
+ * squares never change.
+ */
+static void mutate_cavern_bits(const cavern_word *from, cavern_word *to,
+		const cavern_word *inner, int h, int nw) {
+	int y, k;
+
+	memcpy(to, from, nw * sizeof *to);
+	memcpy(to + (h - 1) * nw, from + (h - 1) * nw, nw * sizeof *to);
+
+	for (y = 1; y < h - 1; y++) {
+		const cavern_word *row = from + y * nw;
+
+		for (k = 0; k < nw; k++) {
+			cavern_word n[8];
+			cavern_word s1, c1, s2, c2, s3, c3;
+			cavern_word b0, b1, b2, b3, k1, t0, t1, u;
+			cavern_word more, fewer;
+			int i, m = 0;
+
+			/* Line up the neighbours: west and east on each of the three
+			 * rows, plus straight above and below */
+			for (i = -1; i <= 1; i++) {
+				const cavern_word *r = row + i * nw;
+				cavern_word w = r[k] << 1;
+				cavern_word e = r[k] >> 1;
+
+				if (k > 0) w |= r[k - 1] >> (CAVERN_WORD_BITS - 1);
+				if (k < nw - 1) e |= r[k + 1] << (CAVERN_WORD_BITS - 1);
+
+				n[m++] = w;
+				n[m++] = e;
+				if (i) n[m++] = r[k];
+			}
+
+			/* Count them, one bit of the count at a time */
+			cavern_add3(n[0], n[1], n[2], &s1, &c1);
+			cavern_add3(n[3], n[4], n[5], &s2, &c2);
+			s3 = n[6] ^ n[7];
+			c3 = n[6] & n[7];
+			cavern_add3(s1, s2, s3, &b0, &k1);
+			cavern_add3(c1, c2, c3, &t0, &t1);
+			b1 = t0 ^ k1;
+			u = t0 & k1;
+			b2 = t1 ^ u;
+			b3 = t1 & u;
+
+			more = b3 | (b2 & b1);
+			fewer = ~(b3 | b2);
+
+			to[y * nw + k] = (row[k] & ~(inner[k] & fewer)) |
+				(inner[k] & more);
 		}
 	}
-
-	return count;
 }
 
 /**
- * Run a single pass of the cellular automata rules (4,5) on the dungeon.
+ * Run a number of passes of the cellular automata rules (4,5) on the
+ * dungeon, writing the result back once at the end.
  */
-static void mutate_cavern(struct cave *c) {
-	int y, x;
+static void mutate_cavern(struct cave *c, int times) {
+	int y, x, i;
 	int h = c->height;
 	int w = c->width;
+	int nw = (w + CAVERN_WORD_BITS - 1) / CAVERN_WORD_BITS;
 
-	int *temp = C_ZNEW(h * w, int);
+	cavern_word *start = C_ZNEW(h * nw, cavern_word);
+	cavern_word *bits[2];
+	cavern_word *inner = C_ZNEW(nw, cavern_word);
 
-	for (y = 1; y < h - 1; y++) {
-		for (x = 1; x < w - 1; x++) {
-			int count = count_adj_walls(c, y, x);
-			if (count > 5)
-				temp[y * w + x] = FEAT_WALL_SOLID;
-			else if (count < 4)
-				temp[y * w + x] = FEAT_FLOOR;
-			else
-				temp[y * w + x] = cave->feat[y][x];
+	bits[0] = C_ZNEW(h * nw, cavern_word);
+	bits[1] = C_ZNEW(h * nw, cavern_word);
+
+	/* Everything but floor counts as wall, including the padding */
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < nw * CAVERN_WORD_BITS; x++) {
+			if (x < w && cave_isfloor(c, y, x)) continue;
+			start[y * nw + x / CAVERN_WORD_BITS] |=
+				(cavern_word)1 << (x % CAVERN_WORD_BITS);
 		}
 	}
 
+	for (x = 1; x < w - 1; x++)
+		inner[x / CAVERN_WORD_BITS] |= (cavern_word)1 << (x % CAVERN_WORD_BITS);
+
+	memcpy(bits[0], start, h * nw * sizeof *start);
+	for (i = 0; i < times; i++)
+		mutate_cavern_bits(bits[i % 2], bits[(i + 1) % 2], inner, h, nw);
+
+	/* Write back the squares that have changed */
 	for (y = 1; y < h - 1; y++) {
 		for (x = 1; x < w - 1; x++) {
-			cave_set_feat(c, y, x, temp[y * w + x]);
+			int k = y * nw + x / CAVERN_WORD_BITS;
+			cavern_word bit = (cavern_word)1 << (x % CAVERN_WORD_BITS);
+
+			if ((start[k] ^ bits[times % 2][k]) & bit)
+				cave_set_feat(c, y, x, (bits[times % 2][k] & bit) ?
+					FEAT_WALL_SOLID : FEAT_FLOOR);
 		}
 	}
 
-	FREE(temp);
-}
-
-/**
- * Fill an int[] with a single value.
- */
-static void array_filler(int data[], int value, int size) {
-	int i;
-	for (i = 0; i < size; i++) data[i] = value;
+	FREE(start);
+	FREE(inner);
+	FREE(bits[0]);
+	FREE(bits[1]);
 }
 
 /**
- * Determine if we need to worry about coloring a point, or can ignore it.
+ * Determine whether a point belongs to a region, i.e. is open, a door or
+ * part of a vault.
  */
-static int ignore_point(struct cave *c, int colors[], int y, int x) {
-	int h = c->height;
-	int w = c->width;
-	int n = lab_toi(y, x, w);
-
-	if (y < 0 || x < 0 || y >= h || x >= w) return TRUE;
-	if (colors[n]) return TRUE;
-	//if (cave_isvault(c, y, x)) return TRUE;
-	if (cave_isvault(c, y, x)) return FALSE;
-	if (cave_ispassable(c, y, x)) return FALSE;
-	if (cave_isdoor(c, y, x)) return FALSE;
-	return TRUE;
+static bool region_point(struct cave *c, int y, int x) {
+	if (cave_isvault(c, y, x)) return TRUE;
+	if (cave_ispassable(c, y, x)) return TRUE;
+	if (cave_isdoor(c, y, x)) return TRUE;
+	return FALSE;
 }
 
 static int xds[] = {0, 0, 1, -1, -1, -1, 1, 1};
@@ -3261,229 +3350,311 @@ static void glow_point(struct cave *c, int y, int x) {
 #endif
 
 /**
- * Color a particular point, and all adjacent points.
+ * The connected regions of a cave.
+ *
+ * Regions are numbered from 1 in the order their first square is met when
+ * scanning the cave row by row; 0 means "not in any region".  Regions can
+ * be merged, after which the region a square belongs to is found with
+ * region_of().  For each region that hasn't been merged into another, 
+ * counts[] holds its size and first[] the index of its first square.
+ */
+struct regions {
+	int h, w;
+	int num;	/* Number of regions found */
+
+	int *colors;	/* Region each square was found in, by square */
+	int *parent;	/* Region each region has been merged into, by region */
+	int *counts;	/* Squares in each region, by region */
+	int *first;	/* First square of each region, by region */
+};
+
+static int uf_find(int parent[], int i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+/**
+ * Join the sets containing a and b, keeping the lower numbered root.
+ */
+static void uf_union(int parent[], int a, int b) {
+	a = uf_find(parent, a);
+	b = uf_find(parent, b);
+	if (a < b)
+		parent[b] = a;
+	else
+		parent[a] = b;
+}
+
+/**
+ * Find the region a square is in, or 0 if it isn't in one.
+ */
+static int region_of(struct regions *r, int n) {
+	return r->colors[n] ? uf_find(r->parent, r->colors[n]) : 0;
+}
+
+/**
+ * Find every connected region of the dungeon.
+ *
+ * This is a single pass over the cave with a union-find over squares,
+ * linking each region square to the ones already seen to its west and north
+ * (and north-west and north-east for diagonal connections), followed by a
+ * pass giving each set its region number.  The root of each set is its
+ * first square, so regions come out numbered in scan order.
  */
-static void build_color_point(struct cave *c, int colors[], int counts[], int y, int x, int color, bool diagonal) {
+static struct regions *build_colors(struct cave *c, bool diagonal) {
+	struct regions *r = mem_zalloc(sizeof *r);
 	int h = c->height;
 	int w = c->width;
 	int size = h * w;
-	struct queue *queue = q_new(size);
+	int y, x, n;
 
-	int dslimit = diagonal ? 8 : 4;
+	int *sets = C_ZNEW(size, int);
 
-	int *added = C_ZNEW(size, int);
-	array_filler(added, 0, size);
+	r->h = h;
+	r->w = w;
+	r->colors = C_ZNEW(size, int);
 
-	q_push_int(queue, lab_toi(y, x, w));
-
-	counts[color] = 0;
-
-	while (q_len(queue) > 0) {
-		int i, y2, x2;
-		int n2 = q_pop_int(queue);
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) {
+			n = lab_toi(y, x, w);
 
-		lab_toyx(n2, w, &y2, &x2);
+			if (!region_point(c, y, x)) {
+				sets[n] = -1;
+				continue;
+			}
 
-		if (ignore_point(cave, colors, y2, x2)) continue;
+			sets[n] = n;
+			if (x > 0 && sets[n - 1] >= 0)
+				uf_union(sets, n, n - 1);
+			if (y == 0) continue;
+			if (sets[n - w] >= 0)
+				uf_union(sets, n, n - w);
+			if (!diagonal) continue;
+			if (x > 0 && sets[n - w - 1] >= 0)
+				uf_union(sets, n, n - w - 1);
+			if (x < w - 1 && sets[n - w + 1] >= 0)
+				uf_union(sets, n, n - w + 1);
+		}
+	}
 
-		colors[n2] = color;
-		counts[color]++;
+	/* Number the regions; each root comes before the rest of its set */
+	r->parent = C_ZNEW(size + 1, int);
+	r->counts = C_ZNEW(size + 1, int);
+	r->first = C_ZNEW(size + 1, int);
 
-		/*if (lit) glow_point(c, y2, x2);*/
+	for (n = 0; n < size; n++) {
+		int root, color;
 
-		for (i = 0; i < dslimit; i++) {
-			int y3 = y2 + yds[i];
-			int x3 = x2 + xds[i];
-			int n3 = lab_toi(y3, x3, w);
-			if (ignore_point(cave, colors, y3, x3)) continue;
-			if (added[n3]) continue;
+		if (sets[n] < 0) continue;
 
-			q_push_int(queue, n3);
-			added[n3] = 1;
+		root = uf_find(sets, n);
+		if (root == n) {
+			color = ++r->num;
+			r->parent[color] = color;
+			r->first[color] = n;
+		} else {
+			color = r->colors[root];
 		}
+
+		r->colors[n] = color;
+		r->counts[color]++;
 	}
 
-	FREE(added);
-	q_free(queue);
+	FREE(sets);
+	return r;
 }
 
-/**
- * Create a color for each "NESW contiguous" region of the dungeon.
- */
-static void build_colors(struct cave *c, int colors[], int counts[], bool diagonal) {
-	int y, x;
-	int h = c->height;
-	int w = c->width;
-	int color = 1;
-
-	for (y = 0; y < h; y++) {
-		for (x = 0; x < w; x++) {
-			if (ignore_point(cave, colors, y, x)) continue;
-			build_color_point(cave, colors, counts, y, x, color, diagonal);
-			color++;
-		}
-	}
+static void regions_free(struct regions *r) {
+	FREE(r->colors);
+	FREE(r->parent);
+	FREE(r->counts);
+	FREE(r->first);
+	FREE(r);
 }
 
 /**
  * Find and delete all small (<9 square) open regions.
  */
-static void clear_small_regions(struct cave *c, int colors[], int counts[]) {
+static void clear_small_regions(struct cave *c, struct regions *r) {
 	int i, y, x;
-	int h = c->height;
-	int w = c->width;
-	int size = h * w;
+	int w = r->w;
 
-	int *deleted = C_ZNEW(size, int);
-	array_filler(deleted, 0, size);
-
-	for (i = 0; i < size; i++) {
-		if (counts[i] < 9) {
-			deleted[i] = 1;
-			counts[i] = 0;
-		}
-	}
+	for (i = 1; i <= r->num; i++)
+		if (r->counts[i] < 9) r->counts[i] = 0;
 
+	/* Anything left outside a region is turned to solid rock as well */
 	for (y = 1; y < c->height - 1; y++) {
 		for (x = 1; x < c->width - 1; x++) {
 			i = lab_toi(y, x, w);
 
-			if (!deleted[colors[i]]) continue;
+			if (r->colors[i] && r->counts[r->colors[i]]) continue;
 
-			colors[i] = 0;
+			r->colors[i] = 0;
 			cave_set_feat(c, y, x, FEAT_WALL_SOLID);
 		}
 	}
-	FREE(deleted);
 }
 
 /**
- * Return the number of colors which have active cells.
+ * Return the number of regions which have active cells.
  */
-static int count_colors(int counts[], int size) {
+static int count_colors(struct regions *r) {
 	int i;
 	int num = 0;
-	for (i = 0; i < size; i++) if (counts[i] > 0) num++;
+	for (i = 1; i <= r->num; i++) if (r->counts[i] > 0) num++;
 	return num;
 }
 
 /**
- * Return the first color which has one or more active cells.
+ * Merge region 'from' into region 'to'.
  */
-static int first_color(int counts[], int size) {
-	int i;
-	for (i = 0; i < size; i++) if (counts[i] > 0) return i;
-	return -1;
+static void fix_colors(struct regions *r, int from, int to) {
+	r->parent[from] = to;
+	r->counts[to] += r->counts[from];
+	r->counts[from] = 0;
 }
 
 /**
- * Find all cells of 'fromcolor' and repaint them to 'tocolor'.
+ * A place where the floods from two regions met, and the length of the
+ * tunnel that would join them there.
  */
-static void fix_colors(int colors[], int counts[], int from, int to, int size) {
-	int i;
-	for (i = 0; i < size; i++) if (colors[i] == from) colors[i] = to;
-	counts[to] += counts[from];
-	counts[from] = 0;
+struct region_edge {
+	int a, b;
+	int len;
+	int order;
+};
+
+static int cmp_region_edge(const void *a, const void *b) {
+	const struct region_edge *ea = a;
+	const struct region_edge *eb = b;
+
+	if (ea->len != eb->len) return ea->len - eb->len;
+	return ea->order - eb->order;
 }
 
 /**
- * Create a tunnel connecting a region to one of its nearest neighbors.
+ * Turn the path from a flooded square back to its region into tunnel.
  */
-static void join_region(struct cave *c, int colors[], int counts[], int color) {
-	int i;
-	int h = c->height;
-	int w = c->width;
+static void carve_region_path(struct cave *c, struct regions *r, int n,
+		int color, int dist[], int previous[]) {
+	int w = r->w;
+
+	while (dist[n] > 0) {
+		int y, x;
+		lab_toyx(n, w, &y, &x);
+		r->colors[n] = color;
+		if (!cave_isperm(c, y, x) && !cave_isvault(c, y, x))
+			cave_set_feat(c, y, x, FEAT_FLOOR);
+		n = previous[n];
+	}
+}
+
+/**
+ * Connect all the regions with as little tunnelling as possible.
+ *
+ * Every region is flooded outwards through the rock at once, each square
+ * being claimed by the nearest region; wherever two floods meet, the two
+ * regions could be joined by a tunnel there.  Taking those meetings from
+ * the shortest tunnel up and joining any two regions not yet connected
+ * links the whole cave in time proportional to its area, rather than
+ * re-flooding from scratch for every region.
+ */
+static void join_regions(struct cave *c, struct regions *r) {
+	int h = r->h;
+	int w = r->w;
 	int size = h * w;
+	int num = count_colors(r);
 
-	/* Allocate a processing queue */
-	struct queue *queue = q_new(size);
+	struct queue *queue;
+	int *owner, *dist, *previous;
+	struct region_edge *edges = NULL;
+	int n_edges = 0, max_edges = 0;
+	int i, n;
 
-	/* Allocate an array to keep track of handled squares, and which square
-	 * we reached them from.
-	 */
-	int *previous = C_ZNEW(size, int);
-	array_filler(previous, -1, size);
-
-	/* Push all squares of the given color onto the queue */
-	for (i = 0; i < size; i++) {
-		if (colors[i] == color) {
-			q_push_int(queue, i);
-			previous[i] = i;
-		}
+	if (num < 2) return;
+
+	queue = q_new(size);
+	owner = C_ZNEW(size, int);
+	dist = C_ZNEW(size, int);
+	previous = C_ZNEW(size, int);
+
+	/* Every square of a region starts off its own flood */
+	for (n = 0; n < size; n++) {
+		owner[n] = region_of(r, n);
+		if (!owner[n]) continue;
+
+		previous[n] = n;
+		q_push_int(queue, n);
 	}
 
-	/* Process all squares into the queue */
 	while (q_len(queue) > 0) {
-		/* Get the current square and its color */
-		int n = q_pop_int(queue);
-		int color2 = colors[n];
-
-		/* See if we've reached a square with a new color */
-		if (color2 && color2 != color) {
-			/* Step backward through the path, turning stone to tunnel */
-			while (colors[n] != color) {
-				int x, y;
-				lab_toyx(n, w, &y, &x);
-				colors[n] = color;
-				if (!cave_isperm(c, y, x) && !cave_isvault(c, y, x)) {
-					cave_set_feat(c, y, x, FEAT_FLOOR);
-				}
-				n = previous[n];
-			}
+		int y, x;
 
-			/* Update the color mapping to combine the two colors */
-			fix_colors(colors, counts, color2, color, size);
+		n = q_pop_int(queue);
+		lab_toyx(n, w, &y, &x);
 
-			/* We're done now */
-			break;
-		}
-
-		/* If we haven't reached a new color, add all the unprocessed adjacent
-		 * squares to our queue.
-		 */
 		for (i = 0; i < 4; i++) {
-			int y, x, n2;
-			lab_toyx(n, w, &y, &x);
-
-			/* Move to the adjacent square */
-			y += yds[i];
-			x += xds[i];
+			int y2 = y + yds[i];
+			int x2 = x + xds[i];
+			int n2;
 
 			/* make sure we stay inside the boundaries */
-			if (y < 0 || y >= h) continue;
-			if (x < 0 || x >= w) continue;
+			if (y2 < 0 || y2 >= h) continue;
+			if (x2 < 0 || x2 >= w) continue;
 
-			/* If the cell hasn't already been procssed, add it to the queue */
-			n2 = lab_toi(y, x, w);
-			if (previous[n2] >= 0) continue;
-			q_push_int(queue, n2);
+			n2 = lab_toi(y2, x2, w);
+
+			/* Note where two floods meet, once for each pair of squares */
+			if (owner[n2]) {
+				if (owner[n2] == owner[n] || n2 < n) continue;
+
+				if (n_edges == max_edges) {
+					max_edges = max_edges ? max_edges * 2 : 256;
+					edges = mem_realloc(edges, max_edges * sizeof *edges);
+				}
+
+				edges[n_edges].a = n;
+				edges[n_edges].b = n2;
+				edges[n_edges].len = dist[n] + dist[n2];
+				edges[n_edges].order = n_edges;
+				n_edges++;
+				continue;
+			}
+
+			/* Permanent rock can't be tunnelled */
+			if (cave_isperm(c, y2, x2)) continue;
+
+			owner[n2] = owner[n];
+			dist[n2] = dist[n] + 1;
 			previous[n2] = n;
+			q_push_int(queue, n2);
 		}
 	}
 
-	/* Free the memory we've allocated */
-	q_free(queue);
-	FREE(previous);
-}
+	sort(edges, n_edges, sizeof *edges, cmp_region_edge);
 
+	/* Join regions along the shortest tunnels until only one is left */
+	for (i = 0; i < n_edges && num > 1; i++) {
+		int a = uf_find(r->parent, owner[edges[i].a]);
+		int b = uf_find(r->parent, owner[edges[i].b]);
 
-/**
- * Start connecting regions, stopping when the cave is entirely connected.
- */
-static void join_regions(struct cave *c, int colors[], int counts[]) {
-	int h = c->height;
-	int w = c->width;
-	int size = h * w;
-	int num = count_colors(counts, size);
+		if (a == b) continue;
 
-	/* While we have multiple colors (i.e. disconnected regions), join one of
-	 * the regions to another one.
-	 */
-	while (num > 1) {
-		int color = first_color(counts, size);
-		join_region(c, colors, counts, color);
+		carve_region_path(c, r, edges[i].a, MIN(a, b), dist, previous);
+		carve_region_path(c, r, edges[i].b, MIN(a, b), dist, previous);
+
+		fix_colors(r, MAX(a, b), MIN(a, b));
 		num--;
 	}
+
+	mem_free(edges);
+	q_free(queue);
+	FREE(owner);
+	FREE(dist);
+	FREE(previous);
 }
 
 
@@ -3509,15 +3680,10 @@ static int open_count(struct cave *c) {
  * information to join them into one conected region.
  */
 void ensure_connectedness(struct cave *c) {
-	int size = c->height * c->width;
-	int *colors = C_ZNEW(size, int);
-	int *counts = C_ZNEW(size, int);
+	struct regions *r = build_colors(c, TRUE);
 
-	build_colors(c, colors, counts, TRUE);
-	join_regions(c, colors, counts);
-
-	FREE(colors);
-	FREE(counts);
+	join_regions(c, r);
+	regions_free(r);
 }
 
 
@@ -3536,9 +3702,6 @@ bool cavern_gen(struct cave *c, struct player *p) {
 	int density = rand_range(25, 40);
 	int times = rand_range(3, 6);
 
-	int *colors = C_ZNEW(size, int);
-	int *counts = C_ZNEW(size, int);
-
 	int tries = 0;
 
 	bool ok = TRUE;
@@ -3552,13 +3715,10 @@ bool cavern_gen(struct cave *c, struct player *p) {
 
 	} else {
 		/* Start trying to build caverns */
-		array_filler(colors, 0, size);
-		array_filler(counts, 0, size);
-	
 		for (tries = 0; tries < MAX_CAVERN_TRIES; tries++) {
 			/* Build a random cavern and mutate it a number of times */
 			init_cavern(c, p, density);
-			for (i = 0; i < times; i++) mutate_cavern(c);
+			mutate_cavern(c, times);
 	
 			/* If there are enough open squares then we're done */
 			openc = open_count(c);
@@ -3574,9 +3734,11 @@ bool cavern_gen(struct cave *c, struct player *p) {
 	}
 
 	if (ok) {
-		build_colors(c, colors, counts, FALSE);
-		clear_small_regions(c, colors, counts);
-		join_regions(c, colors, counts);
+		struct regions *r = build_colors(c, FALSE);
+
+		clear_small_regions(c, r);
+		join_regions(c, r);
+		regions_free(r);
 	
 		/* Place 2-3 down stairs near some walls */
 		alloc_stairs(c, FEAT_MORE, rand_range(1, 3), 3);
@@ -3612,9 +3774,6 @@ bool cavern_gen(struct cave *c, struct player *p) {
 			ORIGIN_CAVERN);
 	}
 
-	FREE(colors);
-	FREE(counts);
-
 	return ok;
 }
 
@@ -3754,6 +3913,9 @@ static bool town_gen(struct cave *c, struct player *p) {
 static void cave_clear(struct cave *c, struct player *p) {
 	int x, y;
 
+	/* The empty squares will be indexed afresh when needed */
+	cave_empty_index_free(c);
+
 	wipe_o_list(c);
 	wipe_mon_list(c, p);
 
@@ -3779,6 +3941,9 @@ static void cave_clear(struct cave *c, struct player *p) {
 		}
 	}
 
+	/* Anything remembered about the old level is now wrong */
+	c->feat_changes++;
+
 	/* Unset the player's coordinates */
 	p->px = p->py = 0;
 
@@ -3889,6 +4054,41 @@ static void clear_dun_data(struct dun_data *d) {
 			d->room_map[by][bx] = FALSE;
 		}
 	}
+
+	d->vault_n = 0;
+}
+
+/**
+ * Describe the level just built, for generate_levels().
+ */
+static void summarize_level(struct cave *c, struct dun_data *d,
+		struct level_summary *sum)
+{
+	int i;
+
+	sum->depth = c->depth;
+	sum->profile = d->profile->name;
+	sum->obj_feeling = c->feeling / 10;
+	sum->mon_feeling = c->feeling % 10;
+
+	sum->objects = 0;
+	sum->held = 0;
+	for (i = 1; i < o_max; i++) {
+		object_type *o_ptr = object_byid(i);
+
+		if (!o_ptr->kind) continue;
+
+		if (o_ptr->held_m_idx)
+			sum->held++;
+		else
+			sum->objects++;
+	}
+
+	sum->monsters = cave_monster_count(c);
+
+	sum->vaults = d->vault_n;
+	for (i = 0; i < LEVEL_SUMMARY_VAULTS; i++)
+		sum->vault_name[i] = i < d->vault_n ? d->vault_name[i] : NULL;
 }
 
 /**
@@ -3899,6 +4099,7 @@ static void clear_dun_data(struct dun_data *d) {
 void cave_generate(struct cave *c, struct player *p) {
 	const char *error = "no generation";
 	int tries = 0;
+	struct dun_data dun_body;
 
 	assert(c);
 
@@ -3906,8 +4107,6 @@ void cave_generate(struct cave *c, struct player *p) {
 
 	/* Generate */
 	for (tries = 0; tries < 100 && error; tries++) {
-		struct dun_data dun_body;
-
 		error = NULL;
 		cave_clear(c, p);
 
@@ -3978,9 +4177,13 @@ void cave_generate(struct cave *c, struct player *p) {
 
 	FREE(cave_squares);
 	cave_squares = NULL;
+	cave_empty_index_free(c);
 
 	if (error) quit_fmt("cave_generate() failed 100 times!");
 
+	if (gen_summary)
+		summarize_level(c, dun, gen_summary);
+
 	/* The dungeon is ready */
 	character_dungeon = TRUE;
 
@@ -3992,3 +4195,165 @@ struct init_module generate_module = {
 	.init = run_room_parser,
 	.cleanup = NULL
 };
+
+
+/**
+ * Everything level generation reads or writes outside the cave it is given:
+ * the current cave, player and object list, and the random number
+ * generator (the "complex" RNG is switched to a stream of the context's
+ * own).
+ */
+struct gen_globals {
+	struct cave *cave;
+	struct player *p;
+	struct object *o_list;
+	s16b o_max;
+	s16b o_cnt;
+	s16b num_repro;
+	bool character_dungeon;
+
+	bool rand_quick;
+	u32b rand_value;
+	struct rand_stream *stream;
+};
+
+/**
+ * A generation context lets levels be built without disturbing the game in
+ * progress.  It owns a cave, an object list and a copy of the player, and
+ * swaps them (and the RNG state) in for the globals while it works.
+ */
+struct gen_context {
+	struct gen_globals own;
+	struct gen_globals saved;
+	struct player player;
+	struct rand_stream rand;
+};
+
+static void gen_globals_save(struct gen_globals *g)
+{
+	g->cave = cave;
+	g->p = p_ptr;
+	g->o_max = o_max;
+	g->o_cnt = o_cnt;
+	g->num_repro = num_repro;
+	g->character_dungeon = character_dungeon;
+
+	g->rand_quick = Rand_quick;
+	g->rand_value = Rand_value;
+}
+
+static void gen_globals_load(const struct gen_globals *g)
+{
+	cave = g->cave;
+	p_ptr = g->p;
+	o_max = g->o_max;
+	o_cnt = g->o_cnt;
+	num_repro = g->num_repro;
+	character_dungeon = g->character_dungeon;
+
+	Rand_quick = g->rand_quick;
+	Rand_value = g->rand_value;
+}
+
+static void gen_context_enter(struct gen_context *ctx)
+{
+	gen_globals_save(&ctx->saved);
+	gen_globals_load(&ctx->own);
+	ctx->saved.o_list = objects_swap(ctx->own.o_list);
+	ctx->saved.stream = rand_stream_use(&ctx->rand);
+}
+
+static void gen_context_leave(struct gen_context *ctx)
+{
+	gen_globals_save(&ctx->own);
+	gen_globals_load(&ctx->saved);
+	ctx->own.o_list = objects_swap(ctx->saved.o_list);
+	rand_stream_use(ctx->saved.stream);
+}
+
+/**
+ * Make a new, empty generation context.
+ */
+struct gen_context *gen_context_new(void)
+{
+	struct gen_context *ctx = mem_zalloc(sizeof *ctx);
+
+	ctx->own.cave = cave_new();
+	ctx->own.p = &ctx->player;
+	ctx->own.o_list = C_ZNEW(z_info->o_max, struct object);
+	ctx->own.o_max = 1;
+	ctx->own.o_cnt = 0;
+
+	return ctx;
+}
+
+/**
+ * Free a generation context, handing back any artifacts and unique monsters
+ * its last level used.
+ */
+void gen_context_free(struct gen_context *ctx)
+{
+	gen_context_enter(ctx);
+	character_dungeon = FALSE;
+	wipe_o_list(cave);
+	wipe_mon_list(cave, p_ptr);
+	gen_context_leave(ctx);
+
+	cave_free(ctx->own.cave);
+	mem_free(ctx->own.o_list);
+	mem_free(ctx);
+}
+
+/**
+ * Build a level of the given depth from `seed` in the context's cave, and
+ * describe it in `sum`.  The caller's cave, player, objects and RNG are
+ * left as they were, though any target is forgotten.
+ */
+void gen_context_generate(struct gen_context *ctx, int depth, u32b seed,
+		struct level_summary *sum)
+{
+	/* The player copy only needs to be current for where it is going */
+	ctx->player = *p_ptr;
+	ctx->player.depth = depth;
+
+	rand_stream_init(&ctx->rand, seed);
+
+	gen_context_enter(ctx);
+	Rand_quick = FALSE;
+
+	WIPE(sum, struct level_summary);
+	sum->seed = seed;
+
+	gen_summary = sum;
+	cave_generate(cave, p_ptr);
+	gen_summary = NULL;
+
+	gen_context_leave(ctx);
+}
+
+/**
+ * Build `count` levels of the given depth and pass a summary of each to
+ * `fn`, for statistics gathering.
+ *
+ * Every level gets its own seed and is built in a context of its own, so
+ * the game in progress is not affected (not even its RNG).  The levels are
+ * built one after another, as generation still shares the monster race and
+ * artifact tables.
+ */
+void generate_levels(int depth, int count, level_summary_fn fn, void *data)
+{
+	struct gen_context *ctx = gen_context_new();
+	u32b seed = Rand_simple(0x10000000);
+	int i;
+
+	for (i = 0; i < count; i++) {
+		struct level_summary sum;
+
+		gen_context_generate(ctx, depth, seed + i, &sum);
+		sum.index = i;
+
+		fn(&sum, data);
+	}
+
+	gen_context_free(ctx);
+}
@@ -18,6 +18,39 @@ void place_random_door(struct cave *c, int y, int x);
 extern struct room_template *random_room_template(int typ);
 extern struct vault *random_vault(int typ);
 
+/* How many vault names a level summary keeps */
+#define LEVEL_SUMMARY_VAULTS 4
+
+/**
+ * What generate_levels() reports about each level it builds.
+ */
+struct level_summary {
+	int index;		/* Position in the batch */
+	u32b seed;		/* Seed the level was built from */
+	int depth;
+	const char *profile;	/* Name of the cave profile used */
+
+	int obj_feeling;	/* 1 (superb) to 10 (boring), 0 in the town */
+	int mon_feeling;	/* 1 (deadly) to 9 (quiet), 0 in the town */
+
+	int objects;		/* Objects on the floor */
+	int held;		/* Objects carried by monsters */
+	int monsters;
+
+	int vaults;		/* Vaults built */
+	const char *vault_name[LEVEL_SUMMARY_VAULTS];
+};
+
+typedef void (*level_summary_fn)(const struct level_summary *sum, void *data);
+
+struct gen_context;
+
+struct gen_context *gen_context_new(void);
+void gen_context_free(struct gen_context *ctx);
+void gen_context_generate(struct gen_context *ctx, int depth, u32b seed,
+	struct level_summary *sum);
+void generate_levels(int depth, int count, level_summary_fn fn, void *data);
+
 struct tunnel_profile {
 	const char *name;
     int rnd; /* % chance of choosing random direction */
@@ -27,8 +27,10 @@
 #include "hint.h"
 #include "keymap.h"
 #include "init.h"
+#include "journal.h"
 #include "monster/mon-init.h"
 #include "monster/mon-list.h"
+#include "monster/mon-lore.h"
 #include "monster/mon-msg.h"
 #include "monster/mon-util.h"
 #include "object/object.h"
@@ -41,6 +43,7 @@
 #include "quest.h"
 #include "randname.h"
 #include "squelch.h"
+#include "target.h"
 
 /*
  * Structure (not array) of size limits
@@ -2989,6 +2992,7 @@ void cleanup_angband(void)
 	FREE(p_ptr->inventory);
 
 	/* Free the lore, monster, and object lists */
+	lore_recall_free();
 	FREE(l_list);
 	objects_destroy();
 
@@ -3001,6 +3005,10 @@ void cleanup_angband(void)
 	/* Free the messages */
 	messages_free();
 
+	/* Free the command queue and close the journal */
+	cmd_queue_free();
+	journal_close();
+
 	/* Free the history */
 	history_clear();
 
@@ -3009,6 +3017,7 @@ void cleanup_angband(void)
 
 	monster_list_finalize();
 	object_list_finalize();
+	target_index_free();
 
 	cleanup_parser(&k_parser);
 	cleanup_parser(&kb_parser);
@@ -0,0 +1,691 @@
+/*
+ * File: journal.c
+ * Purpose: Recording the player's commands, and replaying them
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "game-cmd.h"
+#include "journal.h"
+#include "savefile.h"
+#include "target.h"
+
+/*
+ * Journal layout
+ *
+ * The file starts with the four bytes "AJNL" and a version byte, followed by
+ * a series of records, each introduced by a one-byte tag.  All numbers are
+ * little-endian.  Records have no size limit, but a string argument may be
+ * at most JOURNAL_STRING_MAX bytes.
+ *
+ *  'K' checkpoint:  u16 number, then the game state (see journal_state)
+ *  'A' abort:       s32 turn on which the player interrupted a repeated
+ *                   command, rest or run
+ *  'T' target:      s16 monster index (0 for a location), s16 x, s16 y
+ *  'C' command:     byte context, u16 code, s16 repeats, byte arg mask,
+ *                   then for each argument in the mask a type byte and
+ *                   either a u32, two s16s (points) or a string with a
+ *                   u32 length (a byte length in version 1 journals).
+ *
+ * A target record applies to the command record which follows it.  Each
+ * checkpoint has a savefile next to the journal, named after its number.
+ */
+#define JOURNAL_MAGIC		"AJNL"
+#define JOURNAL_VERSION		2
+
+/* Longest string argument; anything longer in a journal means it is corrupt */
+#define JOURNAL_STRING_MAX	65535
+
+#define JREC_CHECKPOINT		'K'
+#define JREC_ABORT		'A'
+#define JREC_TARGET		'T'
+#define JREC_COMMAND		'C'
+
+/*
+ * Everything that must be identical for a replay to still be in step.
+ *
+ * The "quick" RNG is always reseeded before use (flavors, town layout,
+ * randarts) so its value is left out.
+ */
+struct journal_state {
+	s32b turn;
+	u32b state_i;
+	u32b z[3];
+	u32b state[RAND_DEG];
+};
+
+/* A record being built up for writing */
+struct journal_buf {
+	byte *data;
+	size_t len;
+	size_t size;
+};
+
+static ang_file *journal_file;
+static byte journal_version;
+static char journal_path[1024];
+static char replay_savefile[1024];
+static u16b next_checkpoint;
+static bool replaying;
+static bool replay_started;
+static bool replay_done;
+static struct journal_state replay_start;
+static struct journal_stats stats;
+
+void (*journal_replay_done_hook)(void);
+bool (*journal_save_hook)(const char *path) = savefile_save;
+
+static bool journal_read(void);
+
+/*
+ * The record read ahead during replay.
+ */
+static struct {
+	byte tag;
+	cmd_context ctx;
+	game_command cmd;
+	char *strings[CMD_MAX_ARGS];
+
+	bool has_target;
+	s16b target_m, target_x, target_y;
+
+	u16b checkpoint;
+	struct journal_state state;
+
+	s32b abort_turn;
+} pending;
+
+
+/*** Encoding ***/
+
+static void put_byte(struct journal_buf *b, byte v)
+{
+	if (b->len == b->size) {
+		b->size = b->size ? b->size * 2 : 64;
+		b->data = mem_realloc(b->data, b->size);
+	}
+
+	b->data[b->len++] = v;
+}
+
+static void put_u16b(struct journal_buf *b, u16b v)
+{
+	put_byte(b, (byte)(v & 0xFF));
+	put_byte(b, (byte)(v >> 8));
+}
+
+static void put_u32b(struct journal_buf *b, u32b v)
+{
+	put_u16b(b, (u16b)(v & 0xFFFF));
+	put_u16b(b, (u16b)(v >> 16));
+}
+
+static bool get_byte(byte *v)
+{
+	return file_readc(journal_file, v);
+}
+
+static bool get_u16b(u16b *v)
+{
+	byte lo, hi;
+
+	if (!get_byte(&lo) || !get_byte(&hi)) return FALSE;
+	*v = (u16b)(lo | (hi << 8));
+
+	return TRUE;
+}
+
+static bool get_u32b(u32b *v)
+{
+	u16b lo, hi;
+
+	if (!get_u16b(&lo) || !get_u16b(&hi)) return FALSE;
+	*v = (u32b)lo | ((u32b)hi << 16);
+
+	return TRUE;
+}
+
+static void journal_state_get(struct journal_state *s)
+{
+	int i;
+
+	s->turn = turn;
+	s->state_i = state_i;
+	s->z[0] = z0;
+	s->z[1] = z1;
+	s->z[2] = z2;
+	for (i = 0; i < RAND_DEG; i++)
+		s->state[i] = STATE[i];
+}
+
+static bool journal_state_eq(const struct journal_state *a,
+		const struct journal_state *b)
+{
+	return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+static void put_state(struct journal_buf *b, const struct journal_state *s)
+{
+	int i;
+
+	put_u32b(b, (u32b)s->turn);
+	put_u32b(b, s->state_i);
+	for (i = 0; i < 3; i++)
+		put_u32b(b, s->z[i]);
+	for (i = 0; i < RAND_DEG; i++)
+		put_u32b(b, s->state[i]);
+}
+
+static bool get_state(struct journal_state *s)
+{
+	u32b v;
+	int i;
+
+	if (!get_u32b(&v)) return FALSE;
+	s->turn = (s32b)v;
+	if (!get_u32b(&s->state_i)) return FALSE;
+	for (i = 0; i < 3; i++)
+		if (!get_u32b(&s->z[i])) return FALSE;
+	for (i = 0; i < RAND_DEG; i++)
+		if (!get_u32b(&s->state[i])) return FALSE;
+
+	return TRUE;
+}
+
+/*
+ * Write out a finished record, and release it.
+ */
+static void journal_write(struct journal_buf *b)
+{
+	file_write(journal_file, (const char *)b->data, b->len);
+	FREE(b->data);
+
+	/* Keep the journal complete in case the game is about to crash */
+	file_flush(journal_file);
+}
+
+static void checkpoint_path(char *buf, size_t len, int n)
+{
+	strnfmt(buf, len, "%s.%d", journal_path, n);
+}
+
+
+/*** Recording ***/
+
+/*
+ * Start the journal for the current game, or check that a replay has
+ * started from the right place.
+ *
+ * Called once the character and level are ready, just before play starts.
+ */
+void journal_begin(void)
+{
+	struct journal_buf b;
+	int n;
+
+	if (replaying) {
+		struct journal_state now;
+
+		journal_state_get(&now);
+		if (!journal_state_eq(&now, &replay_start)) {
+			plog_fmt("Savefile '%s' does not match its journal.",
+					replay_savefile);
+			stats.mismatches++;
+		}
+		stats.checkpoints++;
+		replay_started = TRUE;
+		return;
+	}
+
+	if (!arg_journal || journal_file) return;
+
+	/*
+	 * Each session gets a journal of its own, so that carrying on with a
+	 * saved game keeps the replays of the sessions before it.
+	 */
+	strnfmt(journal_path, sizeof(journal_path), "%s.jnl", savefile);
+	for (n = 1; file_exists(journal_path); n++)
+		strnfmt(journal_path, sizeof(journal_path), "%s.%d.jnl", savefile, n);
+
+	safe_setuid_grab();
+	journal_file = file_open(journal_path, MODE_WRITE, FTYPE_RAW);
+	safe_setuid_drop();
+
+	if (!journal_file) {
+		msg("Could not open the journal '%s'.", journal_path);
+		return;
+	}
+
+	WIPE(&b, struct journal_buf);
+	put_byte(&b, JOURNAL_MAGIC[0]);
+	put_byte(&b, JOURNAL_MAGIC[1]);
+	put_byte(&b, JOURNAL_MAGIC[2]);
+	put_byte(&b, JOURNAL_MAGIC[3]);
+	put_byte(&b, JOURNAL_VERSION);
+	journal_write(&b);
+
+	next_checkpoint = 0;
+	journal_checkpoint();
+}
+
+/*
+ * Save a copy of the game next to the journal, so a replay can start here.
+ *
+ * During a replay, this instead checks the game is in the same state as
+ * when the checkpoint was made.
+ */
+void journal_checkpoint(void)
+{
+	struct journal_state now;
+	struct journal_buf b;
+	char path[1024];
+
+	journal_state_get(&now);
+
+	if (replaying) {
+		if (replay_done) return;
+
+		if (pending.tag != JREC_CHECKPOINT) {
+			stats.mismatches++;
+			return;
+		}
+
+		if (!journal_state_eq(&now, &pending.state)) {
+			plog_fmt("Replay out of step at checkpoint %d (turn %d, expected %d).",
+					pending.checkpoint, now.turn, pending.state.turn);
+			stats.mismatches++;
+		}
+
+		stats.checkpoints++;
+		journal_read();
+		return;
+	}
+
+	if (!journal_file) return;
+
+	checkpoint_path(path, sizeof(path), next_checkpoint);
+	if (!journal_save_hook(path)) {
+		msg("Failed to write journal checkpoint %d.", next_checkpoint);
+		return;
+	}
+
+	WIPE(&b, struct journal_buf);
+	put_byte(&b, JREC_CHECKPOINT);
+	put_u16b(&b, next_checkpoint);
+	put_state(&b, &now);
+	journal_write(&b);
+
+	next_checkpoint++;
+	stats.checkpoints++;
+}
+
+/*
+ * Add a command to the journal, just as it is about to be carried out.
+ */
+void journal_record_cmd(cmd_context ctx, const game_command *cmd)
+{
+	struct journal_buf b;
+	bool aimed = FALSE;
+	byte mask = 0;
+	int i;
+
+	if (!journal_file || replaying) return;
+
+	WIPE(&b, struct journal_buf);
+
+	for (i = 0; i < CMD_MAX_ARGS; i++) {
+		if (!cmd->arg_present[i]) continue;
+		mask |= (1 << i);
+
+		/* Only target arguments can mean "at the current target" */
+		if ((cmd_arg_type(cmd->command, i) & arg_TARGET) &&
+				cmd->arg[i].direction == DIR_TARGET)
+			aimed = TRUE;
+	}
+
+	/* Commands aimed at the target need to know what it was */
+	if (aimed) {
+		struct monster *m = target_get_monster();
+		s16b x, y;
+
+		target_get(&x, &y);
+
+		put_byte(&b, JREC_TARGET);
+		put_u16b(&b, (u16b)(m ? m->midx : 0));
+		put_u16b(&b, (u16b)x);
+		put_u16b(&b, (u16b)y);
+	}
+
+	put_byte(&b, JREC_COMMAND);
+	put_byte(&b, (byte)ctx);
+	put_u16b(&b, (u16b)cmd->command);
+	put_u16b(&b, (u16b)cmd->nrepeats);
+	put_byte(&b, mask);
+
+	for (i = 0; i < CMD_MAX_ARGS; i++) {
+		if (!cmd->arg_present[i]) continue;
+
+		put_byte(&b, (byte)cmd->arg_type[i]);
+
+		if (cmd->arg_type[i] == arg_STRING) {
+			const char *str = cmd->arg[i].string ? cmd->arg[i].string : "";
+			size_t len = strlen(str);
+			size_t j;
+
+			assert(len <= JOURNAL_STRING_MAX);
+			put_u32b(&b, (u32b)len);
+			for (j = 0; j < len; j++)
+				put_byte(&b, (byte)str[j]);
+		} else if (cmd->arg_type[i] == arg_POINT) {
+			put_u16b(&b, (u16b)cmd->arg[i].point.x);
+			put_u16b(&b, (u16b)cmd->arg[i].point.y);
+		} else {
+			put_u32b(&b, (u32b)cmd->arg[i].choice);
+		}
+	}
+
+	journal_write(&b);
+	stats.commands++;
+}
+
+/*
+ * Note that the player interrupted whatever they were doing.
+ */
+void journal_record_interrupt(void)
+{
+	struct journal_buf b;
+
+	if (!journal_file || replaying) return;
+
+	WIPE(&b, struct journal_buf);
+	put_byte(&b, JREC_ABORT);
+	put_u32b(&b, (u32b)turn);
+	journal_write(&b);
+}
+
+/*
+ * Close the journal, whether recording or replaying.
+ */
+void journal_close(void)
+{
+	int i;
+
+	if (journal_file) file_close(journal_file);
+	journal_file = NULL;
+
+	for (i = 0; i < CMD_MAX_ARGS; i++)
+		FREE(pending.strings[i]);
+
+	/* The replayed game ended before the journal did */
+	if (replay_started && !replay_done) {
+		replay_done = TRUE;
+		if (journal_replay_done_hook) journal_replay_done_hook();
+	}
+}
+
+
+/*** Replay ***/
+
+/*
+ * Read the next checkpoint or command from the journal into `pending`.
+ */
+static bool journal_read(void)
+{
+	byte tag;
+	int i;
+
+	pending.tag = 0;
+	pending.has_target = FALSE;
+	for (i = 0; i < CMD_MAX_ARGS; i++)
+		FREE(pending.strings[i]);
+
+	while (get_byte(&tag)) {
+		if (tag == JREC_TARGET) {
+			u16b m, x, y;
+
+			if (!get_u16b(&m) || !get_u16b(&x) || !get_u16b(&y)) break;
+			pending.target_m = (s16b)m;
+			pending.target_x = (s16b)x;
+			pending.target_y = (s16b)y;
+			pending.has_target = TRUE;
+		} else if (tag == JREC_ABORT) {
+			u32b v;
+
+			if (!get_u32b(&v)) break;
+			pending.abort_turn = (s32b)v;
+
+			pending.tag = tag;
+			return TRUE;
+		} else if (tag == JREC_CHECKPOINT) {
+			if (!get_u16b(&pending.checkpoint)) break;
+			if (!get_state(&pending.state)) break;
+
+			pending.tag = tag;
+			return TRUE;
+		} else if (tag == JREC_COMMAND) {
+			game_command *cmd = &pending.cmd;
+			byte ctx, mask;
+			u16b code, nrepeats;
+			int i;
+
+			if (!get_byte(&ctx) || !get_u16b(&code) || !get_u16b(&nrepeats) ||
+					!get_byte(&mask))
+				break;
+
+			WIPE(cmd, game_command);
+			pending.ctx = (cmd_context)ctx;
+			cmd->command = (cmd_code)code;
+			cmd->nrepeats = (s16b)nrepeats;
+
+			for (i = 0; i < CMD_MAX_ARGS; i++) {
+				byte type;
+
+				if (!(mask & (1 << i))) continue;
+				if (!get_byte(&type)) return FALSE;
+
+				cmd->arg_present[i] = TRUE;
+				cmd->arg_type[i] = (enum cmd_arg_type)type;
+
+				if (type == arg_STRING) {
+					u32b len;
+
+					if (journal_version == 1) {
+						byte len8;
+
+						if (!get_byte(&len8)) return FALSE;
+						len = len8;
+					} else if (!get_u32b(&len)) {
+						return FALSE;
+					}
+
+					/* A string must fit, and be all there */
+					if (len > JOURNAL_STRING_MAX) {
+						plog_fmt("Corrupt string in journal '%s'.", journal_path);
+						return FALSE;
+					}
+
+					pending.strings[i] = mem_alloc(len + 1);
+					if (file_read(journal_file, pending.strings[i], len) != (int)len) {
+						plog_fmt("Journal '%s' ends in a string.", journal_path);
+						return FALSE;
+					}
+					pending.strings[i][len] = '\0';
+					cmd->arg[i].string = pending.strings[i];
+				} else if (type == arg_POINT) {
+					u16b x, y;
+
+					if (!get_u16b(&x) || !get_u16b(&y)) return FALSE;
+					cmd->arg[i].point.x = (s16b)x;
+					cmd->arg[i].point.y = (s16b)y;
+				} else {
+					u32b v;
+
+					if (!get_u32b(&v)) return FALSE;
+					cmd->arg[i].choice = (s32b)v;
+				}
+			}
+
+			pending.tag = tag;
+			return TRUE;
+		} else {
+			plog_fmt("Corrupt record in journal '%s'.", journal_path);
+			break;
+		}
+	}
+
+	return FALSE;
+}
+
+/*
+ * Open a journal for replay, starting from the given checkpoint.
+ *
+ * The game must then be loaded from journal_replay_savefile().
+ */
+bool journal_replay_open(const char *path, int checkpoint)
+{
+	char magic[4];
+	byte version;
+
+	journal_file = file_open(path, MODE_READ, -1);
+	if (!journal_file) return FALSE;
+
+	if (file_read(journal_file, magic, 4) != 4 ||
+			memcmp(magic, JOURNAL_MAGIC, 4) != 0 ||
+			!get_byte(&version) || version < 1 || version > JOURNAL_VERSION) {
+		plog_fmt("'%s' is not a journal.", path);
+		journal_close();
+		return FALSE;
+	}
+
+	my_strcpy(journal_path, path, sizeof(journal_path));
+	journal_version = version;
+
+	/* Skip forward to the checkpoint */
+	while (journal_read()) {
+		if (pending.tag == JREC_CHECKPOINT && pending.checkpoint == checkpoint)
+			break;
+	}
+
+	if (pending.tag != JREC_CHECKPOINT) {
+		plog_fmt("Journal '%s' has no checkpoint %d.", path, checkpoint);
+		journal_close();
+		return FALSE;
+	}
+
+	replay_start = pending.state;
+	checkpoint_path(replay_savefile, sizeof(replay_savefile), checkpoint);
+
+	replaying = TRUE;
+	replay_done = FALSE;
+	WIPE(&stats, struct journal_stats);
+
+	journal_read();
+
+	return TRUE;
+}
+
+/*
+ * Whether this game is a replay of a journal.
+ */
+bool journal_is_replaying(void)
+{
+	return replaying;
+}
+
+/*
+ * The savefile a replay starts from.
+ */
+const char *journal_replay_savefile(void)
+{
+	return replay_savefile;
+}
+
+/*
+ * Queue the next command from the journal, if it was given in context `ctx`.
+ *
+ * When the journal runs out, or the replay goes out of step with it, the
+ * replay finishes and control passes to journal_replay_done_hook.
+ */
+bool journal_replay_next(cmd_context ctx)
+{
+	game_command cmd;
+	int i;
+
+	/* Splash screen and birth commands still come from the UI */
+	if (!replay_started || replay_done) return FALSE;
+
+	/* A save or interruption which this replay never made */
+	while (pending.tag == JREC_CHECKPOINT || pending.tag == JREC_ABORT) {
+		stats.mismatches++;
+		journal_read();
+	}
+
+	if (pending.tag != JREC_COMMAND || pending.ctx != ctx) {
+		if (pending.tag) {
+			plog_fmt("Replay out of step at turn %d.", turn);
+			stats.mismatches++;
+		}
+
+		replay_done = TRUE;
+		journal_close();
+		if (journal_replay_done_hook) journal_replay_done_hook();
+		return FALSE;
+	}
+
+	if (pending.has_target) {
+		if (pending.target_m)
+			target_set_monster(cave_monster(cave, pending.target_m));
+		else
+			target_set_location(pending.target_y, pending.target_x);
+	}
+
+	/* Queued strings belong to the command, as with cmd_set_arg_string() */
+	cmd = pending.cmd;
+	for (i = 0; i < CMD_MAX_ARGS; i++)
+		if (cmd.arg_present[i] && cmd.arg_type[i] == arg_STRING)
+			cmd.arg[i].string = string_make(pending.strings[i]);
+
+	cmd_insert_s(&cmd);
+
+	stats.commands++;
+	journal_read();
+
+	return TRUE;
+}
+
+/*
+ * Whether the player interrupted the game on this turn when it was recorded.
+ */
+bool journal_replay_interrupt(void)
+{
+	if (!replay_started || replay_done) return FALSE;
+	if (pending.tag != JREC_ABORT || pending.abort_turn != turn) return FALSE;
+
+	journal_read();
+	return TRUE;
+}
+
+/*
+ * Carry out all of the commands the player gave in a nested context, such
+ * as a store, in place of that context's own interface.
+ */
+void journal_replay_context(cmd_context ctx)
+{
+	while (!replay_done && pending.tag == JREC_COMMAND && pending.ctx == ctx)
+		process_command(ctx, TRUE);
+}
+
+void journal_get_stats(struct journal_stats *s)
+{
+	*s = stats;
+}
@@ -0,0 +1,46 @@
+/* journal.h - command journal recording and replay */
+
+#ifndef INCLUDED_JOURNAL_H
+#define INCLUDED_JOURNAL_H
+
+#include "game-cmd.h"
+
+/*
+ * A journal is a compact binary log of every command the player gives,
+ * written next to the savefile as "<savefile>.jnl" (or "<savefile>.<n>.jnl"
+ * for later sessions of the same game).  Together with the
+ * checkpoint savefiles it refers to ("<savefile>.jnl.<n>") it allows a
+ * game to be re-run exactly from any checkpoint.
+ */
+
+/* Counters for the journal being written or replayed */
+struct journal_stats {
+	u32b commands;		/* Commands recorded or replayed */
+	u32b checkpoints;	/* Checkpoints written or passed */
+	u32b mismatches;	/* Checkpoints where the replayed game differed */
+};
+
+/* Recording */
+void journal_begin(void);
+void journal_checkpoint(void);
+void journal_record_cmd(cmd_context ctx, const game_command *cmd);
+void journal_record_interrupt(void);
+void journal_close(void);
+
+/* Replay */
+bool journal_replay_open(const char *path, int checkpoint);
+bool journal_is_replaying(void);
+const char *journal_replay_savefile(void);
+bool journal_replay_next(cmd_context ctx);
+bool journal_replay_interrupt(void);
+void journal_replay_context(cmd_context ctx);
+
+void journal_get_stats(struct journal_stats *stats);
+
+/* Called when a replay runs out of commands; NULL hands control to the UI */
+extern void (*journal_replay_done_hook)(void);
+
+/* Saves the game for a checkpoint; savefile_save() unless replaced */
+extern bool (*journal_save_hook)(const char *path);
+
+#endif /* INCLUDED_JOURNAL_H */
@@ -1969,6 +1969,9 @@ static int rd_stores(rd_item_t rd_item_version)
 				object_copy(&st_ptr->stock[k], i_ptr);
 			}
 		}
+
+		/* The stock index no longer describes the stock */
+		st_ptr->index_num = STORE_INDEX_STALE;
 	}
 
 	return 0;
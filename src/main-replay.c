@@ -0,0 +1,160 @@
+/*
+ * File: main-replay.c
+ * Purpose: Pseudo-UI which replays a command journal as fast as possible
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "journal.h"
+#include <time.h>
+
+#ifdef USE_TEST
+
+static bool quiet = FALSE;
+static clock_t replay_start;
+
+/*
+ * Report on the replay once the journal has run out.
+ */
+static void replay_done(void)
+{
+	struct journal_stats stats;
+	double secs = (double)(clock() - replay_start) / CLOCKS_PER_SEC;
+
+	journal_get_stats(&stats);
+
+	if (!quiet) {
+		printf("Replayed %u commands to turn %d in %.2f seconds.\n",
+				stats.commands, turn, secs);
+		printf("Passed %u checkpoints, %u out of step.\n", stats.checkpoints,
+				stats.mismatches);
+	}
+
+	if (stats.mismatches)
+		quit_fmt("Replay went out of step with the journal.");
+
+	quit(NULL);
+}
+
+typedef struct term_data term_data;
+struct term_data {
+	term t;
+};
+
+static term_data td;
+
+static void term_init_replay(term *t) {
+	return;
+}
+
+static void term_nuke_replay(term *t) {
+	return;
+}
+
+static errr term_xtra_replay(int n, int v) {
+	/*
+	 * Anything still waiting for a key is a prompt the journal can't
+	 * answer, so dismiss it.
+	 */
+	if (n == TERM_XTRA_EVENT)
+		Term_keypress(ESCAPE, 0);
+
+	return 0;
+}
+
+static errr term_curs_replay(int x, int y) {
+	return 0;
+}
+
+static errr term_wipe_replay(int x, int y, int n) {
+	return 0;
+}
+
+static errr term_text_replay(int x, int y, int n, int a, const wchar_t *s) {
+	return 0;
+}
+
+static void term_data_link(int i) {
+	term *t = &td.t;
+
+	term_init(t, 80, 24, 256);
+
+	/* Ignore some actions for efficiency and safety */
+	t->never_bored = TRUE;
+	t->never_frosh = TRUE;
+
+	t->init_hook = term_init_replay;
+	t->nuke_hook = term_nuke_replay;
+
+	t->xtra_hook = term_xtra_replay;
+	t->curs_hook = term_curs_replay;
+	t->wipe_hook = term_wipe_replay;
+	t->text_hook = term_text_replay;
+
+	t->data = &td;
+
+	Term_activate(t);
+
+	angband_term[i] = t;
+}
+
+const char help_replay[] = "Replay mode, subopts <journal> -c<checkpoint> -q(uiet)";
+
+/*
+ * Usage:
+ *
+ * angband -mreplay -- <journal> [-cN] [-q]
+ *
+ *   <journal>  The journal to replay, usually "<savefile>.jnl"; later
+ *              sessions of the same game are "<savefile>.<n>.jnl"
+ *   -cN        Start from checkpoint N rather than the start of the journal
+ *   -q         Don't report on the replay
+ */
+errr init_replay(int argc, char *argv[]) {
+	const char *path = NULL;
+	int checkpoint = 0;
+	int i;
+
+	/* Skip over argv[0] */
+	for (i = 1; i < argc; i++) {
+		if (prefix(argv[i], "-c")) {
+			checkpoint = atoi(&argv[i][2]);
+			continue;
+		}
+		if (streq(argv[i], "-q")) {
+			quiet = TRUE;
+			continue;
+		}
+		if (argv[i][0] != '-' && !path) {
+			path = argv[i];
+			continue;
+		}
+		printf("init-replay: bad argument '%s'\n", argv[i]);
+	}
+
+	if (!path) {
+		printf("init-replay: no journal given\n");
+		return 1;
+	}
+
+	if (!journal_replay_open(path, checkpoint))
+		return 1;
+
+	journal_replay_done_hook = replay_done;
+	replay_start = clock();
+
+	term_data_link(0);
+	return 0;
+}
+
+#endif /* USE_TEST */
@@ -1648,8 +1648,14 @@ static errr run_stats(void)
 	}
 
 	if (!quiet) {
+		struct object_power_stats power_stats;
+
+		object_power_get_stats(&power_stats);
+
 		progress_bar(num_runs, start);
-		printf("\nSaving the data...\n");
+		printf("\nObject power cache: %u hits, %u misses.\n",
+			power_stats.hits, power_stats.misses);
+		printf("Saving the data...\n");
 		fflush(stdout);
 	}
 
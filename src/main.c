@@ -56,6 +56,7 @@ static const struct module modules[] =
 
 #ifdef USE_TEST
 	{ "test", help_test, init_test },
+	{ "replay", help_replay, init_replay },
 #endif /* !USE_TEST */
 
 #ifdef USE_STATS
@@ -363,10 +364,13 @@ static void debug_opt(const char *arg) {
 		mem_flags |= MEM_POISON_ALLOC;
 	else if (streq(arg, "mem-poison-free"))
 		mem_flags |= MEM_POISON_FREE;
+	else if (streq(arg, "randart-log"))
+		randart_verbose = TRUE;
 	else {
 		puts("Debug flags:");
 		puts("  mem-poison-alloc: Poison all memory allocations");
 		puts("   mem-poison-free: Poison all freed memory");
+		puts("       randart-log: Log randart generation to randart.log");
 		exit(0);
 	}
 }
@@ -447,6 +451,10 @@ int main(int argc, char *argv[])
 				arg_rebalance = TRUE;
 				break;
 
+			case 'j':
+				arg_journal = TRUE;
+				break;
+
 			case 'g':
 				/* Default graphics tile */
 				/* in graphics.txt, 2 corresponds to adam bolt's tiles */
@@ -508,6 +516,7 @@ int main(int argc, char *argv[])
 				puts("  -l             Lists all savefiles you can play");
 				puts("  -w             Resurrect dead character (marks savefile)");
 				puts("  -r             Rebalance monsters");
+				puts("  -j             Record a command journal next to the savefile");
 				puts("  -g             Request graphics mode");
 				puts("  -x<opt>        Debug options; see -xhelp");
 				puts("  -u<who>        Use your <who> savefile");
@@ -31,6 +31,7 @@ extern errr init_vme(int argc, char **argv);
 extern errr init_vcs(int argc, char **argv);
 extern errr init_sdl(int argc, char **argv);
 extern errr init_test(int argc, char **argv);
+extern errr init_replay(int argc, char **argv);
 extern errr init_stats(int argc, char **argv);
 
 
@@ -50,6 +51,7 @@ extern const char help_ibm[];
 extern const char help_dos[];
 extern const char help_sdl[];
 extern const char help_test[];
+extern const char help_replay[];
 extern const char help_stats[];
 
 
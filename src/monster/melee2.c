@@ -159,22 +159,19 @@ static bool summon_possible(int y1, int x1)
  */
 static int choose_attack_spell(struct monster *m_ptr, bitflag f[RSF_SIZE])
 {
-	int num = 0;
-	byte spells[RSF_MAX];
-
-	int i;
-
-	/* Extract all spells: "innate", "normal", "bizarre" */
-	for (i = FLAG_START, num = 0; i < RSF_MAX; i++)
-	{
-		if (rsf_has(f, i)) spells[num++] = i;
-	}
+	/* Count all spells: "innate", "normal", "bizarre" */
+	int num = rsf_count(f);
+	int spell, pick;
 
 	/* Paranoia */
 	if (num == 0) return 0;
 
 	/* Pick at random */
-	return (spells[randint0(num)]);
+	pick = randint0(num);
+	for (spell = rsf_next(f, FLAG_START); pick > 0; pick--)
+		spell = rsf_next(f, spell + 1);
+
+	return spell;
 }
 
 
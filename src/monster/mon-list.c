@@ -31,39 +31,61 @@ typedef struct monster_list_entry_s {
 	monster_race *race;
 	u16b count[MONSTER_LIST_SECTION_MAX];
 	u16b asleep[MONSTER_LIST_SECTION_MAX];
-	s16b dx, dy;
-	byte attr;
+	u32b midx_sum[MONSTER_LIST_SECTION_MAX];
+	s16b rep_midx;
 } monster_list_entry_t;
 
+/**
+ * What one monster currently adds to the list, so that it can be taken out
+ * again when the monster changes.
+ */
+typedef struct monster_list_ref_s {
+	monster_race *race;
+	byte section;
+	bool asleep;
+} monster_list_ref_t;
+
 typedef struct monster_list_s {
 	monster_list_entry_t *entries;
 	size_t entries_size;
 	u16b distinct_entries;
-	s32b creation_turn;
 	bool sorted;
 	u16b total_entries[MONSTER_LIST_SECTION_MAX];
 	u16b total_monsters[MONSTER_LIST_SECTION_MAX];
+
+	s16b *race_entry;
+	monster_list_ref_t *refs;
+	size_t refs_size;
 } monster_list_t;
 
 /**
- * Allocate a new monster list based on the size of the current cave's monster array.
+ * Monsters that have changed since the list was last brought up to date,
+ * and whether the list has to be rebuilt from scratch instead.
+ */
+static s16b *monster_list_changed = NULL;
+static bool *monster_list_changed_mark = NULL;
+static size_t monster_list_changed_num = 0;
+static bool monster_list_rebuild = TRUE;
+
+/**
+ * Allocate a new monster list, big enough for every race and every monster.
  */
 static monster_list_t *monster_list_new(void)
 {
 	monster_list_t *list = ZNEW(monster_list_t);
-	size_t size = cave_monster_max(cave);
+	int i;
 
 	if (list == NULL)
 		return NULL;
 
-	list->entries = C_ZNEW(size, monster_list_entry_t);
-
-	if (list->entries == NULL) {
-		FREE(list);
-		return NULL;
-	}
+	list->entries_size = z_info->r_max;
+	list->entries = C_ZNEW(list->entries_size, monster_list_entry_t);
+	list->race_entry = C_ZNEW(z_info->r_max, s16b);
+	list->refs_size = z_info->m_max;
+	list->refs = C_ZNEW(list->refs_size, monster_list_ref_t);
 
-	list->entries_size = size;
+	for (i = 0; i < z_info->r_max; i++)
+		list->race_entry[i] = -1;
 
 	return list;
 }
@@ -76,13 +98,10 @@ static void monster_list_free(monster_list_t *list)
 	if (list == NULL)
 		return;
 
-	if (list->entries != NULL) {
-		FREE(list->entries);
-		list->entries = NULL;
-	}
-
+	FREE(list->entries);
+	FREE(list->race_entry);
+	FREE(list->refs);
 	FREE(list);
-	list = NULL;
 }
 
 /**
@@ -90,12 +109,23 @@ static void monster_list_free(monster_list_t *list)
  */
 static monster_list_t *monster_list_subwindow = NULL;
 
+/**
+ * Queue every monster update_mon() looks at, since it may have moved,
+ * appeared or vanished.
+ */
+static void monster_list_vis_handler(struct monster *m_ptr, int changes)
+{
+	monster_list_notice(m_ptr->midx);
+}
+
 /**
  * Initialize the monster list module.
  */
 void monster_list_init(void)
 {
 	monster_list_subwindow = NULL;
+	monster_list_rebuild = TRUE;
+	monster_vis_add_handler(monster_list_vis_handler);
 }
 
 /**
@@ -103,7 +133,13 @@ void monster_list_init(void)
  */
 void monster_list_finalize(void)
 {
+	monster_vis_remove_handler(monster_list_vis_handler);
 	monster_list_free(monster_list_subwindow);
+	monster_list_subwindow = NULL;
+
+	FREE(monster_list_changed);
+	FREE(monster_list_changed_mark);
+	monster_list_changed_num = 0;
 }
 
 /**
@@ -113,136 +149,218 @@ static monster_list_t *monster_list_shared_instance(void)
 {
 	if (monster_list_subwindow == NULL) {
 		monster_list_subwindow = monster_list_new();
+		monster_list_rebuild = TRUE;
 	}
 
 	return monster_list_subwindow;
 }
 
 /**
- * Return TRUE if the list needs to be updated. Usually this is each turn or if
- * the number of cave monsters changes.
+ * Note that a monster may have changed in a way the list cares about: it
+ * appeared, disappeared, moved, fell asleep or woke up. The list catches up
+ * with all the noted monsters the next time it is shown.
+ *
+ * \param m_idx is the index of the monster in the current cave.
  */
-static bool monster_list_needs_update(const monster_list_t *list)
+void monster_list_notice(int m_idx)
 {
-	if (list == NULL || list->entries == NULL)
-		return FALSE;
+	if (m_idx <= 0 || m_idx >= z_info->m_max || monster_list_rebuild)
+		return;
 
-	return list->creation_turn != turn || (int)list->entries_size < cave_monster_max(cave);
+	if (monster_list_changed == NULL) {
+		monster_list_changed = C_ZNEW(z_info->m_max, s16b);
+		monster_list_changed_mark = C_ZNEW(z_info->m_max, bool);
+	}
+
+	if (monster_list_changed_mark[m_idx])
+		return;
+
+	monster_list_changed_mark[m_idx] = TRUE;
+	monster_list_changed[monster_list_changed_num++] = m_idx;
 }
 
 /**
- * Zero out the contents of a monster list. If needed, this function will reallocate
- * the entry list if the number of monsters has changed.
+ * Find the entry for a race, adding one if the race isn't listed yet.
  */
-static void monster_list_reset(monster_list_t *list)
+static monster_list_entry_t *monster_list_entry_for(monster_list_t *list, monster_race *race)
 {
-	if (list == NULL || list->entries == NULL)
-		return;
+	monster_list_entry_t *entry;
+	s16b index = list->race_entry[race->ridx];
 
-	if (!monster_list_needs_update(list))
-		return;
+	if (index >= 0)
+		return &list->entries[index];
+
+	if (list->distinct_entries >= list->entries_size)
+		return NULL;
+
+	index = list->distinct_entries++;
+	list->race_entry[race->ridx] = index;
+	list->sorted = FALSE;
+
+	entry = &list->entries[index];
+	WIPE(entry, monster_list_entry_t);
+	entry->race = race;
 
-	if ((int)list->entries_size < cave_monster_max(cave)) {
-		list->entries = mem_realloc(list->entries, sizeof(list->entries[0]) * cave_monster_max(cave));
-		list->entries_size = cave_monster_max(cave);
+	return entry;
+}
+
+/**
+ * Drop an entry that no longer has any monsters, filling its slot with the
+ * last entry.
+ */
+static void monster_list_entry_remove(monster_list_t *list, monster_list_entry_t *entry)
+{
+	size_t index = entry - list->entries;
+	size_t last = list->distinct_entries - 1;
+
+	list->race_entry[entry->race->ridx] = -1;
+
+	if (index != last) {
+		list->entries[index] = list->entries[last];
+		list->race_entry[list->entries[index].race->ridx] = index;
 	}
 
-	C_WIPE(list->entries, list->entries_size, monster_list_entry_t);
-	C_WIPE(&list->total_entries, MONSTER_LIST_SECTION_MAX, u16b);
-	C_WIPE(&list->total_monsters, MONSTER_LIST_SECTION_MAX, u16b);
-	list->distinct_entries = 0;
-	list->creation_turn = 0;
+	WIPE(&list->entries[last], monster_list_entry_t);
+	list->distinct_entries--;
 	list->sorted = FALSE;
 }
 
 /**
- * Collect monster information from the current cave's monster list.
+ * Bring one monster's contribution to the list up to date: take out what it
+ * added last time, then add what it looks like now.
  */
-static void monster_list_collect(monster_list_t *list)
+static void monster_list_update_monster(monster_list_t *list, int m_idx)
 {
-	int i;
+	monster_list_ref_t *ref;
+	monster_type *monster;
+	monster_list_entry_t *entry;
+	int field;
 
-	if (list == NULL || list->entries == NULL)
+	if (m_idx <= 0 || m_idx >= (int)list->refs_size)
 		return;
 
-	/* Use cave_monster_max() here in case the monster list isn't compacted. */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		monster_type *monster = cave_monster(cave, i);
-		monster_list_entry_t *entry = NULL;
-		int j, field;
-		bool los = FALSE;
+	ref = &list->refs[m_idx];
 
-		/* Only consider visible, known monsters */
-		if (!monster->ml || monster->unaware)
-			continue;
+	if (ref->race != NULL) {
+		entry = &list->entries[list->race_entry[ref->race->ridx]];
+		field = ref->section;
 
-		/* Find or add a list entry. */
-		for (j = 0; j < (int)list->entries_size; j++) {
-			if (list->entries[j].race == NULL) {
-				/* We found an empty slot, so add this race here. */
-				entry = &list->entries[j];
-				WIPE(entry, monster_list_entry_t);
-				entry->race = monster->race;
-
-				break;
-			}
-			else if (list->entries[j].race == monster->race) {
-				/* We found a matching race and we'll use that. */
-				entry = &list->entries[j];
-				break;
-			}
-		}
+		entry->count[field]--;
+		entry->midx_sum[field] -= m_idx;
+		if (ref->asleep)
+			entry->asleep[field]--;
 
-		if (entry == NULL)
-			continue;
+		list->total_monsters[field]--;
+		if (entry->count[field] == 0)
+			list->total_entries[field]--;
 
-		/* Always collect the latest monster attribute so that flicker animation works. */
-		entry->attr = (monster->attr > 0) ? monster->attr : monster->race->x_attr;
+		if (entry->rep_midx == m_idx)
+			entry->rep_midx = 0;
 
-		/* Skip the projection and location checks if nothing has changed. */
-		if (!monster_list_needs_update(list))
-			continue;
+		if (entry->count[MONSTER_LIST_SECTION_LOS] == 0 && entry->count[MONSTER_LIST_SECTION_ESP] == 0)
+			monster_list_entry_remove(list, entry);
 
-		/*
-		 * Check for LOS
-		 * Hack - we should use (m_ptr->mflag & (MFLAG_VIEW)) here,
-		 * but this does not catch monsters detected by ESP which are
-		 * targetable, so we cheat and use projectable() instead
-		 */
-		los = projectable(p_ptr->py, p_ptr->px, monster->fy, monster->fx, PROJECT_NONE);
-		field = (los) ? MONSTER_LIST_SECTION_LOS : MONSTER_LIST_SECTION_ESP;
-		entry->count[field]++;
-
-		if (monster->m_timed[MON_TMD_SLEEP] > 0)
-			entry->asleep[field]++;
-
-		/* Store the location offset from the player; this is only used for monster counts of 1 */
-		entry->dx = monster->fx - p_ptr->px;
-		entry->dy = monster->fy - p_ptr->py;
+		WIPE(ref, monster_list_ref_t);
 	}
 
-	/* Skip calculations if nothing has changed, otherwise this will yield incorrect numbers. */
-	if (!monster_list_needs_update(list))
+	if (m_idx >= cave_monster_max(cave))
 		return;
 
-	/* Collect totals for easier calculations of the list. */
-	for (i = 0; i < (int)list->entries_size; i++) {
-		if (list->entries[i].race == NULL)
-			continue;
+	monster = cave_monster(cave, m_idx);
+
+	/* Only consider visible, known monsters */
+	if (monster->race == NULL || !monster->ml || monster->unaware)
+		return;
+
+	entry = monster_list_entry_for(list, monster->race);
+
+	if (entry == NULL)
+		return;
+
+	/*
+	 * Check for LOS
+	 * Hack - we should use (m_ptr->mflag & (MFLAG_VIEW)) here,
+	 * but this does not catch monsters detected by ESP which are
+	 * targetable, so we cheat and use projectable() instead
+	 */
+	field = projectable(p_ptr->py, p_ptr->px, monster->fy, monster->fx, PROJECT_NONE) ? MONSTER_LIST_SECTION_LOS : MONSTER_LIST_SECTION_ESP;
+
+	if (entry->count[field] == 0)
+		list->total_entries[field]++;
+
+	entry->count[field]++;
+	entry->midx_sum[field] += m_idx;
+	list->total_monsters[field]++;
+	entry->rep_midx = m_idx;
+
+	ref->race = monster->race;
+	ref->section = field;
+	ref->asleep = monster->m_timed[MON_TMD_SLEEP] > 0;
+
+	if (ref->asleep)
+		entry->asleep[field]++;
+}
+
+/**
+ * Bring the list up to date with the current cave's monsters. Usually only
+ * the monsters noted since the last update are looked at; after a level
+ * change or anything else that shuffles the monster array, everything is.
+ */
+static void monster_list_collect(monster_list_t *list)
+{
+	size_t i;
+	int j;
+	bool lost_rep = FALSE;
+
+	if (list == NULL || list->entries == NULL)
+		return;
 
-		if (list->entries[i].count[MONSTER_LIST_SECTION_LOS] > 0)
-			list->total_entries[MONSTER_LIST_SECTION_LOS]++;
+	if (monster_list_rebuild) {
+		C_WIPE(list->entries, list->entries_size, monster_list_entry_t);
+		C_WIPE(list->refs, list->refs_size, monster_list_ref_t);
+		C_WIPE(&list->total_entries, MONSTER_LIST_SECTION_MAX, u16b);
+		C_WIPE(&list->total_monsters, MONSTER_LIST_SECTION_MAX, u16b);
+		list->distinct_entries = 0;
+		list->sorted = FALSE;
 
-		if (list->entries[i].count[MONSTER_LIST_SECTION_ESP] > 0)
-			list->total_entries[MONSTER_LIST_SECTION_ESP]++;
+		for (j = 0; j < z_info->r_max; j++)
+			list->race_entry[j] = -1;
 
-		list->total_monsters[MONSTER_LIST_SECTION_LOS] += list->entries[i].count[MONSTER_LIST_SECTION_LOS];
-		list->total_monsters[MONSTER_LIST_SECTION_ESP] += list->entries[i].count[MONSTER_LIST_SECTION_ESP];
-		list->distinct_entries++;
+		/* Use cave_monster_max() here in case the monster list isn't compacted. */
+		for (j = 1; j < cave_monster_max(cave); j++)
+			monster_list_update_monster(list, j);
+
+		for (i = 0; i < monster_list_changed_num; i++)
+			monster_list_changed_mark[monster_list_changed[i]] = FALSE;
+
+		monster_list_changed_num = 0;
+		monster_list_rebuild = FALSE;
+		return;
 	}
 
-	list->creation_turn = turn;
-	list->sorted = FALSE;
+	for (i = 0; i < monster_list_changed_num; i++) {
+		s16b m_idx = monster_list_changed[i];
+
+		monster_list_changed_mark[m_idx] = FALSE;
+		monster_list_update_monster(list, m_idx);
+	}
+
+	monster_list_changed_num = 0;
+
+	/* Find new stand-ins for entries whose stand-in went away */
+	for (i = 0; i < list->distinct_entries; i++)
+		if (list->entries[i].rep_midx == 0)
+			lost_rep = TRUE;
+
+	if (!lost_rep)
+		return;
+
+	for (j = 1; j < (int)list->refs_size; j++) {
+		monster_list_ref_t *ref = &list->refs[j];
+
+		if (ref->race != NULL && list->entries[list->race_entry[ref->race->ridx]].rep_midx == 0)
+			list->entries[list->race_entry[ref->race->ridx]].rep_midx = j;
+	}
 }
 
 /**
@@ -280,6 +398,7 @@ static int monster_list_standard_compare(const void *a, const void *b)
 static void monster_list_sort(monster_list_t *list, int (*compare)(const void *, const void *))
 {
 	size_t elements;
+	size_t i;
 
 	if (list == NULL || list->entries == NULL)
 		return;
@@ -294,6 +413,9 @@ static void monster_list_sort(monster_list_t *list, int (*compare)(const void *,
 
 	sort(list->entries, elements, sizeof(list->entries[0]), compare);
 	list->sorted = TRUE;
+
+	for (i = 0; i < elements; i++)
+		list->race_entry[list->entries[i].race->ridx] = i;
 }
 
 /**
@@ -313,6 +435,22 @@ static byte monster_list_entry_line_attribute(const monster_list_entry_t *entry)
 		return TERM_WHITE;
 }
 
+/**
+ * Return the attribute to draw an entry's monster symbol with. The latest
+ * attribute of one of its monsters is used so that flicker animation works.
+ */
+static byte monster_list_entry_symbol_attribute(const monster_list_entry_t *entry)
+{
+	if (entry->rep_midx > 0 && entry->rep_midx < cave_monster_max(cave)) {
+		const monster_type *monster = cave_monster(cave, entry->rep_midx);
+
+		if (monster->race == entry->race && monster->attr > 0)
+			return monster->attr;
+	}
+
+	return entry->race->x_attr;
+}
+
 /**
  * Format a section of the monster list: a header followed by monster list entry rows.
  *
@@ -381,9 +519,13 @@ static void monster_list_format_section(const monster_list_t *list, textblock *t
 
 		/* It doesn't make sense to display directions for more than one monster. */
 		if (list->entries[entry_index].count[section] == 1) {
-			const char *direction1 = (list->entries[entry_index].dy <= 0) ? "N" : "S";
-			const char *direction2 = (list->entries[entry_index].dx <= 0) ? "W" : "E";
-			strnfmt(location, sizeof(location), " %d %s %d %s", abs(list->entries[entry_index].dy), direction1, abs(list->entries[entry_index].dx), direction2);
+			/* With only one monster counted, the index sum is its index */
+			const monster_type *monster = cave_monster(cave, list->entries[entry_index].midx_sum[section]);
+			int dx = monster->fx - p_ptr->px;
+			int dy = monster->fy - p_ptr->py;
+			const char *direction1 = (dy <= 0) ? "N" : "S";
+			const char *direction2 = (dx <= 0) ? "W" : "E";
+			strnfmt(location, sizeof(location), " %d %s %d %s", abs(dy), direction1, abs(dx), direction2);
 		}
 
 		/* Get width available for monster name and sleep tag: 2 for char and space; location includes padding; last -1 for some reason? */
@@ -404,7 +546,7 @@ static void monster_list_format_section(const monster_list_t *list, textblock *t
 
 		/* textblock_append_pict will safely add the monster symbol, regardless of ASCII/graphics mode. */
 		if (tb != NULL && tile_width == 1 && tile_height == 1) {
-			textblock_append_pict(tb, list->entries[entry_index].attr, list->entries[entry_index].race->x_char);
+			textblock_append_pict(tb, monster_list_entry_symbol_attribute(&list->entries[entry_index]), list->entries[entry_index].race->x_char);
 			textblock_append(tb, " ");
 		}
 
@@ -566,7 +708,6 @@ void monster_list_show_subwindow(int height, int width)
 	tb = textblock_new();
 	list = monster_list_shared_instance();
 
-	monster_list_reset(list);
 	monster_list_collect(list);
 	monster_list_sort(list, monster_list_standard_compare);
 
@@ -596,7 +737,7 @@ void monster_list_show_interactive(int height, int width)
 		return;
 
 	tb = textblock_new();
-	list = monster_list_new();
+	list = monster_list_shared_instance();
 
 	monster_list_collect(list);
 	monster_list_sort(list, monster_list_standard_compare);
@@ -628,17 +769,16 @@ void monster_list_show_interactive(int height, int width)
 	textui_textblock_show(tb, r, NULL);
 
 	textblock_free(tb);
-	monster_list_free(list);
 }
 
 /**
- * Force an update to the monster list subwindow.
+ * Force the monster list to be rebuilt from scratch.
  *
- * There are conditions that monster_list_reset() can't catch, so we set the turn
- * an invalid value to force the list to update.
+ * Monsters are only noted one at a time as they change, so anything that
+ * replaces or reorders the whole monster array (such as a level change or
+ * compacting the monsters) must call this instead.
  */
 void monster_list_force_subwindow_update(void)
 {
-	monster_list_t *list = monster_list_shared_instance();
-	list->creation_turn = -1;
+	monster_list_rebuild = TRUE;
 }
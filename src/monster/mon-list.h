@@ -27,5 +27,6 @@ void monster_list_finalize(void);
 void monster_list_show_subwindow(int height, int width);
 void monster_list_show_interactive(int height, int width);
 void monster_list_force_subwindow_update(void);
+void monster_list_notice(int m_idx);
 
 #endif /* MONSTER_LIST_H */
@@ -1852,25 +1852,18 @@ void lore_title(textblock *tb, const monster_race *race)
 }
 
 /**
- * Place a full monster recall description (with title) into a textblock, with or without spoilers.
+ * Place a full monster recall description into a textblock, using the given attack colors.
  *
- * \param tb is the textblock we are placing the description into.
- * \param race is the monster race we are describing.
- * \param original_lore is the known information about the monster race.
- * \param spoilers indicates what information is used; `TRUE` will display full information without subjective information and monstor flavor, while `FALSE` only shows what the player knows.
+ * This does the work for lore_description() and lore_recall(); see the former for the parameters.
  */
-void lore_description(textblock *tb, const monster_race *race, const monster_lore *original_lore, bool spoilers)
+static void lore_describe(textblock *tb, const monster_race *race, const monster_lore *original_lore, bool spoilers, const int melee_colors[RBE_MAX], const int spell_colors[RSF_MAX])
 {
 	monster_lore mutable_lore;
 	monster_lore *lore = &mutable_lore;
 	bitflag known_flags[RF_SIZE];
-	int melee_colors[RBE_MAX], spell_colors[RSF_MAX];
 
 	assert(tb && race && original_lore);
 
-	/* Determine the special attack colors */
-	get_attack_colors(melee_colors, spell_colors);
-
 	/* Hack -- create a copy of the monster-memory that we can modify */
 	COPY(lore, original_lore, monster_lore);
 
@@ -1933,6 +1926,138 @@ void lore_description(textblock *tb, const monster_race *race, const monster_lor
 	textblock_append(tb, "\n");
 }
 
+/**
+ * Place a full monster recall description (with title) into a textblock, with or without spoilers.
+ *
+ * \param tb is the textblock we are placing the description into.
+ * \param race is the monster race we are describing.
+ * \param original_lore is the known information about the monster race.
+ * \param spoilers indicates what information is used; `TRUE` will display full information without subjective information and monstor flavor, while `FALSE` only shows what the player knows.
+ */
+void lore_description(textblock *tb, const monster_race *race, const monster_lore *original_lore, bool spoilers)
+{
+	int melee_colors[RBE_MAX], spell_colors[RSF_MAX];
+
+	assert(tb && race && original_lore);
+
+	/* Determine the special attack colors */
+	get_attack_colors(melee_colors, spell_colors);
+
+	lore_describe(tb, race, original_lore, spoilers, melee_colors, spell_colors);
+}
+
+/**
+ * Everything outside the lore itself that the recall text depends on.
+ *
+ * Keys are wiped before they are filled in so that they can be compared with memcmp().
+ */
+struct lore_recall_key {
+	int melee_colors[RBE_MAX];
+	int spell_colors[RSF_MAX];
+	int hit_chance;
+	s16b lev;
+	s16b max_depth;
+	byte max_num;
+	byte x_attr;
+	wchar_t x_char;
+	bool cheat_know;
+	bool purple_uniques;
+	bool small_range;
+	bool big_tile;
+};
+
+/**
+ * A rendered recall for one race, along with what it was rendered from.
+ */
+struct lore_recall {
+	monster_lore lore;
+	struct lore_recall_key key;
+	textblock *tb;
+};
+
+/* Rendered recalls, indexed by race; allocated as races are first recalled */
+static struct lore_recall **lore_recalls;
+
+/**
+ * Fill in the recall key for a race from the current state of the player and the options.
+ */
+static void lore_recall_key(struct lore_recall_key *key, const monster_race *race)
+{
+	WIPE(key, struct lore_recall_key);
+
+	get_attack_colors(key->melee_colors, key->spell_colors);
+	key->hit_chance = py_attack_hit_chance(&p_ptr->inventory[INVEN_WIELD]);
+	key->lev = p_ptr->lev;
+	key->max_depth = p_ptr->max_depth;
+	key->max_num = race->max_num;
+	key->x_attr = race->x_attr;
+	key->x_char = race->x_char;
+	key->cheat_know = OPT(cheat_know);
+	key->purple_uniques = OPT(purple_uniques);
+	key->small_range = OPT(birth_small_range);
+	key->big_tile = (tile_width != 1) || (tile_height != 1);
+}
+
+/**
+ * Return the recall description (with title) of a monster race, as lore_description() would write it without spoilers.
+ *
+ * The text is kept per race and only rebuilt when the lore, or something about the player that the text mentions, has changed since it was last rendered. The textblock belongs to the cache; callers may display it but must not change or free it, and it is only good until the next call.
+ *
+ * \param race is the monster race we are describing.
+ * \param lore is the known information about the monster race.
+ */
+textblock *lore_recall(const monster_race *race, const monster_lore *lore)
+{
+	struct lore_recall *recall;
+	struct lore_recall_key key;
+
+	assert(race && lore);
+
+	if (!lore_recalls)
+		lore_recalls = C_ZNEW(z_info->r_max, struct lore_recall *);
+
+	recall = lore_recalls[race->ridx];
+	if (!recall) {
+		recall = mem_zalloc(sizeof(*recall));
+		lore_recalls[race->ridx] = recall;
+	}
+
+	lore_recall_key(&key, race);
+
+	if (recall->tb && !memcmp(&recall->lore, lore, sizeof(*lore)) &&
+			!memcmp(&recall->key, &key, sizeof(key)))
+		return recall->tb;
+
+	if (recall->tb)
+		textblock_free(recall->tb);
+
+	recall->tb = textblock_new();
+	lore_describe(recall->tb, race, lore, FALSE, key.melee_colors, key.spell_colors);
+	COPY(&recall->lore, lore, monster_lore);
+	recall->key = key;
+
+	return recall->tb;
+}
+
+/**
+ * Free the rendered recalls.
+ */
+void lore_recall_free(void)
+{
+	int i;
+
+	if (!lore_recalls) return;
+
+	for (i = 0; i < z_info->r_max; i++) {
+		if (!lore_recalls[i]) continue;
+		if (lore_recalls[i]->tb)
+			textblock_free(lore_recalls[i]->tb);
+		mem_free(lore_recalls[i]);
+	}
+
+	FREE(lore_recalls);
+}
+
 /**
  * Display monster recall modally and wait for a keypress.
  *
@@ -1943,15 +2068,11 @@ void lore_description(textblock *tb, const monster_race *race, const monster_lor
  */
 void lore_show_interactive(const monster_race *race, const monster_lore *lore)
 {
-	textblock *tb;
 	assert(race && lore);
 
 	message_flush();
 
-	tb = textblock_new();
-	lore_description(tb, race, lore, FALSE);
-	textui_textblock_show(tb, SCREEN_REGION, NULL);
-	textblock_free(tb);
+	textui_textblock_show(lore_recall(race, lore), SCREEN_REGION, NULL);
 }
 
 /**
@@ -1965,7 +2086,6 @@ void lore_show_interactive(const monster_race *race, const monster_lore *lore)
 void lore_show_subwindow(const monster_race *race, const monster_lore *lore)
 {
 	int y;
-	textblock *tb;
 
 	assert(race && lore);
 
@@ -1973,8 +2093,5 @@ void lore_show_subwindow(const monster_race *race, const monster_lore *lore)
 	for (y = 0; y < Term->hgt; y++)
 		Term_erase(0, y, 255);
 
-	tb = textblock_new();
-	lore_description(tb, race, lore, FALSE);
-	textui_textblock_place(tb, SCREEN_REGION, NULL);
-	textblock_free(tb);
+	textui_textblock_place(lore_recall(race, lore), SCREEN_REGION, NULL);
 }
@@ -37,6 +37,8 @@ void monster_flags_known(const monster_race *r_ptr, const monster_lore *l_ptr, b
 void lore_treasure(struct monster *m_ptr, int num_item, int num_gold);
 void lore_title(textblock *tb, const monster_race *r_ptr);
 void lore_description(textblock *tb, const monster_race *race, const monster_lore *original_lore, bool spoilers);
+textblock *lore_recall(const monster_race *race, const monster_lore *lore);
+void lore_recall_free(void);
 void lore_show_interactive(const monster_race *race, const monster_lore *lore);
 void lore_show_subwindow(const monster_race *race, const monster_lore *lore);
 
@@ -21,6 +21,7 @@
 #include "history.h"
 #include "init.h"
 #include "target.h"
+#include "monster/mon-list.h"
 #include "monster/mon-lore.h"
 #include "monster/mon-make.h"
 #include "monster/mon-timed.h"
@@ -159,6 +160,7 @@ void delete_monster_idx(int m_idx)
 
 	/* Monster is gone */
 	cave->m_idx[y][x] = 0;
+	cave_empty_update(cave, y, x);
 
 	/* Delete objects */
 	for (this_o_idx = m_ptr->hold_o_idx; this_o_idx; this_o_idx = next_o_idx)
@@ -194,6 +196,9 @@ void delete_monster_idx(int m_idx)
 	/* Count monsters */
 	cave->mon_cnt--;
 
+	/* Take it off the monster list */
+	monster_list_notice(m_idx);
+
 	/* Visual update */
 	cave_light_spot(cave, y, x);
 }
@@ -360,6 +365,10 @@ void compact_monsters(int num_to_compact)
 		/* Compress "cave->mon_max" */
 		cave->mon_max--;
 	}
+
+	/* Monsters have moved around in the array */
+	monster_list_force_subwindow_update();
+	target_index_reset();
 }
 
 
@@ -408,6 +417,10 @@ void wipe_mon_list(struct cave *c, struct player *p)
 
 	/* Hack -- no more tracking */
 	health_track(p, 0);
+
+	/* The monster list and targeting index start again */
+	monster_list_force_subwindow_update();
+	target_index_reset();
 }
 
 /**
@@ -634,6 +647,7 @@ void player_place(struct cave *c, struct player *p, int y, int x)
 
 	/* Mark cave grid */
 	c->m_idx[y][x] = -1;
+	cave_empty_update(c, y, x);
 }
 
 /**
@@ -796,6 +810,7 @@ s16b place_monster(int y, int x, monster_type *mon, byte origin)
 
 	/* Set the location */
 	cave->m_idx[y][x] = m_ptr->midx;
+	cave_empty_update(cave, y, x);
 	m_ptr->fy = y;
 	m_ptr->fx = x;
 	assert(cave_monster_at(cave, y, x) == m_ptr);
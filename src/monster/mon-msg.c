@@ -26,6 +26,41 @@ static u16b size_mon_msg = 0;
 monster_race_message *mon_msg;
 monster_message_history *mon_message_hist;
 
+/*
+ * Hash tables over mon_msg and mon_message_hist, so that stacking a message
+ * and checking whether it is redundant don't have to scan what is already
+ * queued. Both are open addressed and kept at least half empty. A slot is
+ * only in use if its stamp is the current mon_msg_stamp, which lets a flush
+ * empty them by bumping the stamp.
+ */
+#define MON_MSG_HASH_SIZE	512	/* At least 2 * MAX_STORED_MON_MSG */
+#define MON_HIST_HASH_SIZE	1024	/* At least 2 * MAX_STORED_MON_CODES */
+
+struct mon_msg_slot {
+	u32b stamp;
+	s16b idx;
+};
+
+static struct mon_msg_slot mon_msg_table[MON_MSG_HASH_SIZE];
+static struct mon_msg_slot mon_hist_table[MON_HIST_HASH_SIZE];
+static u32b mon_msg_stamp = 1;
+
+/*
+ * Flushed messages are written one after another into a scratch arena, and
+ * handed to msgt() once they are all written.
+ */
+#define MON_MSG_ARENA_SIZE	8192
+#define MON_MSG_MAX_LEN		512	/* Most one message may use */
+
+static char mon_msg_arena[MON_MSG_ARENA_SIZE];
+static size_t mon_msg_arena_used;
+
+static struct {
+	size_t start;	/* Offset of the message in the arena */
+	int type;	/* Message type for msgt() */
+} mon_msg_pending[MAX_STORED_MON_MSG];
+static int mon_msg_pending_num;
+
 /*
  * The NULL-terminated array of string actions used to format stacked messages.
  * Singular and plural modifiers are encoded in the same string. Example:
@@ -153,17 +188,14 @@ void message_pain(struct monster *m_ptr, int dam)
 #define PLURAL_MON     2
            
 /**
- * Returns a pointer to a statically allocatted string containing a formatted
- * message based on the given message code and the quantity flag.
- * The contents of the returned value will change with the next call
- * to this function
+ * Write into `buf` the action for the given message code and quantity flag,
+ * and return its length.
  */
-static char *get_mon_msg_action(byte msg_code, bool do_plural,
-		const struct monster_race *race)
+static size_t get_mon_msg_action(char *buf, size_t len, byte msg_code,
+		bool do_plural, const struct monster_race *race)
 {
-	static char buf[200];
 	const char *action;
-	u16b n = 0;
+	size_t n = 0;
 
 	/* Regular text */
 	byte flag = 0;
@@ -195,7 +227,7 @@ static char *get_mon_msg_action(byte msg_code, bool do_plural,
 	/* Put the message characters in the buffer */
 	for (; *action; action++) {
 		/* Check available space */
-		if (n >= (sizeof(buf) - 1)) break;
+		if (n >= len - 1) break;
 
 		/* Are we parsing a quantity modifier? */
 		if (flag) {
@@ -238,7 +270,63 @@ static char *get_mon_msg_action(byte msg_code, bool do_plural,
 	buf[n] = '\0';
 
 	/* Done */
-	return (buf);
+	return n;
+}
+
+/**
+ * Hash a key for the message tables.
+ */
+static u32b mon_msg_hash(u32b a, u32b b)
+{
+	u32b h = (a * 0x9E3779B1U) ^ (b * 0x85EBCA77U);
+
+	return h ^ (h >> 15);
+}
+
+/**
+ * Find where the history entry for a monster and message code is in the
+ * history table, or the empty slot where it would go.
+ */
+static struct mon_msg_slot *mon_hist_slot(struct monster *m_ptr, int msg_code)
+{
+	u32b h = mon_msg_hash((u32b)((size_t)m_ptr / sizeof(*m_ptr)), msg_code);
+
+	while (TRUE) {
+		struct mon_msg_slot *slot = &mon_hist_table[h & (MON_HIST_HASH_SIZE - 1)];
+		const monster_message_history *hist;
+
+		if (slot->stamp != mon_msg_stamp) return slot;
+
+		hist = &mon_message_hist[slot->idx];
+		if (hist->mon == m_ptr && hist->message_code == msg_code)
+			return slot;
+
+		h++;
+	}
+}
+
+/**
+ * Find where the stacked message for a race, set of monster flags and
+ * message code is in the message table, or the empty slot where it would go.
+ */
+static struct mon_msg_slot *mon_msg_slot(const monster_race *race,
+		byte mon_flags, int msg_code)
+{
+	u32b h = mon_msg_hash(race->ridx * 8 + mon_flags, msg_code);
+
+	while (TRUE) {
+		struct mon_msg_slot *slot = &mon_msg_table[h & (MON_MSG_HASH_SIZE - 1)];
+		const monster_race_message *msg;
+
+		if (slot->stamp != mon_msg_stamp) return slot;
+
+		msg = &mon_msg[slot->idx];
+		if (msg->race == race && msg->mon_flags == mon_flags &&
+				msg->msg_code == msg_code)
+			return slot;
+
+		h++;
+	}
 }
 
 /**
@@ -248,26 +336,13 @@ static char *get_mon_msg_action(byte msg_code, bool do_plural,
  */
 static bool redundant_monster_message(struct monster *m_ptr, int msg_code)
 {
-	int i;
-
 	assert(m_ptr);
 	assert(msg_code >= 0 && msg_code < MAX_MON_MSG);
 
 	/* No messages yet */
 	if (!size_mon_hist) return FALSE;
 
-	for (i = 0; i < size_mon_hist; i++) {
-		/* Not the same monster */
-		if (m_ptr != mon_message_hist[i].mon) continue;
-
-		/* Not the same code */
-		if (msg_code != mon_message_hist[i].message_code) continue;
-
-		/* We have a match. */
-		return (TRUE);
-	}
-
-	return (FALSE);
+	return mon_hist_slot(m_ptr, msg_code)->stamp == mon_msg_stamp;
 }
 
 
@@ -282,6 +357,7 @@ bool add_monster_message(const char *mon_name, struct monster *m_ptr,
 {
 	int i;
 	byte mon_flags = 0;
+	struct mon_msg_slot *slot;
 
 	assert(msg_code >= 0 && msg_code < MAX_MON_MSG);
 
@@ -301,28 +377,30 @@ bool add_monster_message(const char *mon_name, struct monster *m_ptr,
 		mon_flags |= 0x04;
 
 	/* Query if the message is already stored */
-	for (i = 0; i < size_mon_msg; i++)
+	slot = mon_msg_slot(m_ptr->race, mon_flags, msg_code);
+	if (slot->stamp == mon_msg_stamp)
 	{
-		/* We found the race and the message code */
-		if ((mon_msg[i].race == m_ptr->race) &&
-			(mon_msg[i].mon_flags == mon_flags) &&
-			(mon_msg[i].msg_code == msg_code))
+		i = slot->idx;
+
+		/* Can we increment the counter? */
+		if (mon_msg[i].mon_count < MAX_UCHAR)
 		{
-			/* Can we increment the counter? */
-			if (mon_msg[i].mon_count < MAX_UCHAR)
-			{
-				/* Stack the message */
-				++(mon_msg[i].mon_count);
-			}
-   
-			/* Success */
-			return (TRUE);
+			/* Stack the message */
+			++(mon_msg[i].mon_count);
 		}
+
+		/* Success */
+		return (TRUE);
 	}
    
 	/* The message isn't stored. Check free space */
 	if (size_mon_msg >= MAX_STORED_MON_MSG) return (FALSE);
 
+	/* Take the next free entry */
+	i = size_mon_msg;
+	slot->stamp = mon_msg_stamp;
+	slot->idx = i;
+
 	/* Assign the message data to the free slot */
 	mon_msg[i].race = m_ptr->race;
 	mon_msg[i].mon_flags = mon_flags;
@@ -347,6 +425,9 @@ bool add_monster_message(const char *mon_name, struct monster *m_ptr,
 	if (size_mon_hist >= MAX_STORED_MON_CODES) return (TRUE);
 	mon_message_hist[size_mon_hist].mon = m_ptr;
 	mon_message_hist[size_mon_hist].message_code = msg_code;
+	slot = mon_hist_slot(m_ptr, msg_code);
+	slot->stamp = mon_msg_stamp;
+	slot->idx = size_mon_hist;
 	size_mon_hist++;
 
 	/* Success */
@@ -354,143 +435,175 @@ bool add_monster_message(const char *mon_name, struct monster *m_ptr,
 }
 
 /**
- * Show and delete the stacked monster messages.
- * Some messages are delayed so that they show up after everything else.
- * This is to avoid things like "The snaga dies. The snaga runs in fear!"
- * So we only flush messages matching the delay parameter.
+ * Copy a string into a message being written, as far as it fits.
  */
-static void flush_monster_messages(bool delay, byte delay_tag)
+static size_t mon_msg_put(char *buf, size_t len, size_t n, const char *str)
 {
-	const monster_race *r_ptr;
-	int i, count;
-	char buf[512];
-	char *action;
-	bool action_only;
+	while (*str && n < len - 1)
+		buf[n++] = *str++;
 
-	/* Show every message */
-	for (i = 0; i < size_mon_msg; i++) {
-		int type = MSG_GENERIC;
+	buf[n] = '\0';
+	return n;
+}
 
-		if (mon_msg[i].delay != delay) continue;
+/**
+ * Hand the messages written so far to msgt() and empty the arena.
+ */
+static void mon_msg_emit(void)
+{
+	int i;
 
-		/* Skip if we are delaying and the tags don't match */
-		if (mon_msg[i].delay && mon_msg[i].delay_tag != delay_tag) continue;
-   
-		/* Cache the monster count */
-		count = mon_msg[i].mon_count;
+	for (i = 0; i < mon_msg_pending_num; i++)
+		msgt(mon_msg_pending[i].type, "%s",
+				mon_msg_arena + mon_msg_pending[i].start);
 
-		/* Paranoia */
-		if (count < 1) continue;
+	mon_msg_pending_num = 0;
+	mon_msg_arena_used = 0;
+}
 
-		/* Start with an empty string */
-		buf[0] = '\0';
+/**
+ * Write one stacked monster message into the arena.
+ */
+static void mon_msg_write(const monster_race_message *msg)
+{
+	const monster_race *r_ptr = msg->race;
+	int count = msg->mon_count;
+	int type = MSG_GENERIC;
+	char action[200];
+	char *buf;
+	size_t n = 0, len = MON_MSG_MAX_LEN;
+	bool action_only;
 
-		/* Cache the race index */
-		r_ptr = mon_msg[i].race;
-		   
-		/* Get the proper message action */
-		action = get_mon_msg_action(mon_msg[i].msg_code, (count > 1), r_ptr);
+	/* Make room */
+	if (mon_msg_arena_used + len > MON_MSG_ARENA_SIZE ||
+			mon_msg_pending_num == MAX_STORED_MON_MSG)
+		mon_msg_emit();
 
-		/* Monster is marked as invisible */
-		if (mon_msg[i].mon_flags & 0x04) r_ptr = NULL;
+	buf = mon_msg_arena + mon_msg_arena_used;
+	buf[0] = '\0';
 
-		/* Special message? */
-		action_only = (*action == '~');
+	/* Get the proper message action */
+	get_mon_msg_action(action, sizeof(action), msg->msg_code, (count > 1), r_ptr);
 
-		/* Format the proper message for visible monsters */
-		if (r_ptr && !action_only)
-		{
-			char race_name[80];
+	/* Monster is marked as invisible */
+	if (msg->mon_flags & 0x04) r_ptr = NULL;
 
-			/* Get the race name */
-			my_strcpy(race_name, r_ptr->name, sizeof(race_name));
+	/* Special message? */
+	action_only = (*action == '~');
 
-			/* Uniques */
-			if (rf_has(r_ptr->flags, RF_UNIQUE)) {
-				/* Just copy the race name */
-				my_strcpy(buf, (r_ptr->name), sizeof(buf));
-			}
-			/* We have more than one monster */
-			else if (count > 1) {
-				/* Get the plural of the race name */
-				if (r_ptr->plural != NULL) {
-					my_strcpy(race_name, r_ptr->plural, sizeof(race_name));
-				}
-				else {
-					plural_aux(race_name, sizeof(race_name));
-				}
-
-				/* Put the count and the race name together */
-				strnfmt(buf, sizeof(buf), "%d %s", count, race_name);
-			}
-			/* Normal lonely monsters */
-			else {
-				/* Just add a slight flavor */
-				strnfmt(buf, sizeof(buf), "the %s", race_name);
-			}
+	/* Format the proper message for visible monsters */
+	if (r_ptr && !action_only)
+	{
+		/* Uniques */
+		if (rf_has(r_ptr->flags, RF_UNIQUE)) {
+			/* Just copy the race name */
+			n = mon_msg_put(buf, len, n, r_ptr->name);
 		}
-		/* Format the message for non-viewable monsters if necessary */
-		else if (!r_ptr && !action_only) {
-			if (count > 1) {
-				/* Show the counter */
-				strnfmt(buf, sizeof(buf), "%d monsters", count);
+		/* We have more than one monster */
+		else if (count > 1) {
+			/* Put the count and the race name together */
+			n = strnfmt(buf, len, "%d ", count);
+
+			/* Get the plural of the race name */
+			if (r_ptr->plural != NULL) {
+				n = mon_msg_put(buf, n + 80, n, r_ptr->plural);
 			}
 			else {
-				/* Just one non-visible monster */
-				my_strcpy(buf, "it", sizeof(buf));
+				mon_msg_put(buf, n + 80, n, r_ptr->name);
+				plural_aux(buf + n, 80);
+				n += strlen(buf + n);
 			}
 		}
-
-		/* Special message. Nuke the mark */
-		if (action_only)
-			++action;
-		/* Regular message */
+		/* Normal lonely monsters */
 		else {
-			/* Add special mark. Monster is offscreen */
-			if (mon_msg[i].mon_flags & 0x02) my_strcat(buf, " (offscreen)",
-					sizeof(buf));
-        
-			/* Add the separator */
-			my_strcat(buf, " ", sizeof(buf));
+			/* Just add a slight flavor */
+			n = mon_msg_put(buf, len, n, "the ");
+			n = mon_msg_put(buf, n + 80, n, r_ptr->name);
+		}
+	}
+	/* Format the message for non-viewable monsters if necessary */
+	else if (!r_ptr && !action_only) {
+		if (count > 1) {
+			/* Show the counter */
+			n = strnfmt(buf, len, "%d monsters", count);
 		}
+		else {
+			/* Just one non-visible monster */
+			n = mon_msg_put(buf, len, n, "it");
+		}
+	}
 
-		/* Append the action to the message */
-		my_strcat(buf, action, sizeof(buf));
+	/* Special message. Nuke the mark */
+	if (action_only)
+		n = mon_msg_put(buf, len, n, action + 1);
+	/* Regular message */
+	else {
+		/* Add special mark. Monster is offscreen */
+		if (msg->mon_flags & 0x02)
+			n = mon_msg_put(buf, len, n, " (offscreen)");
+
+		/* Add the separator and the action */
+		n = mon_msg_put(buf, len, n, " ");
+		n = mon_msg_put(buf, len, n, action);
+	}
 
-		/* Capitalize the message */
-		*buf = toupper((unsigned char)*buf);
+	/* Capitalize the message */
+	*buf = toupper((unsigned char)*buf);
+
+	switch (msg->msg_code) {
+		case MON_MSG_FLEE_IN_TERROR:
+			type = MSG_FLEE;
+			break;
+
+		case MON_MSG_MORIA_DEATH:
+		case MON_MSG_DESTROYED:
+		case MON_MSG_DIE:
+		case MON_MSG_SHRIVEL_LIGHT:
+		case MON_MSG_DISENTEGRATES:
+		case MON_MSG_FREEZE_SHATTER:
+		case MON_MSG_DISSOLVE:
+		{
+			/* Assume normal death sound */
+			type = MSG_KILL;
+
+			/* Play a special sound if the monster was unique */
+			if (r_ptr != NULL && rf_has(r_ptr->flags, RF_UNIQUE)) {
+				if (r_ptr->base == lookup_monster_base("Morgoth"))
+					type = MSG_KILL_KING;
+				else
+					type = MSG_KILL_UNIQUE;
+			}
+			break;
+		}
+	}
 
-		switch (mon_msg[i].msg_code) {
-			case MON_MSG_FLEE_IN_TERROR:
-				type = MSG_FLEE;
-				break;
+	/* Keep it until the arena is emptied */
+	mon_msg_pending[mon_msg_pending_num].start = mon_msg_arena_used;
+	mon_msg_pending[mon_msg_pending_num].type = type;
+	mon_msg_pending_num++;
+	mon_msg_arena_used += n + 1;
+}
 
-			case MON_MSG_MORIA_DEATH:
-			case MON_MSG_DESTROYED:
-			case MON_MSG_DIE:
-			case MON_MSG_SHRIVEL_LIGHT:
-			case MON_MSG_DISENTEGRATES:
-			case MON_MSG_FREEZE_SHATTER:
-			case MON_MSG_DISSOLVE:
-			{
-				/* Assume normal death sound */
-				type = MSG_KILL;
-
-				/* Play a special sound if the monster was unique */
-				if (r_ptr != NULL && rf_has(r_ptr->flags, RF_UNIQUE)) {
-					if (r_ptr->base == lookup_monster_base("Morgoth"))
-						type = MSG_KILL_KING;
-					else
-						type = MSG_KILL_UNIQUE;
-				}
-				break;
-			}
+/**
+ * Write out the stacked monster messages matching the delay parameter.
+ * Some messages are delayed so that they show up after everything else.
+ * This is to avoid things like "The snaga dies. The snaga runs in fear!"
+ */
+static void flush_monster_messages(bool delay, byte delay_tag)
+{
+	int i;
 
-		}
+	for (i = 0; i < size_mon_msg; i++) {
+		if (mon_msg[i].delay != delay) continue;
 
-		/* Show the message */
-		msgt(type, "%s", buf);
-   }
+		/* Skip if we are delaying and the tags don't match */
+		if (mon_msg[i].delay && mon_msg[i].delay_tag != delay_tag) continue;
+
+		/* Paranoia */
+		if (mon_msg[i].mon_count < 1) continue;
+
+		mon_msg_write(&mon_msg[i]);
+	}
 }
 
 /**
@@ -498,12 +611,20 @@ static void flush_monster_messages(bool delay, byte delay_tag)
  */
 void flush_all_monster_messages(void)
 {
-	/* Flush regular messages, then delayed messages */
+	/* Write regular messages, then delayed messages, then show them */
 	flush_monster_messages(FALSE, MON_DELAY_TAG_DEFAULT);
 	flush_monster_messages(TRUE, MON_DELAY_TAG_DEFAULT);
 	flush_monster_messages(TRUE, MON_DELAY_TAG_DEATH);
+	mon_msg_emit();
 
 	/* Delete all the stacked messages and history */
 	size_mon_msg = 0;
 	size_mon_hist = 0;
+
+	/* Empty the hash tables, wiping them if the stamp comes round again */
+	if (++mon_msg_stamp == 0) {
+		C_WIPE(mon_msg_table, MON_MSG_HASH_SIZE, struct mon_msg_slot);
+		C_WIPE(mon_hist_table, MON_HIST_HASH_SIZE, struct mon_msg_slot);
+		mon_msg_stamp = 1;
+	}
 }
@@ -679,6 +679,9 @@ for (iteration = 0; iteration < 3; iteration ++) {
 	/* Free power array */
 	FREE(power);
 
+	/* Object power ratings depend on the monster powers */
+	object_power_cache_reset();
+
 	/* Success */
 	return 0;
 }
@@ -95,6 +95,7 @@ enum mon_spell_type {
 /** Macros **/
 #define rsf_has(f, flag)       flag_has_dbg(f, RSF_SIZE, flag, #f, #flag)
 #define rsf_next(f, flag)      flag_next(f, RSF_SIZE, flag)
+#define rsf_count(f)           flag_count(f, RSF_SIZE)
 #define rsf_is_empty(f)        flag_is_empty(f, RSF_SIZE)
 #define rsf_is_full(f)         flag_is_full(f, RSF_SIZE)
 #define rsf_is_inter(f1, f2)   flag_is_inter(f1, f2, RSF_SIZE)
@@ -17,6 +17,7 @@
  */
 
 #include "angband.h"
+#include "monster/mon-list.h"
 #include "monster/mon-msg.h"
 #include "monster/mon-spell.h"
 #include "monster/mon-timed.h"
@@ -201,6 +202,10 @@ static bool mon_set_timed(monster_type *m_ptr, int ef_idx, int timer,
 	else
 		m_ptr->m_timed[ef_idx] = timer;
 
+	/* The monster list counts sleeping monsters */
+	if (ef_idx == MON_TMD_SLEEP && !resisted && !old_timer != !timer)
+		monster_list_notice(m_ptr->midx);
+
 	if (p_ptr->health_who == m_ptr) p_ptr->redraw |= (PR_HEALTH);
 
 	/* Update the visuals, as appropriate. */
@@ -21,7 +21,6 @@
 #include "monster/mon-msg.h"
 #include "monster/mon-spell.h"
 #include "monster/mon-timed.h"
-#include "monster/mon-list.h"
 #include "monster/mon-util.h"
 #include "squelch.h"
 
@@ -329,6 +328,136 @@ void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
 
 
 
+/*
+ * Bits of monster_type.vis_state: everything update_mon() reads
+ */
+#define VIS_CDIS_MASK    0x000000FFL  /* m_ptr->cdis */
+#define VIS_INFRA_SHIFT  8            /* p_ptr->state.see_infra (capped) */
+#define VIS_INFRA_MASK   0x0000FF00L
+#define VIS_GRID_VIEW    0x00010000L  /* CAVE_VIEW on the monster's grid */
+#define VIS_GRID_SEEN    0x00020000L  /* CAVE_SEEN on the monster's grid */
+#define VIS_MARK         0x00040000L  /* MFLAG_MARK (detected) */
+#define VIS_TELEPATHY    0x00080000L  /* Player has telepathy */
+#define VIS_SEE_INVIS    0x00100000L  /* Player sees invisible */
+#define VIS_BLIND        0x00200000L  /* Player is blind */
+#define VIS_MIMIC        0x00400000L  /* Monster is mimicking */
+#define VIS_MIMIC_HIDDEN 0x00800000L  /* Its mimicked object is squelched */
+#define VIS_MIMIC_OBJ    0x01000000L  /* It has a mimicked object at all */
+#define VIS_WEIRD_SEEN   0x02000000L  /* Its index lets a weird mind be felt */
+#define VIS_ML           0x04000000L  /* m_ptr->ml */
+#define VIS_VIEW         0x08000000L  /* MFLAG_VIEW */
+#define VIS_VALID        0x80000000L  /* Set once update_mon() has run */
+
+/* Maximum number of visibility handlers */
+#define MAX_VIS_HANDLERS 4
+
+/* Handlers told about visibility changes */
+static monster_vis_handler *vis_handlers[MAX_VIS_HANDLERS];
+
+/**
+ * Register a function to be told what update_mon() finds.  Handlers are
+ * called once per look at a monster, with MON_VIS_LOOKED always set.
+ */
+void monster_vis_add_handler(monster_vis_handler *fn)
+{
+	int i;
+
+	for (i = 0; i < MAX_VIS_HANDLERS; i++) {
+		if (vis_handlers[i] == fn) return;
+		if (!vis_handlers[i]) {
+			vis_handlers[i] = fn;
+			return;
+		}
+	}
+
+	assert(0);
+}
+
+/**
+ * Unregister a function added with monster_vis_add_handler().
+ */
+void monster_vis_remove_handler(monster_vis_handler *fn)
+{
+	int i;
+
+	for (i = 0; i < MAX_VIS_HANDLERS; i++) {
+		if (vis_handlers[i] != fn) continue;
+
+		for (; i + 1 < MAX_VIS_HANDLERS; i++)
+			vis_handlers[i] = vis_handlers[i + 1];
+		vis_handlers[i] = NULL;
+		return;
+	}
+}
+
+/**
+ * The player's part of a monster's visibility state.
+ */
+static u32b monster_vis_player_state(void)
+{
+	u32b state = 0;
+	int infra = p_ptr->state.see_infra;
+
+	if (infra > 255) infra = 255;
+	if (infra < 0) infra = 0;
+	state |= ((u32b)infra << VIS_INFRA_SHIFT) & VIS_INFRA_MASK;
+
+	if (check_state(p_ptr, OF_TELEPATHY, p_ptr->state.flags))
+		state |= VIS_TELEPATHY;
+	if (check_state(p_ptr, OF_SEE_INVIS, p_ptr->state.flags))
+		state |= VIS_SEE_INVIS;
+	if (p_ptr->timed[TMD_BLIND])
+		state |= VIS_BLIND;
+
+	return state;
+}
+
+/**
+ * Everything update_mon() works from for the given monster, combined
+ * with the player's part from monster_vis_player_state().
+ */
+static u32b monster_vis_state(struct monster *m_ptr, u32b player)
+{
+	u32b state = player | VIS_VALID;
+	int fy = m_ptr->fy;
+	int fx = m_ptr->fx;
+
+	state |= m_ptr->cdis & VIS_CDIS_MASK;
+
+	if (player_has_los_bold(fy, fx)) state |= VIS_GRID_VIEW;
+	if (player_can_see_bold(fy, fx)) state |= VIS_GRID_SEEN;
+	if (m_ptr->mflag & (MFLAG_MARK)) state |= VIS_MARK;
+	if (m_ptr->mflag & (MFLAG_VIEW)) state |= VIS_VIEW;
+	if (m_ptr->ml) state |= VIS_ML;
+	if ((m_ptr->midx % 10) == 5) state |= VIS_WEIRD_SEEN;
+
+	if (m_ptr->mimicked_o_idx) {
+		state |= VIS_MIMIC_OBJ;
+		if (squelch_item_ok(object_byid(m_ptr->mimicked_o_idx)))
+			state |= VIS_MIMIC_HIDDEN;
+	}
+	if (is_mimicking(m_ptr)) state |= VIS_MIMIC;
+
+	return state;
+}
+
+/**
+ * Disturb the player when a monster comes into or leaves plain view.
+ */
+static void monster_vis_disturb(struct monster *m_ptr, int changes)
+{
+	if (!OPT(disturb_near)) return;
+
+	/* Disturb on appearance */
+	if (changes & MON_VIS_IN_VIEW)
+		disturb(p_ptr, 1, 0);
+
+	/* Disturb on disappearance */
+	else if ((changes & MON_VIS_OUT_OF_VIEW) && !is_mimicking(m_ptr))
+		disturb(p_ptr, 1, 0);
+}
+
+
 /**
  * This function updates the monster record of the given monster
  *
@@ -386,6 +515,11 @@ void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
  * The player can choose to be disturbed by several things, including
  * "OPT(disturb_near)" (monster which is "easily" viewable moves in some
  * way).  Note that "moves" includes "appears" and "disappears".
+ *
+ * Whatever changed is passed on to the handlers registered with
+ * monster_vis_add_handler(), and what the answer was worked out from is
+ * kept in "vis_state" so that update_monsters() can skip the monster
+ * until something it depends on changes.
  */
 void update_mon(struct monster *m_ptr, bool full)
 {
@@ -402,6 +536,11 @@ void update_mon(struct monster *m_ptr, bool full)
 	/* Seen by vision */
 	bool easy = FALSE;
 
+	/* What changed (MON_VIS_*) */
+	int changes = MON_VIS_LOOKED;
+
+	int i;
+
 	assert(m_ptr != NULL);
 
 	l_ptr = get_lore(m_ptr->race);
@@ -545,6 +684,8 @@ void update_mon(struct monster *m_ptr, bool full)
 
 			/* Window stuff */
 			p_ptr->redraw |= PR_MONLIST;
+
+			changes |= MON_VIS_APPEARED;
 		}
 	}
 
@@ -567,6 +708,8 @@ void update_mon(struct monster *m_ptr, bool full)
 
 				/* Window stuff */
 				p_ptr->redraw |= PR_MONLIST;
+
+				changes |= MON_VIS_VANISHED;
 			}
 		}
 	}
@@ -579,11 +722,10 @@ void update_mon(struct monster *m_ptr, bool full)
 			/* Mark as easily visible */
 			m_ptr->mflag |= (MFLAG_VIEW);
 
-			/* Disturb on appearance */
-			if (OPT(disturb_near)) disturb(p_ptr, 1, 0);
-
 			/* Re-draw monster window */
 			p_ptr->redraw |= PR_MONLIST;
+
+			changes |= MON_VIS_IN_VIEW;
 		}
 	}
 
@@ -594,13 +736,22 @@ void update_mon(struct monster *m_ptr, bool full)
 			/* Mark as not easily visible */
 			m_ptr->mflag &= ~(MFLAG_VIEW);
 
-			/* Disturb on disappearance */
-			if (OPT(disturb_near) && !is_mimicking(m_ptr)) disturb(p_ptr, 1, 0);
-
 			/* Re-draw monster list window */
 			p_ptr->redraw |= PR_MONLIST;
+
+			changes |= MON_VIS_OUT_OF_VIEW;
 		}
 	}
+
+	/* Remember what this was worked out from */
+	m_ptr->vis_state = monster_vis_state(m_ptr, monster_vis_player_state());
+	m_ptr->vis_fy = fy;
+	m_ptr->vis_fx = fx;
+
+	/* Disturb first, then tell anyone else who is listening */
+	monster_vis_disturb(m_ptr, changes);
+	for (i = 0; i < MAX_VIS_HANDLERS && vis_handlers[i]; i++)
+		vis_handlers[i](m_ptr, changes);
 }
 
 
@@ -608,18 +759,31 @@ void update_mon(struct monster *m_ptr, bool full)
 
 /**
  * Updates all the (non-dead) monsters via update_mon().
+ *
+ * When distances are not being recomputed, a monster is only looked at
+ * again if it has moved, or if its grid's view and light, its own
+ * detection or mimicry, or the player's senses have changed since it
+ * was last looked at.
  */
 void update_monsters(bool full)
 {
 	int i;
+	u32b player = monster_vis_player_state();
 
 	/* Update each (live) monster */
 	for (i = 1; i < cave_monster_max(cave); i++) {
 		monster_type *m_ptr = cave_monster(cave, i);
 
-		/* Update the monster if alive */
-		if (m_ptr->race)
-			update_mon(m_ptr, full);
+		/* Skip dead monsters */
+		if (!m_ptr->race) continue;
+
+		/* Skip monsters nothing has changed for */
+		if (!full && m_ptr->vis_fy == m_ptr->fy &&
+				m_ptr->vis_fx == m_ptr->fx &&
+				m_ptr->vis_state == monster_vis_state(m_ptr, player))
+			continue;
+
+		update_mon(m_ptr, full);
 	}
 }
 
@@ -706,6 +870,8 @@ void monster_swap(int y1, int x1, int y2, int x2)
 	/* Update grids */
 	cave->m_idx[y1][x1] = m2;
 	cave->m_idx[y2][x2] = m1;
+	cave_empty_update(cave, y1, x1);
+	cave_empty_update(cave, y2, x2);
 
 	/* Monster 1 */
 	if (m1 > 0) {
@@ -39,10 +39,24 @@
 #define MDESC_STANDARD  (MDESC_CAPITAL | MDESC_IND_HID | MDESC_PRO_HID) /* "someone", "something", or "the kobold" at the start of a message */
 #define MDESC_DIED_FROM (MDESC_SHOW | MDESC_IND_VIS) /* Reveal the full, indefinite name of a monster */
 
+/*
+ * Changes update_mon() reports to monster visibility handlers
+ */
+#define MON_VIS_LOOKED      0x01    /* The monster was looked at again */
+#define MON_VIS_APPEARED    0x02    /* It became visible */
+#define MON_VIS_VANISHED    0x04    /* It stopped being visible */
+#define MON_VIS_IN_VIEW     0x08    /* It became easily visible */
+#define MON_VIS_OUT_OF_VIEW 0x10    /* It stopped being easily visible */
+
 /** Macros **/
 
 /** Structures **/
 
+/*
+ * Called by update_mon() with the MON_VIS_* changes it found
+ */
+typedef void monster_vis_handler(struct monster *m, int changes);
+
 /** Variables **/
 extern wchar_t summon_kin_type;		/* Hack -- See summon_specific() */
 
@@ -56,6 +70,8 @@ void plural_aux(char *name, size_t max);
 void monster_desc(char *desc, size_t max, const monster_type *m_ptr, int mode);
 void update_mon(struct monster *m_ptr, bool full);
 void update_monsters(bool full);
+void monster_vis_add_handler(monster_vis_handler *fn);
+void monster_vis_remove_handler(monster_vis_handler *fn);
 s16b monster_carry(struct monster *m, object_type *j_ptr);
 void monster_swap(int y1, int x1, int y2, int x2);
 int summon_specific(int y1, int x1, int lev, int type, int delay);
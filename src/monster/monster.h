@@ -280,6 +280,10 @@ typedef struct monster
 
 	byte attr;  		/* attr last used for drawing monster */
 
+	u32b vis_state;		/* What update_mon() last worked from, or 0 */
+	byte vis_fy;		/* Where update_mon() last saw it */
+	byte vis_fx;
+
 	u32b smart;			/* Field for "adult_ai_learn" */
 
 	bitflag known_pflags[OF_SIZE]; /* Known player flags */
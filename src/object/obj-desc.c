@@ -22,6 +22,110 @@
 #include "object/pval.h"
 
 
+/*
+ * Number of descriptions remembered by object_desc()
+ */
+#define DESC_CACHE_SIZE 256
+
+/*
+ * Longest description that is remembered
+ */
+#define DESC_CACHE_LEN 120
+
+/*
+ * A remembered description, and everything it was made from: the object
+ * itself, the mode, and what the player knew about its kind.  Anything
+ * else it depends on (flavor and artifact names, squelch levels) bumps
+ * desc_stamp when it changes.
+ */
+struct desc_cache_entry
+{
+	const object_type *o_ptr;	/* Where the object was */
+	object_type copy;		/* What it was */
+	int mode;
+	u32b stamp;			/* desc_stamp when it was made */
+
+	bool aware;			/* kind->aware */
+	bool tried;			/* kind->tried */
+	byte squelch;			/* kind->squelch */
+	bool show_flavors;		/* OPT(show_flavors) */
+	bool unignoring;		/* p_ptr->unignoring */
+
+	size_t len;
+	char text[DESC_CACHE_LEN];
+};
+
+static struct desc_cache_entry desc_cache[DESC_CACHE_SIZE];
+
+/* Generation of remembered descriptions; zero is never current */
+static u32b desc_stamp = 1;
+
+/* The squelch levels that were in force for desc_stamp */
+static byte desc_squelch_level[TYPE_MAX];
+
+
+/**
+ * Forget every remembered description.
+ */
+void object_desc_invalidate(void)
+{
+	desc_stamp++;
+}
+
+/*
+ * Find the cache slot for an object and mode.
+ */
+static struct desc_cache_entry *desc_cache_slot(const object_type *o_ptr,
+		int mode)
+{
+	size_t hash = (size_t)o_ptr / sizeof(object_type) + (size_t)mode * 7;
+
+	return &desc_cache[hash % DESC_CACHE_SIZE];
+}
+
+/*
+ * Whether a cache slot holds the description of an object in a mode.
+ */
+static bool desc_cache_matches(const struct desc_cache_entry *entry,
+		const object_type *o_ptr, int mode)
+{
+	return entry->o_ptr == o_ptr &&
+			entry->mode == mode &&
+			entry->stamp == desc_stamp &&
+			entry->aware == o_ptr->kind->aware &&
+			entry->tried == o_ptr->kind->tried &&
+			entry->squelch == o_ptr->kind->squelch &&
+			entry->show_flavors == OPT(show_flavors) &&
+			entry->unignoring == p_ptr->unignoring &&
+			!memcmp(&entry->copy, o_ptr, sizeof(object_type));
+}
+
+/*
+ * Remember the description of an object in a mode.
+ */
+static void desc_cache_store(struct desc_cache_entry *entry,
+		const object_type *o_ptr, int mode, const char *buf, size_t len)
+{
+	/* Too long to keep */
+	if (len >= DESC_CACHE_LEN) {
+		entry->o_ptr = NULL;
+		return;
+	}
+
+	entry->o_ptr = o_ptr;
+	COPY(&entry->copy, o_ptr, object_type);
+	entry->mode = mode;
+	entry->stamp = desc_stamp;
+	entry->aware = o_ptr->kind->aware;
+	entry->tried = o_ptr->kind->tried;
+	entry->squelch = o_ptr->kind->squelch;
+	entry->show_flavors = OPT(show_flavors);
+	entry->unignoring = p_ptr->unignoring;
+	entry->len = len;
+	memcpy(entry->text, buf, len + 1);
+}
+
+
 /**
  * Puts the object base kind's name into buf.
  */
@@ -321,9 +425,6 @@ static size_t obj_desc_name(char *buf, size_t max, size_t end,
 	const char *basename = obj_desc_get_basename(o_ptr, aware, terse);
 	const char *modstr = obj_desc_get_modstr(o_ptr->kind);
 
-	if (aware && !o_ptr->kind->everseen && !spoil)
-		o_ptr->kind->everseen = TRUE;
-
 	if (prefix)
 		end = obj_desc_name_prefix(buf, max, end, o_ptr, known,
 				basename, modstr, terse);
@@ -669,6 +770,10 @@ static size_t obj_desc_aware(const object_type *o_ptr, char *buf, size_t max,
  * Setting 'prefix' to TRUE prepends a 'the', 'a' or the number in the stack,
  * respectively.
  *
+ * Descriptions are remembered by object and mode, and reused for as long
+ * as the object, what the player knows about its kind and the squelch
+ * settings stay the same.
+ *
  * \returns The number of bytes used of the buffer.
  */
 size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
@@ -676,7 +781,8 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
 	bool prefix = mode & ODESC_PREFIX;
 	bool spoil = mode & ODESC_SPOIL;
 	bool terse = mode & ODESC_TERSE;
-	bool known;
+	bool known, aware;
+	struct desc_cache_entry *entry;
 
 	size_t end = 0, i = 0;
 
@@ -704,6 +810,23 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
 				o_ptr->pval[DEFAULT_PVAL], o_ptr->kind->name,
 				squelch_item_ok(o_ptr) ? " {squelch}" : "");
 
+	/* We've seen the kind now we're aware of it */
+	aware = object_flavor_is_aware(o_ptr) || (o_ptr->ident & IDENT_STORE);
+	if (aware && !spoil) o_ptr->kind->everseen = TRUE;
+
+	/* Squelch levels are not part of the key, so watch for changes */
+	if (memcmp(desc_squelch_level, squelch_level, sizeof(desc_squelch_level))) {
+		memcpy(desc_squelch_level, squelch_level, sizeof(desc_squelch_level));
+		object_desc_invalidate();
+	}
+
+	/* Reuse the last description if nothing has changed */
+	entry = desc_cache_slot(o_ptr, mode);
+	if (desc_cache_matches(entry, o_ptr, mode) && entry->len < max) {
+		memcpy(buf, entry->text, entry->len + 1);
+		return entry->len;
+	}
+
 	/** Construct the name **/
 
 	/* Copy the base name to the buffer */
@@ -735,5 +858,9 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
 			end = obj_desc_inscrip(o_ptr, buf, max, end);
 	}
 
+	/* Keep it unless it was cut short */
+	if (end + 1 < max)
+		desc_cache_store(entry, o_ptr, mode, buf, end);
+
 	return end;
 }
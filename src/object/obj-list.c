@@ -26,8 +26,34 @@ typedef struct object_list_entry_s {
 	object_type *object;
 	u16b count;
 	s16b dx, dy;
+
+	s16b next;		/* Next entry for the same kind, or next free entry */
+	s16b kidx;		/* Kind of the objects counted */
+	u16b members;		/* Number of objects counted */
+	bool unknown;		/* Made for an unknown object, so nothing else joins */
+	bool name_valid;
+	char name[80];		/* Cached description of the entry */
 } object_list_entry_t;
 
+/**
+ * What the list last saw in one object slot, and what the object there adds
+ * to the list. Comparing the slot against the copy is how the list notices
+ * objects being created, deleted, seen, moved or learnt about.
+ */
+typedef struct object_list_ref_s {
+	object_type copy;
+	byte state;		/* OBJECT_LIST_STATE_* bits for the copy */
+	s16b entry;		/* Entry the object is counted in, or -1 */
+	u16b count;		/* What it adds to that entry's count */
+	bool pending;		/* Queued for an update */
+	bool retry;		/* There was no free entry for it last time */
+} object_list_ref_t;
+
+/* Things about an object that aren't stored in the object itself */
+#define OBJECT_LIST_STATE_AWARE		0x01
+#define OBJECT_LIST_STATE_TRIED		0x02
+#define OBJECT_LIST_STATE_SQUELCHED	0x04
+
 typedef struct object_list_s {
 	object_list_entry_t *entries;
 	size_t entries_size;
@@ -35,6 +61,15 @@ typedef struct object_list_s {
 	u16b total_entries;
 	u16b total_objects;
 	bool sorted;
+
+	s16b *order;		/* Entries in display order */
+	s16b *kind_entry;	/* First entry for each kind, or -1 */
+	s16b free_entry;
+	object_list_ref_t *refs;
+	s16b *pending;
+	size_t refs_size;
+	bool lost_object;	/* Some entry has to find a new object to show */
+	s16b player_y, player_x;
 } object_list_t;
 
 /**
@@ -44,6 +79,7 @@ static object_list_t *object_list_new(void)
 {
 	object_list_t *list = ZNEW(object_list_t);
 	size_t size = MAX_ITEMLIST;
+	size_t i;
 
 	if (list == NULL)
 		return NULL;
@@ -56,6 +92,25 @@ static object_list_t *object_list_new(void)
 	}
 
 	list->entries_size = size;
+	list->order = C_ZNEW(size, s16b);
+	list->kind_entry = C_ZNEW(z_info->k_max, s16b);
+	list->refs_size = z_info->o_max;
+	list->refs = C_ZNEW(list->refs_size, object_list_ref_t);
+	list->pending = C_ZNEW(list->refs_size, s16b);
+
+	/* Chain all the entries into the free list */
+	for (i = 0; i < size; i++)
+		list->entries[i].next = (i + 1 < size) ? (s16b)(i + 1) : -1;
+
+	for (i = 0; i < z_info->k_max; i++)
+		list->kind_entry[i] = -1;
+
+	for (i = 0; i < list->refs_size; i++)
+		list->refs[i].entry = -1;
+
+	list->free_entry = 0;
+	list->player_y = -1;
+	list->player_x = -1;
 
 	return list;
 }
@@ -68,13 +123,12 @@ static void object_list_free(object_list_t *list)
 	if (list == NULL)
 		return;
 
-	if (list->entries != NULL) {
-		FREE(list->entries);
-		list->entries = NULL;
-	}
-
+	FREE(list->entries);
+	FREE(list->order);
+	FREE(list->kind_entry);
+	FREE(list->refs);
+	FREE(list->pending);
 	FREE(list);
-	list = NULL;
 }
 
 /**
@@ -96,6 +150,7 @@ void object_list_init(void)
 void object_list_finalize(void)
 {
 	object_list_free(object_list_subwindow);
+	object_list_subwindow = NULL;
 }
 
 /**
@@ -111,130 +166,279 @@ static object_list_t *object_list_shared_instance(void)
 }
 
 /**
- * Return TRUE if the list needs to be updated. Usually this is each turn.
+ * Return TRUE if the object should be omitted from the object list.
  */
-static bool object_list_needs_update(const object_list_t *list)
+static bool object_list_should_ignore_object(const object_type *object)
 {
-	if (list == NULL || list->entries == NULL)
-		return FALSE;
+	if (object->kind == NULL)
+		return TRUE;
 
-	/* For now, always update when requested. */
-	return TRUE;
+	if (!object->marked)
+		return TRUE;
+
+	if (!is_unknown(object) && squelch_item_ok(object))
+		return TRUE;
+
+	if (object->tval == TV_GOLD)
+		return TRUE;
+
+	return FALSE;
 }
 
 /**
- * Zero out the contents of an object list.
+ * Return the OBJECT_LIST_STATE_* bits for an object.
  */
-static void object_list_reset(object_list_t *list)
+static byte object_list_object_state(const object_type *object)
 {
-	if (list == NULL || list->entries == NULL)
+	byte state = 0;
+
+	if (object->kind == NULL)
+		return 0;
+
+	if (object->kind->aware)
+		state |= OBJECT_LIST_STATE_AWARE;
+
+	if (object->kind->tried)
+		state |= OBJECT_LIST_STATE_TRIED;
+
+	if (object->marked && object->tval != TV_GOLD && squelch_item_ok(object))
+		state |= OBJECT_LIST_STATE_SQUELCHED;
+
+	return state;
+}
+
+/**
+ * Queue an object slot to be brought up to date.
+ */
+static void object_list_queue(object_list_t *list, size_t *num, int item)
+{
+	if (item <= 0 || item >= (int)list->refs_size || list->refs[item].pending)
 		return;
 
-	if (!object_list_needs_update(list))
+	list->refs[item].pending = TRUE;
+	list->pending[(*num)++] = item;
+}
+
+/**
+ * Queue every object on a grid. Whether an object shows as unknown depends
+ * on the rest of the pile, so a change anywhere on a grid affects it all.
+ */
+static void object_list_queue_grid(object_list_t *list, size_t *num, int y, int x)
+{
+	s16b item;
+
+	if (!cave_in_bounds(cave, y, x))
+		return;
+
+	for (item = cave->o_idx[y][x]; item; item = object_byid(item)->next_o_idx)
+		object_list_queue(list, num, item);
+}
+
+/**
+ * Take an object out of the entry it is counted in.
+ */
+static void object_list_remove_object(object_list_t *list, int item)
+{
+	object_list_ref_t *ref = &list->refs[item];
+	object_list_entry_t *entry;
+
+	if (ref->entry < 0)
 		return;
 
-	C_WIPE(list->entries, list->entries_size, object_list_entry_t);
-	list->total_entries = 0;
-	list->total_objects = 0;
-	list->creation_turn = 0;
+	entry = &list->entries[ref->entry];
+	entry->count -= ref->count;
+	entry->members--;
+	entry->name_valid = FALSE;
+	list->total_objects -= ref->count;
+
+	if (entry->members == 0) {
+		s16b *link = &list->kind_entry[entry->kidx];
+
+		/* Unlink it from its kind, and free it */
+		while (*link != ref->entry)
+			link = &list->entries[*link].next;
+
+		*link = entry->next;
+		entry->object = NULL;
+		entry->next = list->free_entry;
+		list->free_entry = ref->entry;
+		list->total_entries--;
+	}
+	else if (entry->object == object_byid(item)) {
+		entry->object = NULL;
+		list->lost_object = TRUE;
+	}
+
+	ref->entry = -1;
+	ref->count = 0;
 	list->sorted = FALSE;
 }
 
 /**
- * Return TRUE if the object should be omitted from the object list.
+ * Count an object in the list, if it belongs there, joining the first entry
+ * of its kind it is similar to or starting a new one. Returns FALSE if it
+ * needed a new entry and there were none left.
  */
-static bool object_list_should_ignore_object(const object_type *object)
+static bool object_list_add_object(object_list_t *list, int item)
 {
-	if (object->kind == NULL)
-		return TRUE;
+	object_type *object = object_byid(item);
+	object_list_ref_t *ref = &list->refs[item];
+	object_list_entry_t *entry = NULL;
+	s16b entry_index;
+	bool unknown;
 
-	if (!object->marked)
+	if (object_list_should_ignore_object(object))
 		return TRUE;
 
-	if (!is_unknown(object) && squelch_item_ok(object))
-		return TRUE;
+	unknown = is_unknown(object);
 
-	if (object->tval == TV_GOLD)
-		return TRUE;
+	if (!unknown) {
+		for (entry_index = list->kind_entry[object->kind->kidx]; entry_index >= 0; entry_index = list->entries[entry_index].next) {
+			object_list_entry_t *candidate = &list->entries[entry_index];
 
-	return FALSE;
+			if (!candidate->unknown && candidate->object != NULL && object_similar(object, candidate->object, OSTACK_LIST)) {
+				entry = candidate;
+				break;
+			}
+		}
+	}
+
+	if (entry == NULL) {
+		entry_index = list->free_entry;
+
+		if (entry_index < 0)
+			return FALSE;
+
+		entry = &list->entries[entry_index];
+		list->free_entry = entry->next;
+
+		entry->object = object;
+		entry->count = 0;
+		entry->members = 0;
+		entry->kidx = object->kind->kidx;
+		entry->unknown = unknown;
+		entry->next = list->kind_entry[entry->kidx];
+		list->kind_entry[entry->kidx] = entry_index;
+		list->total_entries++;
+	}
+
+	/* We only know the number of objects if we've actually seen them. */
+	ref->count = (object->marked == MARK_SEEN) ? object->number : 1;
+	ref->entry = entry - list->entries;
+
+	entry->count += ref->count;
+	entry->members++;
+	entry->name_valid = FALSE;
+	list->total_objects += ref->count;
+	list->sorted = FALSE;
+
+	return TRUE;
 }
 
 /**
  * Collect object information from the current cave.
+ *
+ * Only object slots that differ from what the list last saw, and the other
+ * objects on their grids, are looked at again; everything else keeps its
+ * place in the list.
  */
 static void object_list_collect(object_list_t *list)
 {
+	size_t num = 0;
+	size_t i;
 	int item;
-	int i;
 
 	if (list == NULL || list->entries == NULL)
 		return;
 
-	if (!object_list_needs_update(list))
-		return;
-
-	/* Scan each object in the dungeon. */
-	for (item = 0; item < z_info->o_max; item++) {
+	/* Find the slots that have changed */
+	for (item = 1; item < (int)list->refs_size; item++) {
 		object_type *object = object_byid(item);
-		object_list_entry_t *entry = NULL;
-		int entry_index;
-		int current_distance;
-		int entry_distance;
+		object_list_ref_t *ref = &list->refs[item];
 
-		if (object_list_should_ignore_object(object))
+		if (object->kind == NULL && ref->copy.kind == NULL)
 			continue;
 
-		/* Find or add a list entry. */
-		for (entry_index = 0; entry_index < (int)list->entries_size; entry_index++) {
-			if (list->entries[entry_index].object == NULL) {
-				/* We found an empty slot, so add this object here. */
-				list->entries[entry_index].object = object;
-				list->entries[entry_index].count = 0;
-				list->entries[entry_index].dy = object->iy - p_ptr->py;
-				list->entries[entry_index].dx = object->ix - p_ptr->px;
-				entry = &list->entries[entry_index];
-				break;
-			}
-			else if (!is_unknown(object) && object_similar(object, list->entries[entry_index].object, OSTACK_LIST)) {
-				/* We found a matching object and we'll use that. */
-				entry = &list->entries[entry_index];
-				break;
-			}
-		}
+		if (!ref->retry && memcmp(&ref->copy, object, sizeof(*object)) == 0 && ref->state == object_list_object_state(object))
+			continue;
 
-		if (entry == NULL)
-			return;
+		object_list_queue(list, &num, item);
 
-		/* We only know the number of objects if we've actually seen them. */
-		if (object->marked == MARK_SEEN)
-			entry->count += object->number;
-		else
-			entry->count = 1;
+		/* Everything on the grids it has been on */
+		if (ref->copy.kind != NULL && !ref->copy.held_m_idx)
+			object_list_queue_grid(list, &num, ref->copy.iy, ref->copy.ix);
 
-		/* Store the distance to the object in the stack that is closest to the player. */
-		current_distance = (object->iy - p_ptr->py) * (object->iy - p_ptr->py) + (object->ix - p_ptr->px) * (object->ix - p_ptr->px);
-		entry_distance = entry->dy * entry->dy + entry->dx * entry->dx;
+		if (object->kind != NULL && !object->held_m_idx)
+			object_list_queue_grid(list, &num, object->iy, object->ix);
+	}
 
-		if (current_distance < entry_distance) {
-			entry->dy = object->iy - p_ptr->py;
-			entry->dx = object->ix - p_ptr->px;
+	/* Bring them up to date */
+	for (i = 0; i < num; i++)
+		object_list_remove_object(list, list->pending[i]);
+
+	/* Give entries that lost the object they showed another one */
+	if (list->lost_object) {
+		for (item = 1; item < (int)list->refs_size; item++) {
+			object_list_ref_t *ref = &list->refs[item];
+
+			if (ref->entry >= 0 && list->entries[ref->entry].object == NULL)
+				list->entries[ref->entry].object = object_byid(item);
 		}
+
+		list->lost_object = FALSE;
 	}
 
-	/* Collect totals for easier calculations of the list. */
-	for (i = 0; i < (int)list->entries_size; i++) {
+	for (i = 0; i < num; i++) {
+		object_list_ref_t *ref = &list->refs[list->pending[i]];
+		object_type *object = object_byid(list->pending[i]);
+
+		ref->retry = !object_list_add_object(list, list->pending[i]);
+		COPY(&ref->copy, object, object_type);
+		ref->state = object_list_object_state(object);
+		ref->pending = FALSE;
+	}
+
+	/* Distances change whenever the player moves */
+	if (list->player_y != p_ptr->py || list->player_x != p_ptr->px) {
+		list->player_y = p_ptr->py;
+		list->player_x = p_ptr->px;
+		list->sorted = FALSE;
+	}
+
+	if (list->sorted)
+		return;
+
+	/* Store the distance to the object in the stack that is closest to the player. */
+	for (i = 0; i < list->entries_size; i++) {
 		if (list->entries[i].object == NULL)
 			continue;
 
-		if (list->entries[i].count > 0)
-			list->total_entries++;
+		list->entries[i].dy = MAX_SHORT;
+		list->entries[i].dx = MAX_SHORT;
+	}
 
-		list->total_objects += list->entries[i].count;
+	for (item = 1; item < (int)list->refs_size; item++) {
+		object_list_ref_t *ref = &list->refs[item];
+		object_list_entry_t *entry;
+		object_type *object;
+		int current_distance;
+		int entry_distance;
+
+		if (ref->entry < 0)
+			continue;
+
+		entry = &list->entries[ref->entry];
+		object = object_byid(item);
+		current_distance = (object->iy - p_ptr->py) * (object->iy - p_ptr->py) + (object->ix - p_ptr->px) * (object->ix - p_ptr->px);
+		entry_distance = (entry->dy == MAX_SHORT) ? -1 : entry->dy * entry->dy + entry->dx * entry->dx;
+
+		if (entry_distance < 0 || current_distance < entry_distance) {
+			entry->dy = object->iy - p_ptr->py;
+			entry->dx = object->ix - p_ptr->px;
+		}
 	}
 
 	list->creation_turn = turn;
-	list->sorted = FALSE;
 }
 
 /**
@@ -278,11 +482,28 @@ static int object_list_standard_compare(const void *a, const void *b)
 }
 
 /**
- * Sort the object list with the given sort function.
+ * The list and entry comparator object_list_sort() is sorting with.
+ */
+static const object_list_t *object_list_sorting;
+static int (*object_list_sorting_compare)(const void *, const void *);
+
+static int object_list_order_compare(const void *a, const void *b)
+{
+	const object_list_entry_t *ae = &object_list_sorting->entries[*(const s16b *)a];
+	const object_list_entry_t *be = &object_list_sorting->entries[*(const s16b *)b];
+
+	return object_list_sorting_compare(ae, be);
+}
+
+/**
+ * Sort the object list with the given sort function. The entries stay
+ * where they are; only the display order is sorted, and only when the
+ * entries or the player's position have changed.
  */
 static void object_list_sort(object_list_t *list, int (*compare)(const void *, const void *))
 {
-	size_t elements;
+	size_t elements = 0;
+	size_t i;
 
 	if (list == NULL || list->entries == NULL)
 		return;
@@ -290,15 +511,26 @@ static void object_list_sort(object_list_t *list, int (*compare)(const void *, c
 	if (list->sorted)
 		return;
 
-	elements = list->total_entries;
+	for (i = 0; i < list->entries_size; i++)
+		if (list->entries[i].object != NULL)
+			list->order[elements++] = i;
 
-	if (elements <= 1)
-		return;
+	object_list_sorting = list;
+	object_list_sorting_compare = compare;
+	sort(list->order, elements, sizeof(list->order[0]), object_list_order_compare);
+	object_list_sorting = NULL;
 
-	sort(list->entries, elements, sizeof(list->entries[0]), compare);
 	list->sorted = TRUE;
 }
 
+/**
+ * Return the entry shown at a given position in the list.
+ */
+static object_list_entry_t *object_list_entry_at(const object_list_t *list, int position)
+{
+	return &list->entries[list->order[position]];
+}
+
 /**
  * Return an attribute to display a particular list entry with.
  *
@@ -312,7 +544,7 @@ static byte object_list_entry_line_attribute(const object_list_entry_t *entry)
 	if (entry == NULL || entry->object == NULL || entry->object->kind == NULL)
 		return TERM_WHITE;
 
-	if (is_unknown(entry->object))
+	if (entry->unknown)
 	/* unknown object */
 		attr = TERM_RED;
 	else if (entry->object->artifact && object_is_known(entry->object))
@@ -343,7 +575,7 @@ static byte object_list_entry_line_attribute(const object_list_entry_t *entry)
  * \param size is the size of line_buffer.
  * \param full_width is the maximum formatted width allowed.
  */
-static void object_list_format_name(const object_list_entry_t *entry, char *line_buffer, size_t size, size_t full_width)
+static void object_list_format_name(object_list_entry_t *entry, char *line_buffer, size_t size, size_t full_width)
 {
 	char name[80];
 	const char *chunk;
@@ -379,11 +611,19 @@ static void object_list_format_name(const object_list_entry_t *entry, char *line
 	 * Because each entry points to a specific object and not something more general, the
 	 * number of similar objects we counted has to be swapped in. This isn't an ideal way
 	 * to do this, but it's the easiest way until object_desc is more flexible.
+	 *
+	 * The description is kept until the entry changes, which covers anything the player
+	 * learns about its objects, since that changes the objects themselves.
 	 */
-	old_number = entry->object->number;
-	entry->object->number = entry->count;
-	object_desc(name, sizeof(name), entry->object, ODESC_PREFIX | ODESC_FULL);
-	entry->object->number = old_number;
+	if (!entry->name_valid) {
+		old_number = entry->object->number;
+		entry->object->number = entry->count;
+		object_desc(entry->name, sizeof(entry->name), entry->object, ODESC_PREFIX | ODESC_FULL);
+		entry->object->number = old_number;
+		entry->name_valid = TRUE;
+	}
+
+	my_strcpy(name, entry->name, sizeof(name));
 
 	/* The source string for strtok() needs to be set properly, depending on when we use it. */
 	if (!has_singular_prefix && entry->count == 1) {
@@ -454,25 +694,26 @@ static void object_list_format_section(const object_list_t *list, textblock *tb,
 		textblock_append(tb, "%s", line_buffer);
 
 	for (entry_index = 0; entry_index < total && line_count < lines_to_display; entry_index++) {
+		object_list_entry_t *entry = object_list_entry_at(list, entry_index);
 		char location[20] = { '\0' };
 		byte line_attr;
 		size_t full_width;
-		const char *direction_y = (list->entries[entry_index].dy <= 0) ? "N" : "S";
-		const char *direction_x = (list->entries[entry_index].dx <= 0) ? "W" : "E";
+		const char *direction_y = (entry->dy <= 0) ? "N" : "S";
+		const char *direction_x = (entry->dx <= 0) ? "W" : "E";
 
 		line_buffer[0] = '\0';
 
-		if (list->entries[entry_index].count == 0)
+		if (entry->count == 0)
 			continue;
 
 		/* Build the location string. */
-		strnfmt(location, sizeof(location), " %d %s %d %s", abs(list->entries[entry_index].dy), direction_y, abs(list->entries[entry_index].dx), direction_x);
+		strnfmt(location, sizeof(location), " %d %s %d %s", abs(entry->dy), direction_y, abs(entry->dx), direction_x);
 
 		/* Get width available for object name: 2 for char and space; location includes padding; last -1 for some reason? */
 		full_width = max_width - 2 - strlen(location) - 1;
 
 		/* Add the object count and clip the object name to fit. */
-		object_list_format_name(&list->entries[entry_index], line_buffer, sizeof(line_buffer), full_width);
+		object_list_format_name(entry, line_buffer, sizeof(line_buffer), full_width);
 
 		/* Calculate the width of the line for dynamic sizing; use a fixed max width for location and object char. */
 		max_line_length = MAX(max_line_length, strlen(line_buffer) + 12 + 2);
@@ -482,9 +723,9 @@ static void object_list_format_section(const object_list_t *list, textblock *tb,
 			byte a = TERM_RED;
 			wchar_t c = L'*';
 
-			if (!is_unknown(list->entries[entry_index].object) && list->entries[entry_index].object->kind != NULL) {
-				a = object_kind_attr(list->entries[entry_index].object->kind);
-				c = object_kind_char(list->entries[entry_index].object->kind);
+			if (!entry->unknown && entry->object->kind != NULL) {
+				a = object_kind_attr(entry->object->kind);
+				c = object_kind_char(entry->object->kind);
 			}
 
 			textblock_append_pict(tb, a, c);
@@ -498,7 +739,7 @@ static void object_list_format_section(const object_list_t *list, textblock *tb,
 			 * any raw bytes that might be consolidated into one displayed character.
 			 */
 			full_width += strlen(line_buffer) - Term_mbstowcs(NULL, line_buffer, 0);
-			line_attr = object_list_entry_line_attribute(&list->entries[entry_index]);
+			line_attr = object_list_entry_line_attribute(entry);
 			textblock_append_c(tb, line_attr, "%-*s%s\n", full_width, line_buffer, location);
 		}
 
@@ -605,7 +846,6 @@ void object_list_show_subwindow(int height, int width)
 	tb = textblock_new();
 	list = object_list_shared_instance();
 
-	object_list_reset(list);
 	object_list_collect(list);
 	object_list_sort(list, object_list_standard_compare);
 
@@ -635,7 +875,7 @@ void object_list_show_interactive(int height, int width)
 		return;
 
 	tb = textblock_new();
-	list = object_list_new();
+	list = object_list_shared_instance();
 
 	object_list_collect(list);
 	object_list_sort(list, object_list_standard_compare);
@@ -667,5 +907,4 @@ void object_list_show_interactive(int height, int width)
 	textui_textblock_show(tb, r, NULL);
 
 	textblock_free(tb);
-	object_list_free(list);
 }
@@ -213,8 +213,8 @@ static int bow_multiplier(int sval)
 /*
  * Evaluate the object's overall power level.
  */
-s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
-	bool known)
+static s32b object_power_aux(const object_type* o_ptr, int verbose,
+	ang_file *log_file, bool known)
 {
 	s32b p = 0, q = 0, slay_pwr = 0, dice_pwr = 0;
 	unsigned int i, j;
@@ -457,3 +457,170 @@ s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
 
 	return p;
 }
+
+
+/**
+ * Cache of power ratings for fully known objects.
+ *
+ * Every valuation of a wearable item goes through object_power(), and level
+ * feelings, shop stock and the stats runs keep rating identical items, so
+ * ratings are kept in an open-addressed table keyed by everything
+ * object_power_aux() reads from a fully known object.  A lookup probes up to
+ * POWER_CACHE_PROBE slots from the key's home slot, and a miss replaces the
+ * least recently used (or any stale) slot among them.
+ *
+ * Entries belong to an epoch; object_power_cache_reset() starts a new one,
+ * which empties the cache without touching it.
+ */
+#define POWER_CACHE_SIZE	1024	/* Must be a power of two */
+#define POWER_CACHE_PROBE	8
+
+struct power_key {
+	const struct object_kind *kind;
+	const struct ego_item *ego;
+	const struct artifact *artifact;
+	u16b effect;			/* The artifact's activation */
+	byte tval, sval;
+	byte dd, ds;
+	byte num_pvals;
+	s16b pval[MAX_PVALS];
+	s16b ac, to_a, to_h, to_d;
+	s16b weight;
+	bitflag flags[OF_SIZE];
+	bitflag pval_flags[MAX_PVALS][OF_SIZE];
+};
+
+static struct power_entry {
+	struct power_key key;
+	u32b hash;
+	u32b epoch;			/* 0 if never used */
+	u32b used;			/* When last looked up */
+	s32b power;
+} power_cache[POWER_CACHE_SIZE];
+
+static u32b power_epoch = 1;
+static u32b power_clock = 0;
+static struct object_power_stats power_stats;
+
+/*
+ * Fill in the cache key for an object.  The key is wiped first so that
+ * padding compares equal.
+ */
+static void power_key_make(const object_type *o_ptr, struct power_key *key)
+{
+	int i;
+
+	memset(key, 0, sizeof(*key));
+
+	key->kind = o_ptr->kind;
+	key->ego = o_ptr->ego;
+	key->artifact = o_ptr->artifact;
+	if (o_ptr->artifact)
+		key->effect = o_ptr->artifact->effect;
+	key->tval = o_ptr->tval;
+	key->sval = o_ptr->sval;
+	key->dd = o_ptr->dd;
+	key->ds = o_ptr->ds;
+	key->num_pvals = o_ptr->num_pvals;
+	for (i = 0; i < MAX_PVALS; i++) {
+		key->pval[i] = o_ptr->pval[i];
+		of_copy(key->pval_flags[i], o_ptr->pval_flags[i]);
+	}
+	key->ac = o_ptr->ac;
+	key->to_a = o_ptr->to_a;
+	key->to_h = o_ptr->to_h;
+	key->to_d = o_ptr->to_d;
+	key->weight = o_ptr->weight;
+	of_copy(key->flags, o_ptr->flags);
+}
+
+/*
+ * FNV-1a over the bytes of a key
+ */
+static u32b power_key_hash(const struct power_key *key)
+{
+	const byte *b = (const byte *)key;
+	u32b h = 2166136261U;
+	size_t i;
+
+	for (i = 0; i < sizeof(*key); i++) {
+		h ^= b[i];
+		h *= 16777619U;
+	}
+
+	return h;
+}
+
+/*
+ * Evaluate the object's overall power level, from the cache if possible.
+ *
+ * Only fully known objects are cached, since what the player knows of an
+ * object depends on more than the object itself; logged evaluations are
+ * never cached either.
+ */
+s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
+	bool known)
+{
+	struct power_key key;
+	struct power_entry *entry, *victim = NULL;
+	u32b hash, victim_used = 0;
+	int i;
+
+	if (verbose || !known)
+		return object_power_aux(o_ptr, verbose, log_file, known);
+
+	power_key_make(o_ptr, &key);
+	hash = power_key_hash(&key);
+	power_clock++;
+
+	for (i = 0; i < POWER_CACHE_PROBE; i++) {
+		entry = &power_cache[(hash + i) & (POWER_CACHE_SIZE - 1)];
+
+		if (entry->epoch != power_epoch) {
+			/* Stale slots are always the first choice to replace */
+			if (!victim || victim_used) {
+				victim = entry;
+				victim_used = 0;
+			}
+			continue;
+		}
+
+		if (entry->hash == hash && !memcmp(&entry->key, &key, sizeof(key))) {
+			entry->used = power_clock;
+			power_stats.hits++;
+			return entry->power;
+		}
+
+		if (!victim || (victim_used && entry->used < victim_used)) {
+			victim = entry;
+			victim_used = entry->used;
+		}
+	}
+
+	power_stats.misses++;
+
+	victim->key = key;
+	victim->hash = hash;
+	victim->epoch = power_epoch;
+	victim->used = power_clock;
+	victim->power = object_power_aux(o_ptr, verbose, log_file, known);
+
+	return victim->power;
+}
+
+/*
+ * Forget every cached power rating.  This must be called whenever anything
+ * a rating depends on, apart from the object itself, changes.
+ */
+void object_power_cache_reset(void)
+{
+	power_epoch++;
+}
+
+/*
+ * Get the cache's hit and miss counts since the game started
+ */
+void object_power_get_stats(struct object_power_stats *stats)
+{
+	*stats = power_stats;
+}
@@ -22,6 +22,7 @@
 #include "game-cmd.h"
 #include "generate.h"
 #include "history.h"
+#include "monster/mon-list.h"
 #include "monster/mon-make.h"
 #include "object/inventory.h"
 #include "object/tvalsval.h"
@@ -146,6 +147,9 @@ void flavor_init(void)
 {
 	int i, j;
 
+	/* Flavor and artifact names may change */
+	object_desc_invalidate();
+
 	/* Hack -- Use the "simple" RNG */
 	Rand_quick = TRUE;
 
@@ -848,6 +852,7 @@ void excise_object_idx(int o_idx)
 				{
 					/* Remove from list */
 					cave->o_idx[y][x] = next_o_idx;
+					cave_empty_update(cave, y, x);
 				}
 
 				/* Real previous */
@@ -912,6 +917,7 @@ void delete_object_idx(int o_idx)
 		/* Clear the mimicry */
 		m_ptr->mimicked_o_idx = 0;
 		m_ptr->unaware = FALSE;
+		monster_list_notice(j_ptr->mimicking_m_idx);
 
 #if 0 /* Hack - just make the mimic obviously a mimic instead of deleting it */
 		delete_monster_idx(j_ptr->mimicking_m_idx);
@@ -977,6 +983,7 @@ void delete_object(int y, int x)
 
 	/* Objects are gone */
 	cave->o_idx[y][x] = 0;
+	cave_empty_update(cave, y, x);
 
 	/* Visual update */
 	cave_light_spot(cave, y, x);
@@ -2024,6 +2031,7 @@ s16b floor_carry(struct cave *c, int y, int x, object_type *j_ptr)
 
 		/* Link the floor to the object */
 		c->o_idx[y][x] = o_idx;
+		cave_empty_update(c, y, x);
 
 		cave_note_spot(c, y, x);
 		cave_light_spot(c, y, x);
@@ -4337,3 +4345,16 @@ void objects_destroy(void)
 {
 	mem_free(o_list);
 }
+
+/**
+ * Make `list` (of z_info->o_max objects) the object list, returning the old
+ * one.  o_max and o_cnt describe whichever list is current, so the caller
+ * has to swap those along with it.
+ */
+struct object *objects_swap(struct object *list)
+{
+	struct object *old = o_list;
+
+	o_list = list;
+	return old;
+}
@@ -666,6 +666,7 @@ void object_base_name(char *buf, size_t max, int tval, bool plural);
 void object_kind_name(char *buf, size_t max, const object_kind *kind, bool easy_know);
 size_t obj_desc_name_format(char *buf, size_t max, size_t end, const char *fmt, const char *modstr, bool pluralise);
 size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode);
+void object_desc_invalidate(void);
 
 /* obj-info.c */
 textblock *object_info(const object_type *o_ptr, oinfo_detail_t mode);
@@ -809,9 +810,17 @@ void pack_overflow(void);
 extern struct object *object_byid(s16b oidx);
 extern void objects_init(void);
 extern void objects_destroy(void);
+extern struct object *objects_swap(struct object *list);
 
 /* obj-power.c and randart.c */
+struct object_power_stats {
+	u32b hits;		/* Ratings found in the cache */
+	u32b misses;		/* Ratings worked out */
+};
+
 s32b object_power(const object_type *o_ptr, int verbose, ang_file *log_file, bool known);
+void object_power_cache_reset(void);
+void object_power_get_stats(struct object_power_stats *stats);
 char *artifact_gen_name(struct artifact *a, const char ***wordlist);
 
 #endif /* !INCLUDED_OBJECT_H */
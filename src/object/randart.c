@@ -270,8 +270,16 @@ static byte *base_item_prob;
  */
 static byte *base_art_alloc;
 
-/* Global just for convenience. */
-static int verbose = 1;
+/*
+ * Whether to log everything to randart.log (the -xrandart-log debug option)
+ */
+bool randart_verbose = FALSE;
+
+/*
+ * Objects of each kind as make_fake_artifact() would start them off, so that
+ * artifact_power() needn't prepare a new one each time
+ */
+static object_type *kind_base;
 
 char *artifact_gen_name(struct artifact *a, const char ***words) {
 	char buf[BUFLEN];
@@ -335,22 +343,46 @@ static errr init_names(void)
 /*
  * Return the artifact power, by generating a "fake" object based on the
  * artifact, and calling the common object_power function
+ *
+ * This is called every time an ability is tried on an artifact, so the fake
+ * object is copied from a prepared one for its kind, and is only described
+ * when there is a log to describe it in.
  */
 static s32b artifact_power(int a_idx)
 {
+	struct artifact *a_ptr = &a_info[a_idx];
+	object_kind *kind;
 	object_type obj;
-	char buf[256];
 
-	file_putf(log_file, "********** ENTERING EVAL POWER ********\n");
-	file_putf(log_file, "Artifact index is %d\n", a_idx);
+	if (randart_verbose) {
+		file_putf(log_file, "********** ENTERING EVAL POWER ********\n");
+		file_putf(log_file, "Artifact index is %d\n", a_idx);
+	}
+
+	/* Don't bother with empty artifacts */
+	if (!a_ptr->tval) return 0;
+
+	kind = lookup_kind(a_ptr->tval, a_ptr->sval);
+	if (!kind) return 0;
 
-	if (!make_fake_artifact(&obj, &a_info[a_idx]))
-		return 0;
+	if (!kind_base[kind->kidx].kind)
+		object_prep(&kind_base[kind->kidx], kind, 0, MAXIMISE);
 
-	object_desc(buf, 256*sizeof(char), &obj, ODESC_PREFIX | ODESC_FULL | ODESC_SPOIL);
-	file_putf(log_file, "%s\n", buf);
+	/* As make_fake_artifact() */
+	obj = kind_base[kind->kidx];
+	obj.artifact = a_ptr;
+	copy_artifact_data(&obj, a_ptr);
+	obj.ident |= IDENT_FAKE;
+
+	if (randart_verbose) {
+		char buf[256];
+
+		object_desc(buf, sizeof(buf), &obj,
+			ODESC_PREFIX | ODESC_FULL | ODESC_SPOIL);
+		file_putf(log_file, "%s\n", buf);
+	}
 
-	return object_power(&obj, verbose, log_file, TRUE);
+	return object_power(&obj, randart_verbose, log_file, TRUE);
 }
 
 
@@ -1590,7 +1622,7 @@ static void parse_frequencies(void)
 	}
 	/* End for loop */
 
-	if (verbose)
+	if (randart_verbose)
 	{
 	/* Print out some of the abilities, to make sure that everything's fine */
 		for (i = 0; i < ART_IDX_TOTAL; i++)
@@ -2942,7 +2974,7 @@ static void scramble_artifact(int a_idx)
 			*/
 		}		/* end of power selection */
 
-		if (verbose && tries >= MAX_TRIES)
+		if (randart_verbose && tries >= MAX_TRIES)
 			/*
 			 * We couldn't generate an artifact within the number of permitted
 			 * iterations.  Show a warning message.
@@ -3004,6 +3036,70 @@ static void scramble_artifact(int a_idx)
 	file_putf(log_file, "Number of tries for artifact %d was: %d\n", a_idx, tries);
 }
 
+/*
+ * The kinds of artifact a set must have enough of to be acceptable
+ */
+enum {
+	ART_CAT_NONE = -1,
+	ART_CAT_SWORD,
+	ART_CAT_POLEARM,
+	ART_CAT_BLUNT,
+	ART_CAT_BOW,
+	ART_CAT_BODY,
+	ART_CAT_SHIELD,
+	ART_CAT_CLOAK,
+	ART_CAT_HAT,
+	ART_CAT_GLOVES,
+	ART_CAT_BOOTS,
+
+	ART_CAT_MAX
+};
+
+/* Spare artifacts rolled again for each one a split set is short of */
+#define REROLL_PER_SHORTFALL	10
+
+static const struct {
+	const char *name;	/* For the log */
+	const char *desc;	/* For the restart message */
+	int need;		/* How many a set must have */
+} art_cat[ART_CAT_MAX] = {
+	{ "swords",	"swords",	5 },
+	{ "polearms",	"polearms",	5 },
+	{ "blunts",	"blunts",	5 },
+	{ "bows",	"bows",		4 },
+	{ "bodies",	"body-armors",	5 },
+	{ "shields",	"shields",	4 },
+	{ "cloaks",	"cloaks",	4 },
+	{ "hats",	"hats",		4 },
+	{ "gloves",	"gloves",	4 },
+	{ "boots",	"boots",	4 }
+};
+
+/*
+ * Return the category an artifact of the given tval counts towards
+ */
+static int art_category(int tval)
+{
+	switch (tval)
+	{
+		case TV_SWORD: return ART_CAT_SWORD;
+		case TV_POLEARM: return ART_CAT_POLEARM;
+		case TV_HAFTED: return ART_CAT_BLUNT;
+		case TV_BOW: return ART_CAT_BOW;
+		case TV_SOFT_ARMOR:
+		case TV_HARD_ARMOR:
+		case TV_DRAG_ARMOR: return ART_CAT_BODY;
+		case TV_SHIELD: return ART_CAT_SHIELD;
+		case TV_CLOAK: return ART_CAT_CLOAK;
+		case TV_HELM:
+		case TV_CROWN: return ART_CAT_HAT;
+		case TV_GLOVES: return ART_CAT_GLOVES;
+		case TV_BOOTS: return ART_CAT_BOOTS;
+	}
+
+	return ART_CAT_NONE;
+}
+
 /*
  * Return TRUE if the whole set of random artifacts meets certain
  * criteria.  Return FALSE if we fail to meet those criteria (which will
@@ -3011,79 +3107,81 @@ static void scramble_artifact(int a_idx)
  */
 static bool artifacts_acceptable(void)
 {
-	int swords = 5, polearms = 5, blunts = 5, bows = 4;
-	int bodies = 5, shields = 4, cloaks = 4, hats = 4;
-	int gloves = 4, boots = 4;
-	int i;
+	int deficit[ART_CAT_MAX];
+	bool short_of = FALSE;
+	int i, c;
+
+	for (c = 0; c < ART_CAT_MAX; c++)
+		deficit[c] = art_cat[c].need;
 
 	for (i = ART_MIN_NORMAL; i < z_info->a_max; i++)
 	{
-		switch (a_info[i].tval)
-		{
-			case TV_SWORD:
-				swords--; break;
-			case TV_POLEARM:
-				polearms--; break;
-			case TV_HAFTED:
-				blunts--; break;
-			case TV_BOW:
-				bows--; break;
-			case TV_SOFT_ARMOR:
-			case TV_HARD_ARMOR:
-			case TV_DRAG_ARMOR:
-				bodies--; break;
-			case TV_SHIELD:
-				shields--; break;
-			case TV_CLOAK:
-				cloaks--; break;
-			case TV_HELM:
-			case TV_CROWN:
-				hats--; break;
-			case TV_GLOVES:
-				gloves--; break;
-			case TV_BOOTS:
-				boots--; break;
-		}
-	}
-
-	file_putf(log_file, "Deficit amount for swords is %d\n", swords);
-	file_putf(log_file, "Deficit amount for polearms is %d\n", polearms);
-	file_putf(log_file, "Deficit amount for blunts is %d\n", blunts);
-	file_putf(log_file, "Deficit amount for bows is %d\n", bows);
-	file_putf(log_file, "Deficit amount for bodies is %d\n", bodies);
-	file_putf(log_file, "Deficit amount for shields is %d\n", shields);
-	file_putf(log_file, "Deficit amount for cloaks is %d\n", cloaks);
-	file_putf(log_file, "Deficit amount for hats is %d\n", hats);
-	file_putf(log_file, "Deficit amount for gloves is %d\n", gloves);
-	file_putf(log_file, "Deficit amount for boots is %d\n", boots);
-
-	if (swords > 0 || polearms > 0 || blunts > 0 || bows > 0 ||
-	    bodies > 0 || shields > 0 || cloaks > 0 || hats > 0 ||
-	    gloves > 0 || boots > 0)
-	{
-		if (verbose)
-		{
-			char types[256];
-			strnfmt(types, sizeof(types), "%s%s%s%s%s%s%s%s%s%s",
-				swords > 0 ? " swords" : "",
-				polearms > 0 ? " polearms" : "",
-				blunts > 0 ? " blunts" : "",
-				bows > 0 ? " bows" : "",
-				bodies > 0 ? " body-armors" : "",
-				shields > 0 ? " shields" : "",
-				cloaks > 0 ? " cloaks" : "",
-				hats > 0 ? " hats" : "",
-				gloves > 0 ? " gloves" : "",
-				boots > 0 ? " boots" : "");
-
-			file_putf(log_file, "Restarting generation process: not enough%s",
-				types);
-		}
-		return FALSE;
+		c = art_category(a_info[i].tval);
+		if (c != ART_CAT_NONE) deficit[c]--;
 	}
-	else
+
+	for (c = 0; c < ART_CAT_MAX; c++)
 	{
-		return TRUE;
+		file_putf(log_file, "Deficit amount for %s is %d\n", art_cat[c].name,
+			deficit[c]);
+		if (deficit[c] > 0) short_of = TRUE;
+	}
+
+	if (!short_of) return TRUE;
+
+	if (randart_verbose)
+	{
+		char types[256] = "";
+
+		for (c = 0; c < ART_CAT_MAX; c++)
+			if (deficit[c] > 0)
+				my_strcat(types, format(" %s", art_cat[c].desc),
+					sizeof(types));
+
+		file_putf(log_file, "Restarting generation process: not enough%s",
+			types);
+	}
+
+	return FALSE;
+}
+
+/*
+ * Mark some of the artifacts that can be rolled again without leaving any
+ * category short: those beyond the first few of each category the set
+ * needs, and those that don't count towards a category at all.  Only
+ * REROLL_PER_SHORTFALL of them are marked for each artifact the set is
+ * short of, taking them in index order.
+ */
+static void mark_spare_artifacts(bool *reroll)
+{
+	int count[ART_CAT_MAX] = { 0 }, kept[ART_CAT_MAX] = { 0 };
+	int limit = 0;
+	int i, c;
+
+	for (i = ART_MIN_NORMAL; i < z_info->a_max; i++)
+	{
+		c = art_category(a_info[i].tval);
+		if (c != ART_CAT_NONE) count[c]++;
+	}
+
+	for (c = 0; c < ART_CAT_MAX; c++)
+		if (count[c] < art_cat[c].need)
+			limit += (art_cat[c].need - count[c]) * REROLL_PER_SHORTFALL;
+
+	for (i = 0; i < z_info->a_max; i++)
+	{
+		reroll[i] = FALSE;
+		if (i < ART_MIN_NORMAL || !limit) continue;
+
+		c = art_category(a_info[i].tval);
+		if (c != ART_CAT_NONE && kept[c] < art_cat[c].need)
+		{
+			kept[c]++;
+			continue;
+		}
+
+		reroll[i] = TRUE;
+		limit--;
 	}
 }
 
@@ -3106,8 +3204,62 @@ static errr scramble(void)
 	return (0);
 }
 
+/*
+ * Scramble the artifacts with a random number stream for each one, split
+ * off a stream seeded with randart_seed.
+ *
+ * Each artifact's roll then depends only on its own stream and not on how
+ * many numbers the artifacts before it used, so the rolls can be made in
+ * any order.  If the set comes up short in some category, only the spare
+ * artifacts (see mark_spare_artifacts()) are rolled again, each carrying on
+ * from its own stream, rather than the whole set.
+ */
+static errr scramble_split(u32b randart_seed)
+{
+	struct rand_stream root;
+	struct rand_stream *streams = C_ZNEW(z_info->a_max, struct rand_stream);
+	struct rand_stream *old;
+	bool *reroll = C_ZNEW(z_info->a_max, bool);
+	int a_idx;
+
+	rand_stream_init(&root, randart_seed);
+	for (a_idx = 0; a_idx < z_info->a_max; a_idx++)
+	{
+		rand_stream_split(&root, &streams[a_idx]);
+		reroll[a_idx] = TRUE;
+	}
+
+	/* Draw from the streams rather than the "simple" RNG */
+	Rand_quick = FALSE;
+	old = rand_stream_use(NULL);
 
-static errr do_randart_aux(bool full)
+	while (TRUE)
+	{
+		for (a_idx = 1; a_idx < z_info->a_max; a_idx++)
+		{
+			if (!reroll[a_idx]) continue;
+
+			rand_stream_use(&streams[a_idx]);
+			scramble_artifact(a_idx);
+		}
+
+		if (artifacts_acceptable()) break;
+
+		mark_spare_artifacts(reroll);
+	}
+
+	rand_stream_use(old);
+	Rand_quick = TRUE;
+
+	FREE(streams);
+	FREE(reroll);
+
+	/* Success */
+	return (0);
+}
+
+
+static errr do_randart_aux(u32b randart_seed, bool full)
 {
 	errr result;
 
@@ -3117,7 +3269,12 @@ static errr do_randart_aux(bool full)
 	if (full)
 	{
 		/* Randomize the artifacts */
-		if ((result = scramble()) != 0) return (result);
+		if (OPT(birth_split_randarts))
+			result = scramble_split(randart_seed);
+		else
+			result = scramble();
+
+		if (result != 0) return (result);
 	}
 
 	/* Success */
@@ -3149,9 +3306,10 @@ errr do_randart(u32b randart_seed, bool full)
 		base_art_alloc = C_ZNEW(z_info->a_max, byte);
 		baseprobs = C_ZNEW(z_info->k_max, s16b);
 		base_freq = C_ZNEW(z_info->k_max, s16b);
+		kind_base = C_ZNEW(z_info->k_max, object_type);
 
 		/* Open the log file for writing */
-		if (verbose)
+		if (randart_verbose)
 		{
 			char buf[1024];
 			path_build(buf, sizeof(buf), ANGBAND_DIR_USER,
@@ -3172,24 +3330,24 @@ errr do_randart(u32b randart_seed, bool full)
 	}
 
 	/* Generate the random artifact (names) */
-	err = do_randart_aux(full);
+	err = do_randart_aux(randart_seed, full);
 
 	/* Only do all the following if full randomization requested */
 	if (full)
 	{
-		/* Just for fun, look at the frequencies on the finished items */
-		/* Remove this prior to release */
-		store_base_power();
-		parse_frequencies();
-
 		/* Close the log file */
-		if (verbose)
+		if (randart_verbose)
 		{
+			/* Just for fun, look at the frequencies on the finished items */
+			store_base_power();
+			parse_frequencies();
+
 			if (!file_close(log_file))
 			{
 				msg("Error - can't close randart.log file.");
 				exit(1);
 			}
+			log_file = NULL;
 		}
 
 		/* Free the "original powers" arrays */
@@ -3199,6 +3357,7 @@ errr do_randart(u32b randart_seed, bool full)
 		FREE(base_art_alloc);
 		FREE(baseprobs);
 		FREE(base_freq);
+		FREE(kind_base);
 	}
 
 	/* When done, resume use of the Angband "complex" RNG. */
@@ -34,8 +34,18 @@ static const struct slay slay_table[] =
 
 /**
  * Cache of slay values (for object_power)
+ *
+ * Working out a value means trying the slays against every monster race, and
+ * random artifact generation tries many combinations that no ego item has, so
+ * any combination met is kept.  This is an open-addressed table; a lookup
+ * probes up to SLAY_CACHE_PROBE slots from the home slot of the combination,
+ * and an addition with no free slot among them replaces the home slot.
+ * Combinations never have an empty set of flags, so empty slots are free.
  */
-static struct flag_cache *slay_cache;
+#define SLAY_CACHE_SIZE		1024	/* Must be a power of two */
+#define SLAY_CACHE_PROBE	8
+
+static struct flag_cache slay_cache[SLAY_CACHE_SIZE];
 
 
 /**
@@ -245,19 +255,53 @@ void react_to_slay(bitflag *obj_flags, bitflag *mon_flags)
 }
 
 
+/*
+ * FNV-1a over a set of slay flags
+ */
+static u32b slay_cache_hash(const bitflag *index)
+{
+	u32b h = 2166136261U;
+	size_t i;
+
+	for (i = 0; i < OF_SIZE; i++) {
+		h ^= index[i];
+		h *= 16777619U;
+	}
+
+	return h;
+}
+
+
 /**
- * Check the slay cache for a combination of slays and return a slay value
+ * Find the slot holding a combination of slays in the slay cache, or NULL
+ */
+static struct flag_cache *slay_cache_find(const bitflag *index, u32b hash)
+{
+	struct flag_cache *entry;
+	int i;
+
+	for (i = 0; i < SLAY_CACHE_PROBE; i++) {
+		entry = &slay_cache[(hash + i) & (SLAY_CACHE_SIZE - 1)];
+
+		if (of_is_empty(entry->flags)) return NULL;
+		if (of_is_equal(index, entry->flags)) return entry;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Check the slay cache for a combination of slays and return a slay value,
+ * or 0 if it isn't known yet
  * 
  * \param index is the set of slay flags to look for
  */
 s32b check_slay_cache(bitflag *index)
 {
-	int i;
+	struct flag_cache *entry = slay_cache_find(index, slay_cache_hash(index));
 
-	for (i = 0; !of_is_empty(slay_cache[i].flags); i++)
-		if (of_is_equal(index, slay_cache[i].flags)) break;
-
-	return slay_cache[i].value;
+	return entry ? entry->value : 0;
 }
 
 
@@ -269,16 +313,29 @@ s32b check_slay_cache(bitflag *index)
  */
 bool fill_slay_cache(bitflag *index, s32b value)
 {
+	u32b hash = slay_cache_hash(index);
+	struct flag_cache *entry = slay_cache_find(index, hash);
 	int i;
 
-	for (i = 0; !of_is_empty(slay_cache[i].flags); i++) {
-		if (of_is_equal(index, slay_cache[i].flags)) {
-			slay_cache[i].value = value;
-			return TRUE;
+	/* A new combination takes the first free slot, or its home slot */
+	if (!entry) {
+		entry = &slay_cache[hash & (SLAY_CACHE_SIZE - 1)];
+
+		for (i = 0; i < SLAY_CACHE_PROBE; i++) {
+			struct flag_cache *free_entry =
+				&slay_cache[(hash + i) & (SLAY_CACHE_SIZE - 1)];
+
+			if (of_is_empty(free_entry->flags)) {
+				entry = free_entry;
+				break;
+			}
 		}
+
+		of_copy(entry->flags, index);
 	}
 
-	return FALSE;
+	entry->value = value;
+	return TRUE;
 }
 
 /**
@@ -291,63 +348,34 @@ bool fill_slay_cache(bitflag *index, s32b value)
  */
 errr create_slay_cache(struct ego_item *items)
 {
-    int i;
-    int j;
-    int count = 0;
-    bitflag cacheme[OF_SIZE];
-    bitflag slay_mask[OF_SIZE];
-    bitflag **dupcheck;
-    ego_item_type *e_ptr;
-
-    /* Build the slay mask */
+	int i;
+	bitflag cacheme[OF_SIZE];
+	bitflag slay_mask[OF_SIZE];
+	ego_item_type *e_ptr;
+
+	/* Build the slay mask */
 	create_mask(slay_mask, FALSE, OFT_SLAY, OFT_KILL, OFT_BRAND, OFT_MAX);
 
-    /* Calculate necessary size of slay_cache */
-    dupcheck = C_ZNEW(z_info->e_max, bitflag *);
-
-    for (i = 0; i < z_info->e_max; i++) {
-        dupcheck[i] = C_ZNEW(OF_SIZE, bitflag);
-        e_ptr = items + i;
-
-        /* Find the slay flags on this ego */
-        of_copy(cacheme, e_ptr->flags);
-        of_inter(cacheme, slay_mask);
-
-        /* Only consider non-empty combinations of slay flags */
-        if (!of_is_empty(cacheme)) {
-            /* Skip previously scanned combinations */
-            for (j = 0; j < i; j++)
-                if (of_is_equal(cacheme, dupcheck[j])) continue;
-
-            /* msg("Found a new slay combo on an ego item"); */
-            count++;
-            of_copy(dupcheck[i], cacheme);
-        }
-    }
-
-    /* Allocate slay_cache with an extra empty element for an iteration stop */
-    slay_cache = C_ZNEW((count + 1), struct flag_cache);
-    count = 0;
-
-    /* Populate the slay_cache */
-    for (i = 0; i < z_info->e_max; i++) {
-        if (!of_is_empty(dupcheck[i])) {
-            of_copy(slay_cache[count].flags, dupcheck[i]);
-            slay_cache[count].value = 0;
-            count++;
-            /*msg("Cached a slay combination");*/
-        }
-    }
-
-    for (i = 0; i < z_info->e_max; i++)
-        FREE(dupcheck[i]);
-    FREE(dupcheck);
-
-    /* Success */
-    return 0;
+	free_slay_cache();
+
+	for (i = 0; i < z_info->e_max; i++) {
+		e_ptr = items + i;
+
+		/* Find the slay flags on this ego */
+		of_copy(cacheme, e_ptr->flags);
+		of_inter(cacheme, slay_mask);
+
+		/* Only consider new, non-empty combinations of slay flags */
+		if (!of_is_empty(cacheme) &&
+				!slay_cache_find(cacheme, slay_cache_hash(cacheme)))
+			fill_slay_cache(cacheme, 0);
+	}
+
+	/* Success */
+	return 0;
 }
 
 void free_slay_cache(void)
 {
-	mem_free(slay_cache);
+	C_WIPE(slay_cache, SLAY_CACHE_SIZE, struct flag_cache);
 }
@@ -58,6 +58,7 @@ const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER] =
 	{
 		OPT_birth_randarts,
 		OPT_birth_keep_randarts,
+		OPT_birth_split_randarts,
 		OPT_birth_ai_learn,
 		OPT_birth_force_descend,
 		OPT_birth_no_recall,
@@ -75,7 +76,6 @@ const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER] =
 		OPT_NONE,
 		OPT_NONE,
 		OPT_NONE,
-		OPT_NONE,
 	},
 
 	/* Cheat */
@@ -176,7 +176,7 @@ static const struct option options[OPT_MAX] =
 { "birth_ai_learn",      "Monsters learn from their mistakes",          FALSE }, /* 63 */
 { NULL,                  NULL,                                          FALSE }, /* 64 */
 { "birth_force_descend", "Force player descent",                        FALSE }, /* 65 */
-{ NULL,                  NULL,                                          FALSE }, /* 66 */
+{ "birth_split_randarts", "Roll each random artifact from its own seed", FALSE }, /* 66 */
 { NULL,                  NULL,                                          FALSE }, /* 67 */
 { NULL,                  NULL,                                          FALSE }, /* 68 */
 { NULL,                  NULL,                                          FALSE }, /* 69 */
@@ -105,6 +105,7 @@ extern const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER];
 #define OPT_birth_ai_learn			(OPT_BIRTH+13)
 /* #define OPT_birth_ai_cheat			(OPT_BIRTH+14) */
 #define OPT_birth_force_descend 	(OPT_BIRTH+15)
+#define OPT_birth_split_randarts	(OPT_BIRTH+16)
 
 
 #define OPT(opt_name)	op_ptr->opt[OPT_##opt_name]
@@ -1605,9 +1605,7 @@ void calc_bonuses(object_type inventory[], player_state *state, bool id_only)
 
 	/*** Update all flags ***/
 
-	for (i = 0; i < OF_MAX; i++)
-		if (of_has(collect_f, i))
-			of_on(state->flags, i);
+	of_union(state->flags, collect_f);
 
 
 	/*** Handle stats ***/
@@ -2332,6 +2330,9 @@ void redraw_stuff(struct player *p)
 {
 	size_t i;
 
+	/* Deliver anything held back since the last cycle */
+	event_flush();
+
 	/* Redraw stuff */
 	if (!p->redraw) return;
 
@@ -17,6 +17,7 @@
  */
 #include <errno.h>
 #include "angband.h"
+#include "journal.h"
 #include "savefile.h"
 
 /**
@@ -410,6 +411,9 @@ bool savefile_save(const char *path)
 	char new_savefile[1024];
 	char old_savefile[1024];
 
+	/* A replay must not overwrite the game it is replaying */
+	if (journal_is_replaying()) return TRUE;
+
 	/* New savefile */
 	strnfmt(old_savefile, sizeof(old_savefile), "%s%u.old", path,Rand_simple(1000000));
 	while (file_exists(old_savefile) && (count++ < 100)) {
@@ -447,16 +451,16 @@ bool savefile_save(const char *path)
 
 		safe_setuid_grab();
 
-		if (file_exists(savefile) && !file_move(savefile, old_savefile))
+		if (file_exists(path) && !file_move(path, old_savefile))
 			err = TRUE;
 
 		if (!err)
 		{
-			if (!file_move(new_savefile, savefile))
+			if (!file_move(new_savefile, path))
 				err = TRUE;
 
 			if (err)
-				file_move(old_savefile, savefile);
+				file_move(old_savefile, path);
 			else
 				file_delete(old_savefile);
 		} 
@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "cave.h"
 #include "dungeon.h"
+#include "game-event.h"
 #include "generate.h"
 #include "grafmode.h"
 #include "monster/mon-make.h"
@@ -2860,6 +2861,103 @@ static bool project_p(int who, int r, int y, int x, int dam, int typ,
 }
 
 
+/*
+ * Largest radius of blast project() will handle.  The walls around a blast
+ * are kept as one bitmask per row, so the blast square must fit in 32 bits.
+ */
+#define MAX_BLAST_RAD	14
+#define BLAST_WID	(MAX_BLAST_RAD * 2 + 1)
+
+/*
+ * The offsets making up each ring of a blast, in the order the blast area
+ * used to be scanned: by distance from the centre, then row, then column.
+ * blast_ring[d] is the index of the first offset at distance "d".
+ */
+static struct {
+	s16b y, x;
+} blast_shape[BLAST_WID * BLAST_WID];
+static u16b blast_ring[MAX_BLAST_RAD + 2];
+
+static void blast_shape_init(void)
+{
+	int dist, y, x;
+	int n = 0;
+
+	if (blast_ring[MAX_BLAST_RAD + 1]) return;
+
+	for (dist = 0; dist <= MAX_BLAST_RAD; dist++)
+	{
+		blast_ring[dist] = n;
+
+		for (y = -dist; y <= dist; y++)
+		{
+			for (x = -dist; x <= dist; x++)
+			{
+				if (distance(0, 0, y, x) != dist) continue;
+
+				blast_shape[n].y = y;
+				blast_shape[n].x = x;
+				n++;
+			}
+		}
+	}
+
+	blast_ring[MAX_BLAST_RAD + 1] = n;
+}
+
+/*
+ * Fill in a bitmask of the grids around (y0, x0) which would block a ball;
+ * bit (x - x0 + rad) of row (y - y0 + rad) is set for a wall at (y, x).
+ * Grids off the map are marked as walls.
+ */
+static void blast_walls(u32b *walls, int rad, int y0, int x0)
+{
+	int y, x;
+
+	for (y = 0; y <= rad * 2; y++)
+	{
+		int cy = y0 - rad + y;
+
+		walls[y] = 0;
+
+		for (x = 0; x <= rad * 2; x++)
+		{
+			int cx = x0 - rad + x;
+
+			if (!cave_in_bounds(cave, cy, cx) ||
+					!cave_ispassable(cave, cy, cx))
+				walls[y] |= 1L << x;
+		}
+	}
+}
+
+/*
+ * Check whether the rectangle between the centre of a blast and the grid at
+ * offset (dy, dx), not counting either end, is free of walls.  los() only
+ * ever looks at grids inside that rectangle, so if it's clear there is line
+ * of sight and the full check can be skipped.
+ */
+static bool blast_clear(const u32b *walls, int rad, int dy, int dx)
+{
+	int y1 = MIN(rad, rad + dy), y2 = MAX(rad, rad + dy);
+	int x1 = MIN(rad, rad + dx), x2 = MAX(rad, rad + dx);
+	u32b cols = ((2UL << x2) - 1) & ~((1UL << x1) - 1);
+	int y;
+
+	for (y = y1; y <= y2; y++)
+	{
+		u32b w = walls[y] & cols;
+
+		if (y == rad) w &= ~(1UL << rad);
+		if (y == rad + dy) w &= ~(1UL << (rad + dx));
+
+		if (w) return FALSE;
+	}
+
+	return TRUE;
+}
+
+
 /*
  * Generic "beam"/"bolt"/"ball" projection routine.
  *
@@ -3041,6 +3139,9 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 	/* Encoded "radius" info (see above) */
 	byte gm[16];
 
+	/* Walls around the blast, one bitmask per row */
+	u32b walls[BLAST_WID];
+
 
 	/* Hack -- Jump to target */
 	if (flg & (PROJECT_JUMP))
@@ -3089,9 +3190,12 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 	}
 
 
-	/* Hack -- Assume there will be no blast (max radius 16) */
+	/* Hack -- Assume there will be no blast */
 	for (dist = 0; dist < 16; dist++) gm[dist] = 0;
 
+	/* Hack -- Limit the radius */
+	if (rad > MAX_BLAST_RAD) rad = MAX_BLAST_RAD;
+
 
 	/* Initial grid */
 	y = y1;
@@ -3159,6 +3263,7 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 				Term_xtra(TERM_XTRA_DELAY, msec);
 
 				cave_light_spot(cave, y, x);
+				event_flush();
 
 				Term_fresh();
 				if (p_ptr->redraw) redraw_stuff(p_ptr);
@@ -3204,28 +3309,33 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 		grids--;
 	}
 
+	/* Note which grids around the blast are walls */
+	blast_shape_init();
+	blast_walls(walls, rad, y2, x2);
+
 	/* Determine the blast area, work from the inside out */
 	for (dist = 0; dist <= rad; dist++)
 	{
-		/* Scan the maximal blast area of radius "dist" */
-		for (y = y2 - dist; y <= y2 + dist; y++)
+		/* Scan the ring of grids at distance "dist" */
+		for (i = blast_ring[dist]; i < blast_ring[dist+1]; i++)
 		{
-			for (x = x2 - dist; x <= x2 + dist; x++)
-			{
-				/* Ignore "illegal" locations */
-				if (!cave_in_bounds(cave, y, x)) continue;
+			int dy = blast_shape[i].y;
+			int dx = blast_shape[i].x;
 
-				/* Enforce a "circular" explosion */
-				if (distance(y2, x2, y, x) != dist) continue;
+			y = y2 + dy;
+			x = x2 + dx;
 
-				/* Ball explosions are stopped by walls */
-				if (!los(y2, x2, y, x)) continue;
+			/* Ignore "illegal" locations */
+			if (!cave_in_bounds(cave, y, x)) continue;
 
-				/* Save this grid */
-				gy[grids] = y;
-				gx[grids] = x;
-				grids++;
-			}
+			/* Ball explosions are stopped by walls */
+			if (!blast_clear(walls, rad, dy, dx) && !los(y2, x2, y, x))
+				continue;
+
+			/* Save this grid */
+			gy[grids] = y;
+			gx[grids] = x;
+			grids++;
 		}
 
 		/* Encode some more "radius" info */
@@ -3298,6 +3408,7 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 					cave_light_spot(cave, y, x);
 				}
 			}
+			event_flush();
 
 			/* Hack -- center the cursor */
 			move_cursor_relative(y2, x2);
@@ -3353,6 +3464,9 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 			y = gy[i];
 			x = gx[i];
 
+			/* Speed -- skip empty grids */
+			if (!cave->o_idx[y][x]) continue;
+
 			/* Affect the object in the grid */
 			if (project_o(who, dist, y, x, dam, typ, FALSE)) notice = TRUE;
 		}
@@ -3380,6 +3494,9 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 			y = gy[i];
 			x = gx[i];
 
+			/* Speed -- skip grids without a monster */
+			if (cave->m_idx[y][x] <= 0) continue;
+
 			/* Affect the monster in the grid */
 			if (project_m(who, dist, y, x, dam, typ,
 				(flg & PROJECT_AWARE ? TRUE : FALSE))) notice = TRUE;
@@ -3423,6 +3540,9 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 			y = gy[i];
 			x = gx[i];
 
+			/* Speed -- skip grids without the player */
+			if (cave->m_idx[y][x] >= 0) continue;
+
 			/* Affect the player (assume obvious) */
 			if (project_p(who, dist, y, x, dam, typ, TRUE))
 			{
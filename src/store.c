@@ -23,6 +23,7 @@
 #include "game-event.h"
 #include "history.h"
 #include "init.h"
+#include "journal.h"
 #include "object/inventory.h"
 #include "object/tvalsval.h"
 #include "object/object.h"
@@ -168,7 +169,12 @@ static struct store *store_new(int idx) {
 	struct store *s = mem_zalloc(sizeof *s);
 	s->sidx = idx;
 	s->stock = mem_zalloc(sizeof(*s->stock) * STORE_INVEN_MAX);
+	s->stock_value = mem_zalloc(sizeof(*s->stock_value) * STORE_INVEN_MAX);
+	s->kind_next = mem_zalloc(sizeof(*s->kind_next) * STORE_INVEN_MAX);
 	s->stock_size = STORE_INVEN_MAX;
+
+	/* Built on first use */
+	s->index_num = STORE_INDEX_STALE;
 	return s;
 }
 
@@ -189,6 +195,8 @@ void free_stores(void)
 
 		/* Free the store inventory */
 		mem_free(store->stock);
+		mem_free(store->stock_value);
+		mem_free(store->kind_next);
 		mem_free(store->always_table);
 		mem_free(store->normal_table);
 
@@ -360,6 +368,165 @@ void store_init(void)
 	stores = flatten_stores(stores);
 }
 
+/*** Stock index ***/
+
+/*
+ * Each store keeps the value of one of each of its stock items (worked out
+ * when first needed), and a hash from object kind to the slots holding that
+ * kind, so that looking for something to stack with or a place to put a new
+ * item doesn't have to examine and value the whole stock.
+ *
+ * Everything in this file that changes the stock keeps the index up to
+ * date.  Anything else that changes it (loading a savefile) must set
+ * index_num to STORE_INDEX_STALE, which store_index_check() takes as a
+ * sign to rebuild; a new store starts out that way too.
+ */
+
+#define store_kind_bucket(k)	((k)->kidx & (STORE_KIND_HASH - 1))
+
+/*
+ * Rebuild the kind hash.  Each chain lists its slots in increasing order.
+ */
+static void store_index_build(struct store *s)
+{
+	int i;
+
+	for (i = 0; i < STORE_KIND_HASH; i++)
+		s->kind_head[i] = -1;
+
+	for (i = s->stock_num - 1; i >= 0; i--) {
+		int b = store_kind_bucket(s->stock[i].kind);
+
+		s->kind_next[i] = s->kind_head[b];
+		s->kind_head[b] = i;
+	}
+
+	s->index_num = s->stock_num;
+}
+
+/*
+ * Rebuild the whole index if the stock has been changed behind our back.
+ */
+static void store_index_check(struct store *s)
+{
+	int i;
+
+	if (s->index_num == s->stock_num) return;
+
+	for (i = 0; i < s->stock_num; i++)
+		s->stock_value[i] = -1;
+
+	store_index_build(s);
+}
+
+/*
+ * Forget the value of a stock item which has been changed in place.
+ */
+static void store_value_forget(struct store *s, int slot)
+{
+	s->stock_value[slot] = -1;
+}
+
+/*
+ * Get the value of one of a stock item.
+ */
+static s32b store_stock_value(struct store *s, int slot)
+{
+	if (s->stock_value[slot] < 0)
+		s->stock_value[slot] = object_value(&s->stock[slot], 1, FALSE);
+
+	return s->stock_value[slot];
+}
+
+/*
+ * Put an object in a given slot, moving the rest of the stock up.
+ */
+static void store_stock_insert(struct store *s, int slot,
+		const object_type *o_ptr, s32b value)
+{
+	int move = s->stock_num - slot;
+
+	store_index_check(s);
+
+	memmove(&s->stock[slot + 1], &s->stock[slot], move * sizeof(*s->stock));
+	memmove(&s->stock_value[slot + 1], &s->stock_value[slot],
+			move * sizeof(*s->stock_value));
+
+	object_copy(&s->stock[slot], o_ptr);
+	s->stock_value[slot] = value;
+	s->stock_num++;
+
+	store_index_build(s);
+}
+
+/*
+ * Take the object in a given slot out, moving the rest of the stock down.
+ */
+static void store_stock_remove(struct store *s, int slot)
+{
+	int move = s->stock_num - slot - 1;
+
+	store_index_check(s);
+
+	memmove(&s->stock[slot], &s->stock[slot + 1], move * sizeof(*s->stock));
+	memmove(&s->stock_value[slot], &s->stock_value[slot + 1],
+			move * sizeof(*s->stock_value));
+
+	s->stock_num--;
+	object_wipe(&s->stock[s->stock_num]);
+
+	store_index_build(s);
+}
+
+/*
+ * Return the first slot holding the given kind, or -1
+ */
+static int store_kind_first(struct store *s, const object_kind *k)
+{
+	int slot;
+
+	store_index_check(s);
+
+	for (slot = s->kind_head[store_kind_bucket(k)]; slot >= 0;
+			slot = s->kind_next[slot])
+		if (s->stock[slot].kind == k)
+			return slot;
+
+	return -1;
+}
+
+/*
+ * Return the next slot after `slot` holding the same kind, or -1
+ */
+static int store_kind_next(struct store *s, int slot)
+{
+	const object_kind *k = s->stock[slot].kind;
+
+	for (slot = s->kind_next[slot]; slot >= 0; slot = s->kind_next[slot])
+		if (s->stock[slot].kind == k)
+			return slot;
+
+	return -1;
+}
+
+/*
+ * Return the first slot holding an object the given one would stack with,
+ * or -1
+ */
+static int store_find_similar(struct store *s, const object_type *o_ptr,
+		object_stack_t mode)
+{
+	int slot;
+
+	for (slot = store_kind_first(s, o_ptr->kind); slot >= 0;
+			slot = store_kind_next(s, slot))
+		if (object_similar(&s->stock[slot], o_ptr, mode))
+			return slot;
+
+	return -1;
+}
+
+
 void store_reset(void) {
 	int i, j;
 	struct store *s;
@@ -370,6 +537,7 @@ void store_reset(void) {
 		store_shuffle(s);
 		for (j = 0; j < s->stock_size; j++)
 			object_wipe(&s->stock[j]);
+		store_index_build(s);
 		if (i == STORE_HOME)
 			continue;
 		for (j = 0; j < 10; j++) store_maint(s);
@@ -925,41 +1093,17 @@ static void store_object_absorb(object_type *o_ptr, object_type *j_ptr)
  */
 static bool store_check_num(struct store *store, const object_type *o_ptr)
 {
-	int i;
-	object_type *j_ptr;
+	object_stack_t mode;
 
 	/* Free space is always usable */
 	if (store->stock_num < store->stock_size) return TRUE;
 
 	/* The "home" acts like the player */
-	if (store->sidx == STORE_HOME)
-	{
-		/* Check all the objects */
-		for (i = 0; i < store->stock_num; i++)
-		{
-			/* Get the existing object */
-			j_ptr = &store->stock[i];
-
-			/* Can the new object be combined with the old one? */
-			if (object_similar(j_ptr, o_ptr, OSTACK_PACK))
-				return (TRUE);
-		}
-	}
-
-	/* Normal stores do special stuff */
-	else
-	{
-		/* Check all the objects */
-		for (i = 0; i < store->stock_num; i++)
-		{
-			/* Get the existing object */
-			j_ptr = &store->stock[i];
+	mode = (store->sidx == STORE_HOME) ? OSTACK_PACK : OSTACK_STORE;
 
-			/* Can the new object be combined with the old one? */
-			if (object_similar(j_ptr, o_ptr, OSTACK_STORE))
-				return (TRUE);
-		}
-	}
+	/* Can the new object be combined with an old one? */
+	if (store_find_similar(store, o_ptr, mode) >= 0)
+		return (TRUE);
 
 	/* But there was no room at the inn... */
 	return (FALSE);
@@ -979,27 +1123,22 @@ static bool store_check_num(struct store *store, const object_type *o_ptr)
  */
 static int home_carry(object_type *o_ptr)
 {
-	int i, slot;
+	int slot;
 	u32b value, j_value;
 	object_type *j_ptr;
 
 	struct store *store = &stores[STORE_HOME];
 
-	/* Check each existing object (try to combine) */
-	for (slot = 0; slot < store->stock_num; slot++)
+	/* Check for an existing object to combine with */
+	slot = store_find_similar(store, o_ptr, OSTACK_PACK);
+	if (slot >= 0)
 	{
-		/* Get the existing object */
-		j_ptr = &store->stock[slot];
-
 		/* The home acts just like the player */
-		if (object_similar(j_ptr, o_ptr, OSTACK_PACK))
-		{
-			/* Save the new number of items */
-			object_absorb(j_ptr, o_ptr);
+		object_absorb(&store->stock[slot], o_ptr);
+		store_value_forget(store, slot);
 
-			/* All done */
-			return (slot);
-		}
+		/* All done */
+		return (slot);
 	}
 
 	/* No space? */
@@ -1042,18 +1181,8 @@ static int home_carry(object_type *o_ptr)
 		if (value < j_value) continue;
 	}
 
-	/* Slide the others up */
-	for (i = store->stock_num; i > slot; i--)
-	{
-		/* Hack -- slide the objects */
-		object_copy(&store->stock[i], &store->stock[i-1]);
-	}
-
-	/* More stuff now */
-	store->stock_num++;
-
-	/* Hack -- Insert the new object */
-	object_copy(&store->stock[slot], o_ptr);
+	/* Insert the new object, sliding the others up */
+	store_stock_insert(store, slot, o_ptr, value);
 
 	/* Return the location */
 	return (slot);
@@ -1075,7 +1204,7 @@ static int home_carry(object_type *o_ptr)
 static int store_carry(struct store *store, object_type *o_ptr)
 {
 	unsigned int i;
-	unsigned int slot;
+	int slot;
 	u32b value, j_value;
 	object_type *j_ptr;
 
@@ -1139,21 +1268,16 @@ static int store_carry(struct store *store, object_type *o_ptr)
 		}
 	}
 
-	/* Check each existing object (try to combine) */
-	for (slot = 0; slot < store->stock_num; slot++)
+	/* Can an existing stack be incremented? */
+	slot = store_find_similar(store, o_ptr, OSTACK_STORE);
+	if (slot >= 0)
 	{
-		/* Get the existing object */
-		j_ptr = &store->stock[slot];
-
-		/* Can the existing items be incremented? */
-		if (object_similar(j_ptr, o_ptr, OSTACK_STORE))
-		{
-			/* Absorb (some of) the object */
-			store_object_absorb(j_ptr, o_ptr);
+		/* Absorb (some of) the object */
+		store_object_absorb(&store->stock[slot], o_ptr);
+		store_value_forget(store, slot);
 
-			/* All done */
-			return (slot);
-		}
+		/* All done */
+		return (slot);
 	}
 
 	/* No space? */
@@ -1175,26 +1299,14 @@ static int store_carry(struct store *store, object_type *o_ptr)
 		if (o_ptr->sval < j_ptr->sval) break;
 		if (o_ptr->sval > j_ptr->sval) continue;
 
-		/* Evaluate that slot */
-		j_value = object_value(j_ptr, 1, FALSE);
-
 		/* Objects sort by decreasing value */
+		j_value = store_stock_value(store, slot);
 		if (value > j_value) break;
 		if (value < j_value) continue;
 	}
 
-	/* Slide the others up */
-	for (i = store->stock_num; i > slot; i--)
-	{
-		/* Hack -- slide the objects */
-		object_copy(&store->stock[i], &store->stock[i-1]);
-	}
-
-	/* More stuff now */
-	store->stock_num++;
-
-	/* Hack -- Insert the new object */
-	object_copy(&store->stock[slot], o_ptr);
+	/* Insert the new object, sliding the others up */
+	store_stock_insert(store, slot, o_ptr, value);
 
 	/* Return the location */
 	return (slot);
@@ -1220,6 +1332,9 @@ static void store_item_increase(struct store *store, int item, int num)
 
 	/* Save the new number */
 	o_ptr->number = cnt;
+
+	/* Charges may have been shared out differently */
+	store_value_forget(store, item);
 }
 
 
@@ -1228,7 +1343,6 @@ static void store_item_increase(struct store *store, int item, int num)
  */
 static void store_item_optimize(struct store *store, int item)
 {
-	int j;
 	object_type *o_ptr;
 
 	/* Get the object */
@@ -1240,17 +1354,8 @@ static void store_item_optimize(struct store *store, int item)
 	/* Must have no items */
 	if (o_ptr->number) return;
 
-	/* One less object */
-	store->stock_num--;
-
-	/* Slide everyone */
-	for (j = item; j < store->stock_num; j++)
-	{
-		store->stock[j] = store->stock[j + 1];
-	}
-
-	/* Nuke the final slot */
-	object_wipe(&store->stock[j]);
+	/* Slide everyone down */
+	store_stock_remove(store, item);
 }
 
 
@@ -1333,10 +1438,10 @@ static object_type *store_find_kind(struct store *s, object_kind *k) {
 	assert(k);
 
 	/* Check if it's already in stock */
-	for (slot = 0; slot < s->stock_num; slot++) {
-		if (s->stock[slot].kind == k && !s->stock[slot].ego) {
+	for (slot = store_kind_first(s, k); slot >= 0;
+			slot = store_kind_next(s, slot)) {
+		if (!s->stock[slot].ego)
 			return &s->stock[slot];
-		}
 	}
 
 	return NULL;
@@ -1375,7 +1480,7 @@ static void store_delete_random(struct store *store)
  */
 static bool black_market_ok(const object_type *o_ptr)
 {
-	int i, j;
+	int i;
 
 	/* Ego items are always fine */
 	if (o_ptr->ego) return (TRUE);
@@ -1396,15 +1501,9 @@ static bool black_market_ok(const object_type *o_ptr)
 		if (i == STORE_B_MARKET || i == STORE_HOME)
 			continue;
 
-		/* Check every object in the store */
-		for (j = 0; j < stores[i].stock_num; j++)
-		{
-			object_type *j_ptr = &stores[i].stock[j];
-
-			/* Compare object kinds */
-			if (o_ptr->kind == j_ptr->kind)
-				return (FALSE);
-		}
+		/* Compare object kinds */
+		if (store_kind_first(&stores[i], o_ptr->kind) >= 0)
+			return (FALSE);
 	}
 
 	/* Otherwise fine */
@@ -1639,11 +1738,13 @@ void store_maint(struct store *s)
 			if (o) {
 				/* ensure a full stack */
 				o->number = MAX_STACK_SIZE - 1;
+				store_value_forget(s, o - s->stock);
 			} else {
 				/* Now create the item */
 				int slot = store_create_item(s, k);
 				struct object *o = &s->stock[slot];
 				o->number = MAX_STACK_SIZE - 1;
+				store_value_forget(s, slot);
 			}
 		}
 	}
@@ -3180,7 +3281,10 @@ void do_cmd_store(cmd_code code, cmd_arg args[])
 		prt_welcome(store->owner);
 
 	msg_flag = FALSE;
-	menu_select(&menu, 0, FALSE);
+	if (journal_is_replaying())
+		journal_replay_context(CMD_STORE);
+	else
+		menu_select(&menu, 0, FALSE);
 	msg_flag = FALSE;
 
 	/* Switch back to the normal game view. */
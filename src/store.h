@@ -11,6 +11,8 @@ extern bool store_in_store;
 #define STORE_INVEN_MAX		24    /* Max number of discrete objs in inven */
 #define STORE_TURNS		1000  /* Number of turns between turnovers */
 #define STORE_SHUFFLE		25    /* 1/Chance (per day) of an owner changing */
+#define STORE_KIND_HASH		32    /* Buckets in a store's kind index */
+#define STORE_INDEX_STALE	0xFF  /* index_num that forces a rebuild */
 
 /* List of store indices */
 enum
@@ -45,6 +47,12 @@ struct store {
 	s16b stock_size;		/* Stock -- Total Size of Array */
 	object_type *stock;		/* Stock -- Actual stock items */
 
+	/* Stock index, kept up to date by store.c */
+	byte index_num;			/* stock_num when the index was made */
+	s32b *stock_value;		/* Value of one of each stock item */
+	s16b kind_head[STORE_KIND_HASH];	/* First slot of each kind bucket */
+	s16b *kind_next;		/* Next slot in the same bucket, or -1 */
+
 	/* Always stock these items */
 	size_t always_size;
 	size_t always_num;
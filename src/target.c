@@ -320,13 +320,249 @@ static bool target_set_interactive_accept(int y, int x)
 	return (FALSE);
 }
 
+/*** Targeting index ***/
+
+/*
+ * Visible monsters, filed by their approximate double distance from the
+ * player (as in cmp_distance()) so that they come out nearest first without
+ * scanning the panel or sorting.
+ *
+ * update_mon() reports every look at a monster, which is when it appears,
+ * vanishes or moves, and the index follows along. Entries are checked again
+ * when they are read, so monsters that have since died or been left behind
+ * do no harm; only things that shuffle the whole monster array need to call
+ * target_index_reset().
+ */
+#define TARGET_BUCKETS	(DUNGEON_WID * 2 + DUNGEON_HGT)
+
+static struct {
+	s16b head[TARGET_BUCKETS];	/* First monster in each bucket, or 0 */
+	s16b *next;			/* Next monster in the same bucket, or 0 */
+	s16b *prev;			/* Previous monster, or 0 for the head */
+	s16b *bucket;			/* Bucket a monster is in, or -1 */
+	int num;			/* Monsters in the index */
+	int py, px;			/* Where the buckets are measured from */
+	bool valid;			/* FALSE if it must be rebuilt */
+} target_index;
+
+/*
+ * Approximate double distance from the player to a grid
+ */
+static int target_distance(int py, int px, int y, int x)
+{
+	int kx = ABS(x - px);
+	int ky = ABS(y - py);
+
+	return ((kx > ky) ? (kx + kx + ky) : (ky + ky + kx));
+}
+
+/*
+ * Take a monster out of its bucket
+ */
+static void target_index_remove(int m_idx)
+{
+	int b = target_index.bucket[m_idx];
+
+	if (b < 0) return;
+
+	if (target_index.prev[m_idx])
+		target_index.next[target_index.prev[m_idx]] = target_index.next[m_idx];
+	else
+		target_index.head[b] = target_index.next[m_idx];
+
+	if (target_index.next[m_idx])
+		target_index.prev[target_index.next[m_idx]] = target_index.prev[m_idx];
+
+	target_index.bucket[m_idx] = -1;
+	target_index.num--;
+}
+
+/*
+ * File a monster under its current distance from the player
+ */
+static void target_index_place(struct monster *m)
+{
+	int m_idx = m->midx;
+	int b = target_distance(target_index.py, target_index.px, m->fy, m->fx);
+
+	if (target_index.bucket[m_idx] == b) return;
+
+	target_index_remove(m_idx);
+
+	target_index.prev[m_idx] = 0;
+	target_index.next[m_idx] = target_index.head[b];
+	if (target_index.head[b])
+		target_index.prev[target_index.head[b]] = m_idx;
+	target_index.head[b] = m_idx;
+	target_index.bucket[m_idx] = b;
+	target_index.num++;
+}
+
+/*
+ * Keep the index up to date as update_mon() looks at monsters
+ */
+static void target_index_vis_handler(struct monster *m, int changes)
+{
+	if (!target_index.valid || m->midx <= 0 || m->midx >= z_info->m_max)
+		return;
+
+	if (m->race && m->ml)
+		target_index_place(m);
+	else
+		target_index_remove(m->midx);
+}
+
+/*
+ * Empty the index, measuring from wherever the player is now
+ */
+static void target_index_clear(void)
+{
+	int i;
+
+	for (i = 0; i < TARGET_BUCKETS; i++)
+		target_index.head[i] = 0;
+	for (i = 0; i < z_info->m_max; i++)
+		target_index.bucket[i] = -1;
+
+	target_index.num = 0;
+	target_index.py = p_ptr->py;
+	target_index.px = p_ptr->px;
+}
+
+/*
+ * Make sure the index is there, complete, and measured from the player
+ */
+static void target_index_update(void)
+{
+	int i;
+
+	if (!target_index.bucket) {
+		target_index.next = C_ZNEW(z_info->m_max, s16b);
+		target_index.prev = C_ZNEW(z_info->m_max, s16b);
+		target_index.bucket = C_ZNEW(z_info->m_max, s16b);
+		target_index.valid = FALSE;
+		monster_vis_add_handler(target_index_vis_handler);
+	}
+
+	if (!target_index.valid) {
+		/* Find every visible monster */
+		target_index_clear();
+		for (i = 1; i < cave_monster_max(cave); i++) {
+			struct monster *m = cave_monster(cave, i);
+			if (m->race && m->ml)
+				target_index_place(m);
+		}
+
+		target_index.valid = TRUE;
+	} else if (target_index.py != p_ptr->py ||
+			target_index.px != p_ptr->px) {
+		/* Refile the monsters around the player's new position */
+		s16b *members = C_ZNEW(target_index.num + 1, s16b);
+		int n = 0, b;
+
+		for (b = 0; b < TARGET_BUCKETS; b++)
+			for (i = target_index.head[b]; i; i = target_index.next[i])
+				members[n++] = i;
+
+		target_index_clear();
+		for (i = 0; i < n; i++)
+			target_index_place(cave_monster(cave, members[i]));
+
+		FREE(members);
+	}
+}
+
+/**
+ * Forget the targeting index, because the monster array has been reordered
+ * or emptied. It is rebuilt when it is next needed.
+ */
+void target_index_reset(void)
+{
+	target_index.valid = FALSE;
+}
+
+/**
+ * Free the targeting index.
+ */
+void target_index_free(void)
+{
+	if (!target_index.bucket) return;
+
+	monster_vis_remove_handler(target_index_vis_handler);
+	FREE(target_index.next);
+	FREE(target_index.prev);
+	FREE(target_index.bucket);
+	target_index.valid = FALSE;
+}
+
+/*
+ * Return the targetable monsters on the current panel, nearest first.
+ *
+ * Monsters the same distance away come out in the order a scan of the panel
+ * would find them, as they did when this was done by sorting the scan.
+ */
+static struct point_set *target_index_collect(void)
+{
+	struct point_set *targets = point_set_new(TS_INITIAL_SIZE);
+	int b, i, j, m_idx;
+
+	target_index_update();
+
+	for (b = 0; b < TARGET_BUCKETS; b++) {
+		for (m_idx = target_index.head[b]; m_idx; m_idx = target_index.next[m_idx]) {
+			struct monster *m = cave_monster(cave, m_idx);
+
+			/* Must still be there, and on the panel */
+			if (!m->race || !m->ml) continue;
+			if (m->fy < Term->offset_y || m->fy >= Term->offset_y + SCREEN_HGT) continue;
+			if (m->fx < Term->offset_x || m->fx >= Term->offset_x + SCREEN_WID) continue;
+			if (!cave_in_bounds_fully(cave, m->fy, m->fx)) continue;
+
+			/* Must be a targettable monster */
+			if (!target_able(m)) continue;
+
+			add_to_point_set(targets, m->fy, m->fx);
+		}
+	}
+
+	/*
+	 * Put the grids in order of distance and then position. The buckets
+	 * already have them nearly in order, so this is quick; it also catches
+	 * any monster that has moved since update_mon() last saw it.
+	 */
+	for (i = 1; i < point_set_size(targets); i++) {
+		struct loc l = targets->pts[i];
+		int d = target_distance(p_ptr->py, p_ptr->px, l.y, l.x);
+
+		for (j = i; j > 0; j--) {
+			struct loc k = targets->pts[j - 1];
+			int e = target_distance(p_ptr->py, p_ptr->px, k.y, k.x);
+
+			if (e < d || (e == d && (k.y < l.y || (k.y == l.y && k.x < l.x))))
+				break;
+
+			targets->pts[j] = k;
+		}
+
+		targets->pts[j] = l;
+	}
+
+	return targets;
+}
+
 /*
  * Return a target set of target_able monsters.
  */
 static struct point_set *target_set_interactive_prepare(int mode)
 {
 	int y, x;
-	struct point_set *targets = point_set_new(TS_INITIAL_SIZE);
+	struct point_set *targets;
+
+	/* Only monsters are wanted, so use the index */
+	if (mode & (TARGET_KILL))
+		return target_index_collect();
+
+	targets = point_set_new(TS_INITIAL_SIZE);
 
 	/* Scan the current panel */
 	for (y = Term->offset_y; y < Term->offset_y + SCREEN_HGT; y++)
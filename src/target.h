@@ -29,5 +29,7 @@ bool get_aim_dir(int *dp);
 void target_get(s16b *col, s16b *row);
 struct monster *target_get_monster(void);
 bool target_sighted(void);
+void target_index_reset(void);
+void target_index_free(void);
 
 #endif /* !TARGET_H */
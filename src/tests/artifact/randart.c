@@ -0,0 +1,179 @@
+/* artifact/randart
+ *
+ * Tests for object/randart.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "object/object.h"
+#include "object/tvalsval.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	save_artifacts();
+	return 0;
+}
+
+NOTEARDOWN
+
+/* A cheap fingerprint of the whole artifact set */
+static u32b artifact_hash(void) {
+	u32b h = 0;
+	int i, j;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		struct artifact *a = &a_info[i];
+
+		h = h * 31 + a->tval;
+		h = h * 31 + a->sval;
+		h = h * 31 + a->to_h;
+		h = h * 31 + a->to_d;
+		h = h * 31 + a->to_a;
+		h = h * 31 + a->alloc_prob;
+		h = h * 31 + a->alloc_min;
+		for (j = 0; j < OF_SIZE; j++)
+			h = h * 31 + a->flags[j];
+		for (j = 0; j < MAX_PVALS; j++)
+			h = h * 31 + a->pval[j];
+	}
+
+	return h;
+}
+
+/* The same seed must always give the same artifacts */
+int test_repeatable(void *state) {
+	u32b h1, h2, h3;
+
+	restore_artifacts();
+	do_randart(12345, TRUE);
+	h1 = artifact_hash();
+
+	restore_artifacts();
+	do_randart(54321, TRUE);
+	h2 = artifact_hash();
+
+	restore_artifacts();
+	do_randart(12345, TRUE);
+	h3 = artifact_hash();
+
+	eq(h1, h3);
+	require(h1 != h2);
+	ok;
+}
+
+/*
+ * Whole sets recorded before artifact_power() stopped describing and logging
+ * each candidate, each from a fresh start.  Working out power differently
+ * must not change which artifacts a seed gives.
+ */
+static const struct {
+	u32b seed;
+	u32b hash;
+} whole_sets[] = {
+	{ 12345, 0x9b9c9f05 },
+	{ 54321, 0x8fb080b3 },
+	{ 1, 0xceea89d8 },
+	{ 777, 0x6862298a },
+};
+
+int test_baseline(void *state) {
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(whole_sets); i++) {
+		restore_artifacts();
+		do_randart(whole_sets[i].seed, TRUE);
+		eq(artifact_hash(), whole_sets[i].hash);
+	}
+	ok;
+}
+
+/*
+ * Split sets as first recorded.  Each artifact's roll depends only on its
+ * own stream, so these must not change when the rolling is reorganised.
+ */
+static const struct {
+	u32b seed;
+	u32b hash;
+} split_sets[] = {
+	{ 12345, 0x01be3f56 },
+	{ 54321, 0x3067f8c6 },
+	{ 1, 0xffaa676c },
+	{ 777, 0x653c3340 },
+};
+
+int test_split_baseline(void *state) {
+	size_t i;
+
+	OPT(birth_split_randarts) = TRUE;
+
+	for (i = 0; i < N_ELEMENTS(split_sets); i++) {
+		restore_artifacts();
+		do_randart(split_sets[i].seed, TRUE);
+		if (artifact_hash() != split_sets[i].hash)
+			break;
+	}
+
+	OPT(birth_split_randarts) = FALSE;
+
+	eq(i, N_ELEMENTS(split_sets));
+	ok;
+}
+
+/* Count the normal artifacts of the given tvals */
+static int count_tvals(int tv1, int tv2, int tv3) {
+	int i, n = 0;
+
+	for (i = ART_MIN_NORMAL; i < z_info->a_max; i++) {
+		int tval = a_info[i].tval;
+		if (tval == tv1 || tval == tv2 || tval == tv3)
+			n++;
+	}
+
+	return n;
+}
+
+/* Split sets must be repeatable, and as complete as whole-set rolls */
+int test_split(void *state) {
+	u32b h1, h2, h3;
+
+	OPT(birth_split_randarts) = TRUE;
+
+	restore_artifacts();
+	do_randart(12345, TRUE);
+	h1 = artifact_hash();
+
+	require(count_tvals(TV_SWORD, TV_SWORD, TV_SWORD) >= 5);
+	require(count_tvals(TV_POLEARM, TV_POLEARM, TV_POLEARM) >= 5);
+	require(count_tvals(TV_HAFTED, TV_HAFTED, TV_HAFTED) >= 5);
+	require(count_tvals(TV_BOW, TV_BOW, TV_BOW) >= 4);
+	require(count_tvals(TV_SOFT_ARMOR, TV_HARD_ARMOR, TV_DRAG_ARMOR) >= 5);
+	require(count_tvals(TV_SHIELD, TV_SHIELD, TV_SHIELD) >= 4);
+	require(count_tvals(TV_CLOAK, TV_CLOAK, TV_CLOAK) >= 4);
+	require(count_tvals(TV_HELM, TV_CROWN, TV_CROWN) >= 4);
+	require(count_tvals(TV_GLOVES, TV_GLOVES, TV_GLOVES) >= 4);
+	require(count_tvals(TV_BOOTS, TV_BOOTS, TV_BOOTS) >= 4);
+
+	restore_artifacts();
+	do_randart(54321, TRUE);
+	h2 = artifact_hash();
+
+	restore_artifacts();
+	do_randart(12345, TRUE);
+	h3 = artifact_hash();
+
+	OPT(birth_split_randarts) = FALSE;
+
+	eq(h1, h3);
+	require(h1 != h2);
+	ok;
+}
+
+const char *suite_name = "artifact/randart";
+struct test tests[] = {
+	{ "repeatable", test_repeatable },
+	{ "baseline", test_baseline },
+	{ "split", test_split },
+	{ "split_baseline", test_split_baseline },
+	{ NULL, NULL }
+};
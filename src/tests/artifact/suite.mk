@@ -1 +1,2 @@
 TESTPROGS += artifact/randname
+TESTPROGS += artifact/randart
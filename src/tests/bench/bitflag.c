@@ -0,0 +1,134 @@
+/* bench/bitflag
+ *
+ * Times the bitflag patterns the hot callers use, written the old way (a flag
+ * or a byte at a time) and with the word operations
+ */
+
+#include "angband.h"
+#include "object/obj-flag.h"
+#include "monster/mon-spell.h"
+#include <time.h>
+
+#define BENCH_ROUNDS 200000
+
+#define TIME(name, rounds, body) \
+	do { \
+		clock_t start = clock(); \
+		for (i = 0; i < (rounds); i++) body \
+		printf("bitflag: %-22s %.3fs\n", name, \
+			(double)(clock() - start) / CLOCKS_PER_SEC); \
+	} while (0)
+
+/* flag_next() as it was, testing one flag at a time */
+static int old_next(const bitflag *flags, size_t size, int flag)
+{
+	int f;
+
+	for (f = flag; f < FLAG_MAX(size); f++)
+		if (flags[FLAG_OFFSET(f)] & FLAG_BINARY(f)) return f;
+
+	return FLAG_END;
+}
+
+/* Fill a bitfield with random flags, about a quarter of them on */
+static void random_flags(bitflag *f, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		f[i] = randint0(256) & randint0(256);
+}
+
+int main(int argc, char *argv[])
+{
+	bitflag obj[12][OF_SIZE], player[OF_SIZE], race[RF_SIZE], mask[RF_SIZE];
+	bitflag spells[RSF_SIZE], sparse[OF_SIZE];
+	int i, j, flag, sum = 0;
+	size_t k;
+
+	Rand_state_init(1);
+
+	for (i = 0; i < 12; i++)
+		random_flags(obj[i], OF_SIZE);
+	random_flags(race, RF_SIZE);
+	random_flags(mask, RF_SIZE);
+	rsf_wipe(spells);
+	for (i = 0; i < 8; i++)
+		rsf_on(spells, randint1(RSF_MAX - 1));
+	of_wipe(sparse);
+	for (i = 0; i < 6; i++)
+		of_on(sparse, randint1(OF_MAX - 1));
+
+	/* Collecting equipment flags, as calc_bonuses() does */
+	TIME("old, collect", BENCH_ROUNDS, {
+		of_wipe(player);
+		for (j = 0; j < 12; j++)
+			for (flag = FLAG_START; flag < OF_MAX; flag++)
+				if (of_has(obj[j], flag)) of_on(player, flag);
+		sum += player[i % OF_SIZE];
+	});
+	TIME("words, collect", BENCH_ROUNDS, {
+		of_wipe(player);
+		for (j = 0; j < 12; j++)
+			of_union(player, obj[j]);
+		sum += player[i % OF_SIZE];
+	});
+
+	/* Picking a spell, as choose_attack_spell() does */
+	TIME("old, spells", BENCH_ROUNDS, {
+		byte list[RSF_MAX];
+		int num = 0;
+
+		for (flag = FLAG_START; flag < RSF_MAX; flag++)
+			if (rsf_has(spells, flag)) list[num++] = flag;
+		sum += list[i % num];
+	});
+	TIME("words, spells", BENCH_ROUNDS, {
+		int pick = i % rsf_count(spells);
+
+		for (flag = rsf_next(spells, FLAG_START); pick > 0; pick--)
+			flag = rsf_next(spells, flag + 1);
+		sum += flag;
+	});
+
+	/* Testing race flags against a mask */
+	TIME("old, inter", BENCH_ROUNDS * 10, {
+		mask[i % RF_SIZE] ^= 1;
+		for (k = 0; k < RF_SIZE; k++)
+			if (race[k] & mask[k]) break;
+		sum += (k < RF_SIZE);
+	});
+	TIME("words, inter", BENCH_ROUNDS * 10, {
+		mask[i % RF_SIZE] ^= 1;
+		sum += rf_is_inter(race, mask);
+	});
+
+	/* Walking every flag that is on, in a few or in many */
+	TIME("old, walk sparse", BENCH_ROUNDS * 5, {
+		sparse[3] ^= 8;
+		for (flag = old_next(sparse, OF_SIZE, FLAG_START); flag;
+				flag = old_next(sparse, OF_SIZE, flag + 1))
+			sum += flag;
+	});
+	TIME("words, walk sparse", BENCH_ROUNDS * 5, {
+		sparse[3] ^= 8;
+		for (flag = of_next(sparse, FLAG_START); flag;
+				flag = of_next(sparse, flag + 1))
+			sum += flag;
+	});
+	TIME("old, walk dense", BENCH_ROUNDS * 5, {
+		obj[0][i % OF_SIZE] ^= 8;
+		for (flag = old_next(obj[0], OF_SIZE, FLAG_START); flag;
+				flag = old_next(obj[0], OF_SIZE, flag + 1))
+			sum += flag;
+	});
+	TIME("words, walk dense", BENCH_ROUNDS * 5, {
+		obj[0][i % OF_SIZE] ^= 8;
+		for (flag = of_next(obj[0], FLAG_START); flag;
+				flag = of_next(obj[0], flag + 1))
+			sum += flag;
+	});
+
+	/* Keep the work from being optimised away */
+	return sum == 42;
+}
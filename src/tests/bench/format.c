@@ -0,0 +1,480 @@
+/* bench/format
+ *
+ * Times strnfmt() and strnfmt_r() against the vstrnfmt() they replaced
+ */
+
+#include "angband.h"
+#include <time.h>
+
+#define BENCH_CALLS 200000
+
+/*
+ * vstrnfmt() as it was before format strings were parsed once and numbers
+ * and strings converted by hand: every sequence goes through sprintf().
+ */
+static size_t old_vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp)
+{
+	const char *s;
+	int i = 0, len = 0;
+
+	/* The argument is "long" */
+	bool do_long;
+
+	/* Bytes used in buffer */
+	size_t n;
+
+	/* Bytes used in format sequence */
+	size_t q;
+
+	/* Format sequence */
+	char aux[128];
+
+	/* Resulting string */
+	char tmp[1024];
+
+	assert(max);
+	assert(fmt);
+
+	/* Begin the buffer */
+	n = 0;
+
+	/* Begin the format string */
+	s = fmt;
+
+	/* Scan the format string */
+	while (TRUE)
+	{
+		type_union tval = END;
+
+		/* All done */
+		if (!*s) break;
+
+		/* Normal character */
+		if (*s != '%')
+		{
+			/* Check total length */
+			if (n == max-1) break;
+
+			/* Save the character */
+			buf[n++] = *s++;
+
+			/* Continue */
+			continue;
+		}
+
+		/* Skip the "percent" */
+		s++;
+
+		/* Pre-process "%%" */
+		if (*s == '%')
+		{
+			/* Check total length */
+			if (n == max-1) break;
+
+			/* Save the percent */
+			buf[n++] = '%';
+
+			/* Skip the "%" */
+			s++;
+
+			/* Continue */
+			continue;
+		}
+
+		/* Pre-process "%n" */
+		if (*s == 'n')
+		{
+			size_t *arg;
+
+			/* Get the next argument */
+			arg = va_arg(vp, size_t *);
+
+			/* Save the current length */
+			(*arg) = n;
+
+			/* Skip the "n" */
+			s++;
+
+			/* Continue */
+			continue;
+		}
+
+
+		/* Begin the "aux" string */
+		q = 0;
+
+		/* Save the "percent" */
+		aux[q++] = '%';
+
+		do_long = FALSE;
+
+		/* Build the "aux" string */
+		while (TRUE)
+		{
+			/* Error -- format sequence is not terminated */
+			if (!*s)
+			{
+				/* Terminate the buffer */
+				buf[0] = '\0';
+
+				/* Return "error" */
+				return (0);
+			}
+
+			/* Error -- format sequence may be too long */
+			if (q > 100)
+			{
+				/* Terminate the buffer */
+				buf[0] = '\0';
+
+				/* Return "error" */
+				return (0);
+			}
+
+			/* Handle "alphabetic" chars */
+			if (isalpha((unsigned char)*s))
+			{
+				/* Hack -- handle "long" request */
+				if (*s == 'l')
+				{
+					/* Save the character */
+					aux[q++] = *s++;
+
+					/* Note the "long" flag */
+					do_long = TRUE;
+				}
+
+				/* Handle normal end of format sequence */
+				else
+				{
+					/* Save the character */
+					aux[q++] = *s++;
+
+					/* Stop processing the format sequence */
+					break;
+				}
+			}
+
+			/* Handle "non-alphabetic" chars */
+			else
+			{
+				/* Hack -- Handle 'star' (for "variable length" argument) */
+				if (*s == '*')
+				{
+					int arg;
+
+					/* Get the next argument */
+					arg = va_arg(vp, int);
+
+					/* Hack -- append the "length" */
+					sprintf(aux + q, "%d", arg);
+
+					/* Hack -- accept the "length" */
+					while (aux[q]) q++;
+
+					/* Skip the "*" */
+					s++;
+				}
+
+				/* Collect "normal" characters (digits, "-", "+", ".", etc) */
+				else
+				{
+					/* Save the character */
+					aux[q++] = *s++;
+				}
+			}
+		}
+
+
+		/* Terminate "aux" */
+		aux[q] = '\0';
+
+		/* Clear "tmp" */
+		tmp[0] = '\0';
+
+		/* Parse a type_union */
+		if (aux[q-1] == 'y')
+		{
+			tval = va_arg(vp, type_union);
+
+			if (do_long)
+			{
+				/* Error -- illegal type_union argument */
+				buf[0] = '\0';
+
+				/* Return "error" */
+				return (0);
+			}
+
+			/* Replace aux terminator with proper printf char */
+			if (tval.t == T_CHAR) aux[q-1] = 'c';
+			else if (tval.t == T_INT) aux[q-1] = 'd';
+			else if (tval.t == T_FLOAT) aux[q-1] = 'f';
+			else if (tval.t == T_STRING) aux[q-1] = 's';
+			else
+			{ 
+				buf[0] = '\0';
+				return (0);
+			}
+		}
+
+		/* Process the "format" symbol */
+		switch (aux[q-1])
+		{
+			/* Simple Character -- standard format */
+			case 'c':
+			{
+				int arg;
+
+				/* Get the next argument */
+				arg = tval.t == T_END ? va_arg(vp, int) : tval.u.c;
+
+				/* Format the argument */
+				sprintf(tmp, aux, arg);
+
+				/* Done */
+				break;
+			}
+
+			/* Signed Integers -- standard format */
+			case 'd': case 'i':
+			{
+				if (do_long)
+				{
+					long arg;
+
+					/* Get the next argument */
+					arg = va_arg(vp, long);
+
+					/* Format the argument */
+					sprintf(tmp, aux, arg);
+				}
+				else
+				{
+					int arg;
+
+					/* Get the next argument */
+					arg = tval.t == T_END ? va_arg(vp, int) : tval.u.i;
+
+					/* Format the argument */
+					sprintf(tmp, aux, arg);
+				}
+
+				/* Done */
+				break;
+			}
+
+			/* Unsigned Integers -- various formats */
+			case 'u': case 'o': case 'x': case 'X':
+			{
+				if (do_long)
+				{
+					unsigned long arg;
+
+					/* Get the next argument */
+					arg = va_arg(vp, unsigned long);
+
+					/* Format the argument */
+					sprintf(tmp, aux, arg);
+				}
+				else
+				{
+					unsigned int arg;
+
+					/* Get the next argument */
+					arg = va_arg(vp, unsigned int);
+
+					/* Format the argument */
+					sprintf(tmp, aux, arg);
+				}
+
+				/* Done */
+				break;
+			}
+
+			/* Floating Point -- various formats */
+			case 'f':
+			case 'e': case 'E':
+			case 'g': case 'G':
+			{
+				double arg;
+
+				/* Get the next argument */
+				arg = tval.t == T_END ? va_arg(vp, double) : tval.u.f;
+
+				/* Format the argument */
+				sprintf(tmp, aux, arg);
+
+				/* Done */
+				break;
+			}
+
+			/* Pointer -- implementation varies */
+			case 'p':
+			{
+				void *arg;
+
+				/* Get the next argument */
+				arg = va_arg(vp, void*);
+
+				/* Format the argument */
+				sprintf(tmp, aux, arg);
+
+				/* Done */
+				break;
+			}
+
+			/* String */
+			case 's':
+			{
+				if (do_long)
+				{
+					const wchar_t *arg;
+					char arg2[1024];
+
+					/* XXX There is a big bug here: if one
+					 * passes "%.0s" to strnfmt, then really we
+					 * should not dereference the arg at all.
+					 * But it does.  See bug #666.
+					 */
+
+					/* Get the next argument */
+					arg = va_arg(vp, const wchar_t *);
+
+					/* Hack -- convert NULL to EMPTY */
+					if (!arg) arg = L"";
+
+					/* Format the argument */
+					/* snprintf should not be used in a snprintf replacement function
+					snprintf(tmp, sizeof(tmp), aux, arg); */
+					/* Prevent buffer overflows and convert string to char */
+					/* this really should use a wcstombs type function */
+					len = wcslen(arg);
+					if (len >= 768) {
+						len = 767;
+					}
+					for (i = 0; i < len; ++i) {
+						arg2[i] = (char)arg[i];
+					}
+					arg2[len] = '\0';
+
+					/* Remove the l from aux, since we no longer have wchar_t as input */
+					aux[q-2] = 's';
+					aux[q-1] = '\0';
+
+					/* Format the argument */
+					sprintf(tmp, aux, arg2);
+
+					/*if (my_strcpy((char*)arg2, (char*)arg, sizeof(arg2)) < 1024) {
+						sprintf(tmp, aux, arg2);
+					}*/
+
+					/* Done */
+					break;
+				}
+				else
+				{
+					const char *arg;
+					char arg2[1024];
+
+					/* XXX There is a big bug here: if one
+					 * passes "%.0s" to strnfmt, then really we
+					 * should not dereference the arg at all.
+					 * But it does.  See bug #666.
+					 */
+
+					/* Get the next argument */
+					arg = tval.t == T_END ? va_arg(vp, const char *) : tval.u.s;
+
+					/* Hack -- convert NULL to EMPTY */
+					if (!arg) arg = "";
+
+					/* Format the argument */
+					/* snprintf should not be used in a snprintf replacement function
+					snprintf(tmp, sizeof(tmp), aux, arg); */
+
+					/* Prevent buffer overflows */
+					(void)my_strcpy(arg2, arg, sizeof(arg2));
+
+					/* Format the argument */
+					sprintf(tmp, aux, arg2);
+
+					/* Done */
+					break;
+				}
+			}
+
+			/* Oops */
+			default:
+			{
+				/* Error -- illegal format char */
+				buf[0] = '\0';
+
+				/* Return "error" */
+				return (0);
+			}
+		}
+
+		/* Now append "tmp" to "buf" */
+		for (q = 0; tmp[q]; q++)
+		{
+			/* Check total length */
+			if (n == max-1) break;
+
+			/* Save the character */
+			buf[n++] = tmp[q];
+		}
+	}
+
+
+	/* Terminate buffer */
+	buf[n] = '\0';
+
+	/* Return length */
+	return (n);
+}
+
+static size_t old_strnfmt(char *buf, size_t max, const char *fmt, ...)
+{
+	size_t len;
+	va_list vp;
+
+	va_start(vp, fmt);
+	len = old_vstrnfmt(buf, max, fmt, vp);
+	va_end(vp);
+
+	return len;
+}
+
+#define TIME(name, call) \
+	do { \
+		clock_t start = clock(); \
+		for (i = 0; i < BENCH_CALLS; i++) call; \
+		printf("format: %-22s %.3fs\n", name, \
+			(double)(clock() - start) / CLOCKS_PER_SEC); \
+	} while (0)
+
+int main(int argc, char *argv[])
+{
+	static const char *gold = "You have %d gold and %s (%+d).";
+	static const char *msg = "%s";
+	static const char *status = "%-14s %5d/%-5d %s%c";
+	char buf[256];
+	int i;
+
+	printf("format: %d calls each\n", BENCH_CALLS);
+
+	TIME("old, numbers", old_strnfmt(buf, sizeof(buf), gold, i, "a Dagger", -i));
+	TIME("strnfmt, numbers", strnfmt(buf, sizeof(buf), gold, i, "a Dagger", -i));
+	TIME("strnfmt_r, numbers", strnfmt_r(buf, sizeof(buf), gold, i, "a Dagger", -i));
+
+	TIME("old, message", old_strnfmt(buf, sizeof(buf), msg, "The cave spider bites you."));
+	TIME("strnfmt, message", strnfmt(buf, sizeof(buf), msg, "The cave spider bites you."));
+	TIME("strnfmt_r, message", strnfmt_r(buf, sizeof(buf), msg, "The cave spider bites you."));
+
+	TIME("old, status", old_strnfmt(buf, sizeof(buf), status, "Cave spider", i, 100, "x", '!'));
+	TIME("strnfmt, status", strnfmt(buf, sizeof(buf), status, "Cave spider", i, 100, "x", '!'));
+	TIME("strnfmt_r, status", strnfmt_r(buf, sizeof(buf), status, "Cave spider", i, 100, "x", '!'));
+
+	return 0;
+}
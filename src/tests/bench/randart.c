@@ -0,0 +1,39 @@
+/* bench/randart
+ *
+ * Times do_randart() building whole and split artifact sets
+ */
+
+#include "angband.h"
+#include "test-utils.h"
+#include "object/object.h"
+#include <time.h>
+
+#define BENCH_SEEDS	10
+
+static void benchmark(bool split) {
+	clock_t start = clock();
+	int i;
+
+	OPT(birth_split_randarts) = split;
+
+	for (i = 0; i < BENCH_SEEDS; i++) {
+		restore_artifacts();
+		do_randart(1000 + i, TRUE);
+	}
+
+	OPT(birth_split_randarts) = FALSE;
+
+	printf("randart: %d %s sets in %.2fs\n", BENCH_SEEDS,
+		split ? "split" : "whole",
+		(double)(clock() - start) / CLOCKS_PER_SEC);
+}
+
+int main(int argc, char *argv[]) {
+	read_edit_files();
+	save_artifacts();
+
+	benchmark(FALSE);
+	benchmark(TRUE);
+
+	return 0;
+}
@@ -0,0 +1 @@
+BENCHPROGS += bench/bitflag bench/format bench/randart
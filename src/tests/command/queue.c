@@ -0,0 +1,158 @@
+/* command/queue
+ *
+ * Tests for the command queue
+ */
+
+#include "unit-test.h"
+#include "angband.h"
+#include "game-cmd.h"
+
+int setup_tests(void **state) {
+	cmd_queue_free();
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cmd_queue_free();
+	return 0;
+}
+
+int test_insert_get(void *state) {
+	game_command *cmd;
+
+	require(!cmd_insert(CMD_SEARCH));
+	require(!cmd_insert(CMD_HOLD));
+
+	require(!cmd_get(CMD_GAME, &cmd, FALSE));
+	eq(cmd->command, CMD_SEARCH);
+	require(!cmd_get(CMD_GAME, &cmd, FALSE));
+	eq(cmd->command, CMD_HOLD);
+
+	ok;
+}
+
+/* More commands than the initial queue can hold, in one go */
+int test_batch_grow(void *state) {
+	game_command cmds[100];
+	struct cmd_queue_stats stats;
+	game_command *cmd;
+	int i;
+
+	memset(cmds, 0, sizeof(cmds));
+	for (i = 0; i < 100; i++) {
+		cmds[i].command = CMD_WALK;
+		cmds[i].nrepeats = i;
+	}
+
+	require(!cmd_insert_batch(cmds, 100));
+
+	cmd_queue_get_stats(&stats);
+	eq(stats.queued, 100);
+	require(stats.grows > 0);
+	require(stats.capacity >= 100);
+	eq(stats.batches, 1);
+
+	for (i = 0; i < 100; i++) {
+		require(!cmd_get(CMD_GAME, &cmd, FALSE));
+		eq(cmd->command, CMD_WALK);
+		eq(cmd->nrepeats, i);
+	}
+
+	ok;
+}
+
+/* A batch which can never fit is refused outright */
+int test_batch_reject(void *state) {
+	game_command cmd = { 0 };
+	game_command *cmds;
+	struct cmd_queue_stats before, after;
+	int n = cmd_queue_space() + 1;
+	int i;
+
+	cmds = mem_zalloc(n * sizeof(*cmds));
+	for (i = 0; i < n; i++)
+		cmds[i].command = CMD_HOLD;
+
+	cmd_queue_get_stats(&before);
+	require(cmd_insert_batch(cmds, n));
+	cmd_queue_get_stats(&after);
+	mem_free(cmds);
+
+	eq(after.queued, before.queued);
+	eq(after.rejected, before.rejected + n);
+
+	/* Single inserts still work */
+	cmd.command = CMD_HOLD;
+	require(!cmd_insert_s(&cmd));
+
+	ok;
+}
+
+/* Fill the queue with `n` walks so that it has to grow */
+static void queue_walks(int n) {
+	game_command cmds[300];
+	int i;
+
+	memset(cmds, 0, sizeof(cmds));
+	for (i = 0; i < n; i++)
+		cmds[i].command = CMD_WALK;
+	cmd_insert_batch(cmds, n);
+}
+
+static int nested_grows;
+
+static void nested_handler(cmd_code code, cmd_arg args[]) {
+	game_command *cmd;
+	struct cmd_queue_stats stats;
+
+	cmd_queue_get_stats(&stats);
+	nested_grows = stats.grows;
+	queue_walks(300);
+	cmd_get(CMD_GAME, &cmd, FALSE);
+	cmd_queue_get_stats(&stats);
+	nested_grows = stats.grows - nested_grows;
+}
+
+static int outer_number;
+
+static void outer_handler(cmd_code code, cmd_arg args[]) {
+	game_command *cmd;
+
+	/* Grow the queue, then run a command which grows it again */
+	queue_walks(100);
+	cmd_get(CMD_GAME, &cmd, FALSE);
+	cmd_run_handler(nested_handler, cmd);
+
+	outer_number = args[1].number;
+}
+
+/* Handlers keep their arguments while nested commands grow the queue */
+int test_nested_grow(void *state) {
+	game_command *cmd;
+	int i;
+
+	/* Start from a grown queue so that the outer command is on the heap */
+	cmd_queue_free();
+	queue_walks(30);
+	for (i = 0; i < 30; i++)
+		require(!cmd_get(CMD_GAME, &cmd, FALSE));
+
+	require(!cmd_insert(CMD_DROP));
+	cmd_set_arg_number(cmd_get_top(), 1, 4321);
+	require(!cmd_get(CMD_GAME, &cmd, FALSE));
+
+	cmd_run_handler(outer_handler, cmd);
+	require(nested_grows > 0);
+	eq(outer_number, 4321);
+
+	ok;
+}
+
+const char *suite_name = "command/queue";
+struct test tests[] = {
+	{ "insert_get", test_insert_get },
+	{ "batch_grow", test_batch_grow },
+	{ "batch_reject", test_batch_reject },
+	{ "nested_grow", test_nested_grow },
+	{ NULL, NULL }
+};
@@ -1 +1,2 @@
 TESTPROGS += command/lookup
+TESTPROGS += command/queue
@@ -0,0 +1,158 @@
+/* game-event/dispatch.c */
+
+#include "unit-test.h"
+#include "h-basic.h"
+#include "game-event.h"
+
+static int calls[2];
+static int last_x, last_y;
+static int order[4];
+static int n_order;
+
+static void count_handler(game_event_type type, game_event_data *data,
+		void *user) {
+	int *n = user;
+
+	(*n)++;
+	if (type == EVENT_MAP) {
+		last_x = data->point.x;
+		last_y = data->point.y;
+	}
+}
+
+static void order_handler(game_event_type type, game_event_data *data,
+		void *user) {
+	order[n_order++] = *(int *)user;
+}
+
+static void remove_self(game_event_type type, game_event_data *data,
+		void *user) {
+	calls[1]++;
+	event_remove_handler(type, remove_self, user);
+}
+
+int setup_tests(void **state) {
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	event_remove_all_handlers();
+	return 0;
+}
+
+static void reset(void) {
+	event_set_coalescing(FALSE);
+	event_remove_all_handlers();
+	event_reset_stats();
+	calls[0] = calls[1] = 0;
+	n_order = 0;
+}
+
+int test_order(void *state) {
+	int a = 1, b = 2, c = 3;
+
+	reset();
+	event_add_handler(EVENT_HP, order_handler, &a);
+	event_add_handler(EVENT_HP, order_handler, &b);
+	event_add_handler(EVENT_HP, order_handler, &c);
+	event_remove_handler(EVENT_HP, order_handler, &b);
+	event_signal(EVENT_HP);
+
+	/* Newest handler first */
+	eq(n_order, 2);
+	eq(order[0], 3);
+	eq(order[1], 1);
+	ok;
+}
+
+int test_remove_in_dispatch(void *state) {
+	reset();
+	event_add_handler(EVENT_GOLD, count_handler, &calls[0]);
+	event_add_handler(EVENT_GOLD, remove_self, NULL);
+	event_signal(EVENT_GOLD);
+	event_signal(EVENT_GOLD);
+	eq(calls[0], 2);
+	eq(calls[1], 1);
+	ok;
+}
+
+int test_coalesce_flags(void *state) {
+	struct game_event_stats stats;
+
+	reset();
+	event_add_handler(EVENT_INVENTORY, count_handler, &calls[0]);
+	event_add_handler(EVENT_ENTER_STORE, count_handler, &calls[1]);
+	event_set_coalescing(TRUE);
+
+	event_signal(EVENT_INVENTORY);
+	event_signal(EVENT_INVENTORY);
+	event_signal(EVENT_INVENTORY);
+	eq(calls[0], 0);
+
+	/* State changes are never held back */
+	event_signal(EVENT_ENTER_STORE);
+	eq(calls[1], 1);
+
+	event_signal(EVENT_END);
+	eq(calls[0], 1);
+
+	event_get_stats(EVENT_INVENTORY, &stats);
+	eq(stats.signalled, 3);
+	eq(stats.coalesced, 2);
+	eq(stats.dispatched, 1);
+	eq(stats.calls, 1);
+	ok;
+}
+
+int test_coalesce_points(void *state) {
+	struct game_event_stats stats;
+	int i;
+
+	reset();
+	event_add_handler(EVENT_MAP, count_handler, &calls[0]);
+	event_set_coalescing(TRUE);
+
+	event_signal_point(EVENT_MAP, 3, 4);
+	event_signal_point(EVENT_MAP, 5, 6);
+	event_signal_point(EVENT_MAP, 3, 4);
+	event_flush();
+	eq(calls[0], 2);
+	eq(last_x, 5);
+	eq(last_y, 6);
+
+	event_get_stats(EVENT_MAP, &stats);
+	eq(stats.coalesced, 1);
+
+	/* A full redraw swallows everything else */
+	calls[0] = 0;
+	event_signal_point(EVENT_MAP, 1, 1);
+	event_signal_point(EVENT_MAP, -1, -1);
+	event_signal_point(EVENT_MAP, 2, 2);
+	event_flush();
+	eq(calls[0], 1);
+	eq(last_x, -1);
+	eq(last_y, -1);
+
+	/* So do too many separate grids */
+	calls[0] = 0;
+	for (i = 0; i < 5000; i++)
+		event_signal_point(EVENT_MAP, i % 200, i / 200);
+	event_set_coalescing(FALSE);
+	eq(calls[0], 1);
+	eq(last_x, -1);
+
+	/* And out of coalescing mode, points go straight through */
+	event_signal_point(EVENT_MAP, 7, 8);
+	eq(calls[0], 2);
+	eq(last_x, 7);
+	ok;
+}
+
+const char *suite_name = "game-event/dispatch";
+struct test tests[] = {
+	{ "order", test_order },
+	{ "remove_in_dispatch", test_remove_in_dispatch },
+	{ "coalesce_flags", test_coalesce_flags },
+	{ "coalesce_points", test_coalesce_points },
+	{ NULL, NULL }
+};
@@ -0,0 +1 @@
+TESTPROGS += game-event/dispatch
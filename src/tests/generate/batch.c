@@ -0,0 +1,92 @@
+/* generate/batch
+ *
+ * Tests for batch level generation in generate.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+
+extern struct init_module generate_module;
+extern struct init_module obj_make_module;
+extern struct init_module mon_make_module;
+
+#define BATCH_DEPTH	12
+#define BATCH_COUNT	4
+
+static struct level_summary batch[BATCH_COUNT];
+
+int setup_tests(void **state) {
+	read_edit_files();
+	generate_module.init();
+	obj_make_module.init();
+	mon_make_module.init();
+	objects_init();
+	cave = cave_new();
+	Rand_state_init(7);
+	return 0;
+}
+
+NOTEARDOWN
+
+static void keep_summary(const struct level_summary *sum, void *data) {
+	batch[sum->index] = *sum;
+}
+
+/* Build a level in the game's own cave, as when the player takes stairs */
+static void generate_directly(u32b seed) {
+	struct rand_stream rand;
+	struct rand_stream *old;
+
+	rand_stream_init(&rand, seed);
+	old = rand_stream_use(&rand);
+	Rand_quick = FALSE;
+
+	p_ptr->depth = BATCH_DEPTH;
+	cave_generate(cave, p_ptr);
+
+	rand_stream_use(old);
+}
+
+/* The batch generator builds the same levels as cave_generate() */
+int test_same_as_sequential(void *state) {
+	int i;
+
+	generate_levels(BATCH_DEPTH, BATCH_COUNT, keep_summary, NULL);
+
+	for (i = 0; i < BATCH_COUNT; i++) {
+		int objects = 0, held = 0;
+		int j;
+
+		eq(batch[i].index, i);
+		generate_directly(batch[i].seed);
+
+		for (j = 1; j < o_max; j++) {
+			object_type *o_ptr = object_byid(j);
+
+			if (!o_ptr->kind) continue;
+			if (o_ptr->held_m_idx)
+				held++;
+			else
+				objects++;
+		}
+
+		eq(batch[i].depth, cave->depth);
+		eq(batch[i].obj_feeling, cave->feeling / 10);
+		eq(batch[i].mon_feeling, cave->feeling % 10);
+		eq(batch[i].monsters, cave_monster_count(cave));
+		eq(batch[i].objects, objects);
+		eq(batch[i].held, held);
+	}
+
+	ok;
+}
+
+const char *suite_name = "generate/batch";
+struct test tests[] = {
+	{ "same_as_sequential", test_same_as_sequential },
+	{ NULL, NULL }
+};
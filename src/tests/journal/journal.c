@@ -0,0 +1,250 @@
+/* journal/journal
+ *
+ * Tests for recording and replaying the command journal
+ */
+
+#include "unit-test.h"
+#include "angband.h"
+#include "cave.h"
+#include "game-cmd.h"
+#include "journal.h"
+#include "target.h"
+#include <unistd.h>
+
+static int saves;
+
+/* Where the journals go, and what they are called */
+static char base[1024], journal[1024], journal_1[1024];
+
+/* Checkpoints only need to be recorded, not actually saved */
+static bool fake_save(const char *path) {
+	saves++;
+	return TRUE;
+}
+
+static errr no_command(cmd_context c, bool wait) {
+	return 1;
+}
+
+int setup_tests(void **state) {
+	/* Targetting a location only needs the size of the cave */
+	cave = mem_zalloc(sizeof(*cave));
+	cave->width = DUNGEON_WID;
+	cave->height = DUNGEON_HGT;
+
+	cmd_get_hook = no_command;
+	journal_save_hook = fake_save;
+	arg_journal = TRUE;
+
+	/* Keep out of the way, in the temporary directory */
+	strnfmt(journal, sizeof(journal), "angband-journal-test-%d", (int)getpid());
+	path_build(base, sizeof(base), getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp",
+		journal);
+	strnfmt(journal, sizeof(journal), "%s.jnl", base);
+	strnfmt(journal_1, sizeof(journal_1), "%s.1.jnl", base);
+	my_strcpy(savefile, base, sizeof(savefile));
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	file_delete(journal);
+	file_delete(journal_1);
+	cmd_queue_free();
+	mem_free(cave);
+	return 0;
+}
+
+/* A second session of the same game keeps the first one's journal */
+int test_rotate(void *state) {
+	saves = 0;
+
+	journal_begin();
+	journal_close();
+	require(file_exists(journal));
+	require(!file_exists(journal_1));
+
+	journal_begin();
+	journal_close();
+	require(file_exists(journal));
+	require(file_exists(journal_1));
+
+	/* Each started with a checkpoint */
+	eq(saves, 2);
+	ok;
+}
+
+/*
+ * Record one command with each type of argument and an interruption, then
+ * replay them.  This leaves the journal replaying, so only replays follow.
+ */
+int test_round_trip(void *state) {
+	char long_string[600];
+	game_command cmd;
+	game_command *got;
+	struct journal_stats stats;
+	s16b x, y;
+
+	memset(long_string, 'a', sizeof(long_string) - 1);
+	long_string[sizeof(long_string) - 1] = '\0';
+
+	file_delete(journal);
+	Rand_state_init(1);
+	turn = 100;
+	journal_begin();
+
+	WIPE(&cmd, game_command);
+	cmd.command = CMD_WALK;
+	cmd_set_arg_direction(&cmd, 0, 3);
+	journal_record_cmd(CMD_GAME, &cmd);
+
+	WIPE(&cmd, game_command);
+	cmd.command = CMD_INSCRIBE;
+	cmd_set_arg_item(&cmd, 0, -2);
+	cmd_set_arg_string(&cmd, 1, long_string);
+	journal_record_cmd(CMD_GAME, &cmd);
+	string_free((char *)cmd.arg[1].string);
+
+	WIPE(&cmd, game_command);
+	cmd.command = CMD_PATHFIND;
+	cmd_set_arg_point(&cmd, 0, 10, 7);
+	journal_record_cmd(CMD_GAME, &cmd);
+
+	WIPE(&cmd, game_command);
+	cmd.command = CMD_BUY;
+	cmd_set_arg_choice(&cmd, 0, 2);
+	cmd_set_arg_number(&cmd, 1, 7);
+	journal_record_cmd(CMD_STORE, &cmd);
+
+	/* Aimed at the target, so the target goes in the journal */
+	target_set_location(5, 8);
+	WIPE(&cmd, game_command);
+	cmd.command = CMD_FIRE;
+	cmd_set_arg_item(&cmd, 0, 0);
+	cmd_set_arg_target(&cmd, 1, DIR_TARGET);
+	journal_record_cmd(CMD_GAME, &cmd);
+
+	/* A choice which happens to equal DIR_TARGET is not a target */
+	WIPE(&cmd, game_command);
+	cmd.command = CMD_CAST;
+	cmd_set_arg_choice(&cmd, 0, DIR_TARGET);
+	cmd_set_arg_target(&cmd, 1, 4);
+	journal_record_cmd(CMD_GAME, &cmd);
+
+	turn = 150;
+	journal_record_interrupt();
+	journal_close();
+
+	/* Replay from the start */
+	require(journal_replay_open(journal, 0));
+	require(journal_is_replaying());
+	Rand_state_init(1);
+	turn = 100;
+	target_set_location(1, 1);
+	journal_begin();
+
+	require(!cmd_get(CMD_GAME, &got, FALSE));
+	eq(got->command, CMD_WALK);
+	eq(got->arg[0].direction, 3);
+	eq(got->arg_type[0], arg_DIRECTION);
+
+	require(!cmd_get(CMD_GAME, &got, FALSE));
+	eq(got->command, CMD_INSCRIBE);
+	eq(got->arg[0].item, -2);
+	require(streq(got->arg[1].string, long_string));
+	string_free((char *)got->arg[1].string);
+
+	require(!cmd_get(CMD_GAME, &got, FALSE));
+	eq(got->command, CMD_PATHFIND);
+	eq(got->arg[0].point.x, 10);
+	eq(got->arg[0].point.y, 7);
+
+	/* Store commands only come back in the store */
+	require(!cmd_get(CMD_STORE, &got, FALSE));
+	eq(got->command, CMD_BUY);
+	eq(got->arg[0].choice, 2);
+	eq(got->arg[1].number, 7);
+
+	require(!cmd_get(CMD_GAME, &got, FALSE));
+	eq(got->command, CMD_FIRE);
+	eq(got->arg[1].direction, DIR_TARGET);
+	target_get(&x, &y);
+	eq(x, 8);
+	eq(y, 5);
+
+	target_set_location(2, 3);
+	require(!cmd_get(CMD_GAME, &got, FALSE));
+	eq(got->command, CMD_CAST);
+	eq(got->arg[0].choice, DIR_TARGET);
+	eq(got->arg[1].direction, 4);
+	target_get(&x, &y);
+	eq(x, 3);
+	eq(y, 2);
+
+	turn = 149;
+	require(!journal_replay_interrupt());
+	turn = 150;
+	require(journal_replay_interrupt());
+
+	journal_get_stats(&stats);
+	eq(stats.commands, 6);
+	eq(stats.checkpoints, 1);
+	eq(stats.mismatches, 0);
+
+	journal_close();
+	ok;
+}
+
+/*
+ * A string whose length is absurd, or runs past the end of the journal, ends
+ * the replay cleanly.  This breaks the journal the round trip left.
+ */
+int test_corrupt(void *state) {
+	static const u32b bad_len[] = { 0xFFFFFFFF, 0xFFFF, 1000 };
+	static char buf[4096];
+	game_command *got;
+	struct journal_stats stats;
+	ang_file *f;
+	int len, at, i;
+
+	f = file_open(journal, MODE_READ, -1);
+	require(f);
+	len = file_read(f, buf, sizeof(buf));
+	file_close(f);
+	require(len > 0 && len < (int)sizeof(buf));
+
+	/* The inscription's string, 599 bytes long */
+	for (at = 0; at + 5 <= len; at++)
+		if (!memcmp(buf + at, "\x57\x02\0\0a", 5)) break;
+	require(at + 5 <= len);
+
+	for (i = 0; i < (int)N_ELEMENTS(bad_len); i++) {
+		buf[at] = bad_len[i] & 0xFF;
+		buf[at + 1] = (bad_len[i] >> 8) & 0xFF;
+		buf[at + 2] = (bad_len[i] >> 16) & 0xFF;
+		buf[at + 3] = (bad_len[i] >> 24) & 0xFF;
+
+		f = file_open(journal, MODE_WRITE, FTYPE_RAW);
+		require(f);
+		require(file_write(f, buf, len));
+		file_close(f);
+
+		/* The walk before it still replays, and then the replay ends */
+		require(journal_replay_open(journal, 0));
+		require(!cmd_get(CMD_GAME, &got, FALSE));
+		eq(got->command, CMD_WALK);
+		require(cmd_get(CMD_GAME, &got, FALSE));
+
+		journal_get_stats(&stats);
+		eq(stats.commands, 1);
+		journal_close();
+	}
+	ok;
+}
+
+const char *suite_name = "journal/journal";
+struct test tests[] = {
+	{ "rotate", test_rotate },
+	{ "round_trip", test_round_trip },
+	{ "corrupt", test_corrupt },
+	{ NULL, NULL }
+};
@@ -0,0 +1 @@
+TESTPROGS += journal/journal
@@ -0,0 +1,123 @@
+/* monster/msg
+ *
+ * Tests for the stacking and flushing of monster messages
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "game-event.h"
+#include "monster/mon-msg.h"
+#include "monster/mon-util.h"
+
+#define MAX_SEEN	64
+
+static term test_term;
+static char seen[MAX_SEEN][200];
+static int num_seen;
+
+/* Remember each message, and let the next one start a fresh line */
+static void catch_message(game_event_type type, game_event_data *data,
+		void *user) {
+	if (num_seen < MAX_SEEN)
+		my_strcpy(seen[num_seen++], message_str(0), sizeof(seen[0]));
+
+	msg_flag = FALSE;
+}
+
+int setup_tests(void **state) {
+	read_edit_files();
+	messages_init();
+	mon_msg = C_ZNEW(MAX_STORED_MON_MSG, monster_race_message);
+	mon_message_hist = C_ZNEW(MAX_STORED_MON_CODES, monster_message_history);
+
+	term_init(&test_term, 80, 24, 16);
+	Term_activate(&test_term);
+	character_generated = TRUE;
+
+	event_add_handler(EVENT_MESSAGE, catch_message, NULL);
+	return 0;
+}
+
+NOTEARDOWN
+
+/* Messages stack by race, and delayed ones and deaths come last */
+int test_order(void *state) {
+	struct monster jackal[4], grip;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		WIPE(&jackal[i], struct monster);
+		jackal[i].race = lookup_monster("Jackal");
+		require(jackal[i].race);
+	}
+	WIPE(&grip, struct monster);
+	grip.race = lookup_monster("Grip, Farmer Maggot's dog");
+	require(grip.race);
+
+	num_seen = 0;
+	require(add_monster_message("the jackal", &jackal[0], MON_MSG_DIE, FALSE));
+	require(add_monster_message("the jackal", &jackal[1], MON_MSG_WAKES_UP, FALSE));
+	require(add_monster_message("Grip, Farmer Maggot's dog", &grip,
+			MON_MSG_FLEE_IN_TERROR, TRUE));
+	require(add_monster_message("the jackal", &jackal[2], MON_MSG_WAKES_UP, FALSE));
+	require(add_monster_message("it", &jackal[3], MON_MSG_RESIST, FALSE));
+
+	/* The same monster and message again is dropped */
+	require(!add_monster_message("the jackal", &jackal[1], MON_MSG_WAKES_UP, FALSE));
+
+	flush_all_monster_messages();
+
+	eq(num_seen, 4);
+	require(streq(seen[0], "2 Jackals wake up."));
+	require(streq(seen[1], "It resists."));
+	require(streq(seen[2], "Grip, Farmer Maggot's dog flees in terror!"));
+	require(streq(seen[3], "The Jackal dies."));
+
+	/* Nothing is left over for the next flush */
+	num_seen = 0;
+	flush_all_monster_messages();
+	eq(num_seen, 0);
+	ok;
+}
+
+/* More messages than one batch of writing holds still come out in order */
+int test_many(void *state) {
+	struct monster mon[40];
+	char expect[200];
+	int i, n = 0;
+
+	for (i = 1; i < z_info->r_max && n < 40; i++) {
+		if (!r_info[i].name) continue;
+		WIPE(&mon[n], struct monster);
+		mon[n].race = &r_info[i];
+		require(add_monster_message("the monster", &mon[n], MON_MSG_SHUDDER,
+				FALSE));
+		n++;
+	}
+	eq(n, 40);
+
+	num_seen = 0;
+	flush_all_monster_messages();
+	eq(num_seen, 40);
+
+	for (i = 0; i < n; i++) {
+		const monster_race *r_ptr = mon[i].race;
+
+		if (rf_has(r_ptr->flags, RF_UNIQUE))
+			strnfmt(expect, sizeof(expect), "%s shudders.", r_ptr->name);
+		else
+			strnfmt(expect, sizeof(expect), "The %s shudders.", r_ptr->name);
+		expect[0] = toupper((unsigned char)expect[0]);
+
+		require(streq(seen[i], expect));
+	}
+	ok;
+}
+
+const char *suite_name = "monster/msg";
+struct test tests[] = {
+	{ "order", test_order },
+	{ "many", test_many },
+	{ NULL, NULL }
+};
@@ -0,0 +1,161 @@
+/* monster/vis
+ *
+ * Tests for the skipping of unchanged monsters in update_monsters()
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+#include "monster/mon-make.h"
+#include "monster/mon-util.h"
+
+extern struct init_module generate_module;
+extern struct init_module obj_make_module;
+extern struct init_module mon_make_module;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	generate_module.init();
+	obj_make_module.init();
+	mon_make_module.init();
+	objects_init();
+	Rand_state_init(99);
+
+	p_ptr->race = races;
+	p_ptr->class = classes;
+	p_ptr->inventory = C_ZNEW(ALL_INVEN_TOTAL, object_type);
+	p_ptr->depth = 10;
+
+	cave = cave_new();
+	cave_generate(cave, p_ptr);
+	update_view(cave, p_ptr);
+	update_monsters(TRUE);
+	return 0;
+}
+
+NOTEARDOWN
+
+static int looks;
+
+static void count_looks(struct monster *m_ptr, int changes) {
+	if (changes & MON_VIS_LOOKED)
+		looks++;
+}
+
+/* Change one random thing that visibility depends on */
+static void mutate(void) {
+	int i = randint1(cave_monster_max(cave) - 1);
+	monster_type *m_ptr = cave_monster(cave, i);
+	int y, x;
+
+	switch (randint0(8)) {
+		case 0:
+			/* A monster steps */
+			if (!m_ptr->race) break;
+			y = m_ptr->fy + randint0(3) - 1;
+			x = m_ptr->fx + randint0(3) - 1;
+			if (cave_in_bounds(cave, y, x) && cave_isempty(cave, y, x))
+				monster_swap(m_ptr->fy, m_ptr->fx, y, x);
+			break;
+
+		case 1:
+			/* The player steps */
+			y = p_ptr->py + randint0(3) - 1;
+			x = p_ptr->px + randint0(3) - 1;
+			if (cave_in_bounds(cave, y, x) && cave_isempty(cave, y, x)) {
+				monster_swap(p_ptr->py, p_ptr->px, y, x);
+				update_view(cave, p_ptr);
+				if (one_in_(2)) update_monsters(TRUE);
+			}
+			break;
+
+		case 2:
+			p_ptr->timed[TMD_BLIND] = !p_ptr->timed[TMD_BLIND];
+			break;
+
+		case 3:
+			/* Detected, or no longer */
+			if (m_ptr->race) m_ptr->mflag ^= MFLAG_MARK;
+			break;
+
+		case 4:
+			/* The lights go on or off around the player */
+			for (y = p_ptr->py - 6; y <= p_ptr->py + 6; y++)
+				for (x = p_ptr->px - 6; x <= p_ptr->px + 6; x++)
+					if (cave_in_bounds(cave, y, x))
+						cave->info[y][x] ^= CAVE_GLOW;
+			update_view(cave, p_ptr);
+			break;
+
+		case 5:
+			p_ptr->state.see_infra = randint0(6);
+			break;
+
+		case 6:
+			if (of_has(p_ptr->state.flags, OF_TELEPATHY))
+				of_off(p_ptr->state.flags, OF_TELEPATHY);
+			else
+				of_on(p_ptr->state.flags, OF_TELEPATHY);
+			break;
+
+		case 7:
+			/* Something new turns up nearby */
+			y = p_ptr->py + randint0(11) - 5;
+			x = p_ptr->px + randint0(11) - 5;
+			if (cave_in_bounds(cave, y, x) && cave_isempty(cave, y, x))
+				pick_and_place_monster(cave, y, x, p_ptr->depth, TRUE, TRUE,
+						ORIGIN_DROP);
+			break;
+	}
+}
+
+/*
+ * After each change, skipping unchanged monsters must leave every monster
+ * as looking at all of them again would.
+ */
+int test_skip_matches_full(void *state) {
+	int skipped = 0, total = 0;
+	int n, i;
+
+	monster_vis_add_handler(count_looks);
+
+	for (n = 0; n < 3000; n++) {
+		mutate();
+
+		looks = 0;
+		update_monsters(FALSE);
+		skipped -= looks;
+
+		for (i = 1; i < cave_monster_max(cave); i++) {
+			monster_type *m_ptr = cave_monster(cave, i);
+			bool ml;
+			byte mflag;
+
+			if (!m_ptr->race) continue;
+			ml = m_ptr->ml;
+			mflag = m_ptr->mflag;
+
+			update_mon(m_ptr, FALSE);
+			total++;
+			skipped++;
+
+			eq(m_ptr->ml, ml);
+			eq(m_ptr->mflag, mflag);
+		}
+	}
+
+	monster_vis_remove_handler(count_looks);
+
+	/* Most monsters are unchanged most of the time */
+	require(skipped > total / 2);
+	ok;
+}
+
+const char *suite_name = "monster/vis";
+struct test tests[] = {
+	{ "skip_matches_full", test_skip_matches_full },
+	{ NULL, NULL }
+};
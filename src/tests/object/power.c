@@ -0,0 +1,66 @@
+/* object/power */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+
+#include "object/object.h"
+
+NOSETUP
+NOTEARDOWN
+
+int test_cache(void *state) {
+	struct object_power_stats before, after;
+	struct object obj;
+	s32b p1, p2, p3;
+
+	object_prep(&obj, &test_longsword, 1, AVERAGE);
+	object_power_cache_reset();
+	object_power_get_stats(&before);
+
+	/* The first rating is worked out, the second comes from the cache */
+	p1 = object_power(&obj, FALSE, NULL, TRUE);
+	p2 = object_power(&obj, FALSE, NULL, TRUE);
+	object_power_get_stats(&after);
+	eq(p1, p2);
+	eq(after.misses, before.misses + 1);
+	eq(after.hits, before.hits + 1);
+
+	/* A different object is a different entry */
+	obj.to_h += 10;
+	p3 = object_power(&obj, FALSE, NULL, TRUE);
+	object_power_get_stats(&after);
+	require(p3 > p1);
+	eq(after.misses, before.misses + 2);
+
+	/* Resetting the cache forgets everything */
+	obj.to_h -= 10;
+	object_power_cache_reset();
+	p2 = object_power(&obj, FALSE, NULL, TRUE);
+	object_power_get_stats(&after);
+	eq(p1, p2);
+	eq(after.misses, before.misses + 3);
+	eq(after.hits, before.hits + 1);
+	ok;
+}
+
+int test_unknown(void *state) {
+	struct object_power_stats before, after;
+	struct object obj;
+
+	/* Ratings of what the player knows are never cached */
+	object_prep(&obj, &test_longsword, 1, AVERAGE);
+	object_power_get_stats(&before);
+	object_power(&obj, FALSE, NULL, FALSE);
+	object_power(&obj, FALSE, NULL, FALSE);
+	object_power_get_stats(&after);
+	eq(after.hits, before.hits);
+	eq(after.misses, before.misses);
+	ok;
+}
+
+const char *suite_name = "object/power";
+struct test tests[] = {
+	{ "cache", test_cache },
+	{ "unknown", test_unknown },
+	{ NULL, NULL }
+};
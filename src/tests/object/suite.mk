@@ -1 +1 @@
-TESTPROGS += object/attack object/util
+TESTPROGS += object/attack object/power object/util
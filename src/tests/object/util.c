@@ -47,8 +47,32 @@ int test_obj_can_refill(void *state) {
     ok;
 }
 
+/* Remembered descriptions follow changes to the object */
+int test_obj_desc_cache(void *state) {
+    struct object obj;
+    char first[80], second[80];
+
+    object_prep(&obj, &test_torch, 1, AVERAGE);
+    obj.number = 1;
+    object_desc(first, sizeof(first), &obj, ODESC_PREFIX | ODESC_COMBAT);
+    object_desc(second, sizeof(second), &obj, ODESC_PREFIX | ODESC_COMBAT);
+    require(streq(first, second));
+
+    obj.number = 3;
+    object_desc(second, sizeof(second), &obj, ODESC_PREFIX | ODESC_COMBAT);
+    require(!streq(first, second));
+    require(second[0] == '3');
+
+    /* Lights show their turns */
+    obj.timeout = 17;
+    object_desc(first, sizeof(first), &obj, ODESC_PREFIX | ODESC_COMBAT);
+    require(strstr(first, "(17 turns)"));
+    ok;
+}
+
 const char *suite_name = "object/util";
 struct test tests[] = {
     { "obj_can_refill", test_obj_can_refill },
+    { "obj_desc_cache", test_obj_desc_cache },
     { NULL, NULL }
 };
@@ -0,0 +1,93 @@
+/* store/maint
+ *
+ * Tests for store maintenance in store.c
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "angband.h"
+#include "init.h"
+#include "store.h"
+
+extern struct init_module obj_make_module;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	obj_make_module.init();
+	Rand_state_init(42);
+	return 0;
+}
+
+NOTEARDOWN
+
+/* Check that a store's stock is in order and has all its staples */
+static bool stock_ok(struct store *s) {
+	size_t i;
+	int j;
+
+	for (j = 1; j < s->stock_num; j++) {
+		object_type *a = &s->stock[j - 1], *b = &s->stock[j];
+
+		if (a->tval < b->tval) return FALSE;
+		if (a->tval == b->tval && a->sval > b->sval) return FALSE;
+	}
+
+	for (i = 0; i < s->always_num; i++) {
+		bool found = FALSE;
+
+		for (j = 0; j < s->stock_num; j++)
+			if (s->stock[j].kind == s->always_table[i]) found = TRUE;
+
+		if (!found) return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* A store which has never been stocked, as when loading an empty one */
+int test_empty(void *state) {
+	struct store *s = &stores[STORE_GENERAL];
+
+	eq(s->stock_num, 0);
+
+	/* Stocking it has to look for stacks to add to */
+	store_maint(s);
+	require(s->stock_num > 0);
+	require(stock_ok(s));
+	ok;
+}
+
+int test_reset(void *state) {
+	int i;
+
+	store_reset();
+
+	for (i = 0; i < MAX_STORES; i++) {
+		if (i == STORE_HOME) continue;
+		require(stores[i].stock_num > 0);
+		require(stock_ok(&stores[i]));
+	}
+	ok;
+}
+
+int test_maint_long(void *state) {
+	int i, n;
+
+	for (i = 0; i < MAX_STORES; i++) {
+		if (i == STORE_HOME) continue;
+		for (n = 0; n < 1000; n++)
+			store_maint(&stores[i]);
+		require(stores[i].stock_num > 0);
+		require(stores[i].stock_num <= stores[i].stock_size);
+		require(stock_ok(&stores[i]));
+	}
+	ok;
+}
+
+const char *suite_name = "store/maint";
+struct test tests[] = {
+	{ "empty", test_empty },
+	{ "reset", test_reset },
+	{ "maint-long", test_maint_long },
+	{ NULL, NULL }
+};
@@ -0,0 +1 @@
+TESTPROGS += store/maint
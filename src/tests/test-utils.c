@@ -34,3 +34,36 @@ void read_edit_files(void) {
 	init_file_paths(configpath, libpath, datapath);
 	init_arrays();
 }
+
+/* The standard artifacts, as saved by save_artifacts() */
+static struct artifact *standard_artifacts;
+
+/*
+ * Keep a copy of the artifacts read from the edit files, for tests that
+ * replace them with random artifacts
+ */
+void save_artifacts(void) {
+	int i;
+
+	standard_artifacts = mem_zalloc(z_info->a_max * sizeof(*standard_artifacts));
+	for (i = 0; i < z_info->a_max; i++) {
+		standard_artifacts[i] = a_info[i];
+		standard_artifacts[i].name = string_make(a_info[i].name);
+		standard_artifacts[i].text = string_make(a_info[i].text);
+	}
+}
+
+/*
+ * Put back the artifacts kept by save_artifacts()
+ */
+void restore_artifacts(void) {
+	int i;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		string_free(a_info[i].name);
+		string_free(a_info[i].text);
+		a_info[i] = standard_artifacts[i];
+		a_info[i].name = string_make(standard_artifacts[i].name);
+		a_info[i].text = string_make(standard_artifacts[i].text);
+	}
+}
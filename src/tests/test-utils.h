@@ -10,5 +10,7 @@
 #define TEST_UTILS_H
 
 extern void read_edit_files(void);
+extern void save_artifacts(void);
+extern void restore_artifacts(void);
 
 #endif /* TEST_UTIL_H */
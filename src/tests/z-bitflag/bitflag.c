@@ -0,0 +1,171 @@
+/* z-bitflag/bitflag.c */
+
+#include "unit-test.h"
+#include "angband.h"
+#include "object/obj-flag.h"
+#include "monster/mon-spell.h"
+
+NOSETUP
+NOTEARDOWN
+
+/* Largest bitfield the randomised tests use, in bytes */
+#define MAX_TEST_SIZE 20
+
+/* Fill a bitfield with random flags, sparse or dense */
+static void random_flags(bitflag *f, size_t size) {
+	size_t i;
+	int density = randint0(4);
+
+	for (i = 0; i < size; i++) {
+		f[i] = randint0(256);
+		if (density == 0) f[i] &= randint0(256) & randint0(256);
+		if (density == 1 && randint0(3)) f[i] = 0;
+	}
+}
+
+/* Bit-at-a-time versions to check against */
+static bool ref_has(const bitflag *f, int flag) {
+	return (f[FLAG_OFFSET(flag)] & FLAG_BINARY(flag)) != 0;
+}
+
+static int ref_next(const bitflag *f, size_t size, int flag) {
+	int i;
+
+	for (i = (flag < FLAG_START ? FLAG_START : flag); i < FLAG_MAX(size); i++)
+		if (ref_has(f, i)) return i;
+	return FLAG_END;
+}
+
+int test_has_on_off(void *state) {
+	bitflag f[RF_SIZE];
+
+	rf_wipe(f);
+	require(!rf_has(f, FLAG_END));
+	require(rf_on(f, RF_UNIQUE));
+	require(!rf_on(f, RF_UNIQUE));
+	require(rf_has(f, RF_UNIQUE));
+	require(!rf_has(f, RF_MALE));
+	require(rf_count(f) == 1);
+	require(rf_off(f, RF_UNIQUE));
+	require(!rf_off(f, RF_UNIQUE));
+	require(rf_is_empty(f));
+	ok;
+}
+
+int test_next(void *state) {
+	bitflag f[MAX_TEST_SIZE];
+	size_t size;
+	int i, flag;
+
+	for (i = 0; i < 2000; i++) {
+		size = randint1(MAX_TEST_SIZE);
+		random_flags(f, size);
+
+		for (flag = FLAG_END; flag <= FLAG_MAX(size); flag++)
+			require(flag_next(f, size, flag) == ref_next(f, size, flag));
+	}
+
+	/* A lone flag past a run of empty words */
+	flag_wipe(f, MAX_TEST_SIZE);
+	flag_on(f, MAX_TEST_SIZE, FLAG_MAX(MAX_TEST_SIZE) - 1);
+	require(flag_next(f, MAX_TEST_SIZE, FLAG_START) == FLAG_MAX(MAX_TEST_SIZE) - 1);
+	ok;
+}
+
+int test_count(void *state) {
+	bitflag f[MAX_TEST_SIZE];
+	size_t size;
+	int i, flag, count;
+
+	for (i = 0; i < 2000; i++) {
+		size = randint1(MAX_TEST_SIZE);
+		random_flags(f, size);
+
+		count = 0;
+		for (flag = FLAG_START; flag < FLAG_MAX(size); flag++)
+			if (ref_has(f, flag)) count++;
+
+		require(flag_count(f, size) == count);
+	}
+
+	flag_setall(f, MAX_TEST_SIZE);
+	require(flag_count(f, MAX_TEST_SIZE) == MAX_TEST_SIZE * 8);
+	ok;
+}
+
+int test_set_ops(void *state) {
+	bitflag a[MAX_TEST_SIZE + 1], b[MAX_TEST_SIZE + 1], c[MAX_TEST_SIZE + 1];
+	bitflag want[MAX_TEST_SIZE];
+	size_t size, j;
+	int i;
+
+	for (i = 0; i < 2000; i++) {
+		bool inter = FALSE, subset = TRUE, empty = TRUE, changed;
+
+		size = randint1(MAX_TEST_SIZE);
+		random_flags(a, size);
+		random_flags(b, size);
+
+		/* A guard byte that must never be touched */
+		a[size] = b[size] = c[size] = 0x5A;
+
+		for (j = 0; j < size; j++) {
+			if (a[j] & b[j]) inter = TRUE;
+			if (~a[j] & b[j]) subset = FALSE;
+			if (a[j]) empty = FALSE;
+		}
+		require(flag_is_inter(a, b, size) == inter);
+		require(flag_is_subset(a, b, size) == subset);
+		require(flag_is_empty(a, size) == empty);
+
+		/* Union */
+		changed = FALSE;
+		for (j = 0; j < size; j++) {
+			want[j] = a[j] | b[j];
+			if (want[j] != a[j]) changed = TRUE;
+		}
+		flag_copy(c, a, size);
+		require(flag_union(c, b, size) == changed);
+		require(!memcmp(c, want, size) && c[size] == 0x5A);
+
+		/* Complement union */
+		changed = FALSE;
+		for (j = 0; j < size; j++) {
+			want[j] = a[j] | (bitflag) ~b[j];
+			if (want[j] != a[j]) changed = TRUE;
+		}
+		flag_copy(c, a, size);
+		require(flag_comp_union(c, b, size) == changed);
+		require(!memcmp(c, want, size) && c[size] == 0x5A);
+
+		/* Intersection reports any difference, as it always has */
+		changed = FALSE;
+		for (j = 0; j < size; j++) {
+			want[j] = a[j] & b[j];
+			if (a[j] != b[j]) changed = TRUE;
+		}
+		flag_copy(c, a, size);
+		require(flag_inter(c, b, size) == changed);
+		require(!memcmp(c, want, size) && c[size] == 0x5A);
+
+		/* Difference */
+		changed = FALSE;
+		for (j = 0; j < size; j++) {
+			want[j] = a[j] & ~b[j];
+			if (want[j] != a[j]) changed = TRUE;
+		}
+		flag_copy(c, a, size);
+		require(flag_diff(c, b, size) == changed);
+		require(!memcmp(c, want, size) && c[size] == 0x5A);
+	}
+	ok;
+}
+
+const char *suite_name = "z-bitflag/bitflag";
+struct test tests[] = {
+	{ "has-on-off", test_has_on_off },
+	{ "next", test_next },
+	{ "count", test_count },
+	{ "set-ops", test_set_ops },
+	{ NULL, NULL }
+};
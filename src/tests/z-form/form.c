@@ -0,0 +1,153 @@
+/* z-form/form.c */
+
+#include "unit-test.h"
+#include "z-form.h"
+#include "z-type.h"
+
+NOSETUP
+NOTEARDOWN
+
+/* Format with both strnfmt() and strnfmt_r() and check they agree */
+static const char *both(const char *fmt, ...) {
+	static char buf[256];
+	char buf_r[256];
+	va_list vp;
+
+	va_start(vp, fmt);
+	vstrnfmt(buf, sizeof(buf), fmt, vp);
+	va_end(vp);
+
+	va_start(vp, fmt);
+	vstrnfmt_r(buf_r, sizeof(buf_r), fmt, vp);
+	va_end(vp);
+
+	if (strcmp(buf, buf_r)) return "(mismatch)";
+	return buf;
+}
+
+/* Format an int with "spec", compare with the C library */
+static bool same_int(const char *spec, int i) {
+	char want[256];
+
+	snprintf(want, sizeof(want), spec, i);
+	if (!strcmp(both(spec, i), want)) return TRUE;
+
+	if (verbose)
+		printf("(%s of %d: \"%s\", want \"%s\") ", spec, i, both(spec, i), want);
+	return FALSE;
+}
+
+int test_integers(void *state) {
+	static const char *specs[] = {
+		"%d", "%i", "%5d", "%-5d|", "%05d", "%+d", "% d", "%.3d", "%8.3d",
+		"%-8.3d|", "%.0d", "%u", "%x", "%X", "%#x", "%#X", "%o", "%#o",
+		"%08x", "%#08x", "%+05d", "%-+5d|", "%#.0o", "%.0x", NULL
+	};
+	static const int values[] = {
+		0, 1, -1, 7, 42, -42, 100, 255, 65535, -99999, 2147483647,
+		-2147483647 - 1
+	};
+	int i, j;
+
+	for (i = 0; specs[i]; i++)
+		for (j = 0; j < (int)N_ELEMENTS(values); j++)
+			require(same_int(specs[i], values[j]));
+	ok;
+}
+
+int test_longs(void *state) {
+	char want[64];
+
+	snprintf(want, sizeof(want), "%ld %lu %lx", -1234567890L, 4000000000UL, 0xdeadbeefUL);
+	require(streq(both("%ld %lu %lx", -1234567890L, 4000000000UL, 0xdeadbeefUL), want));
+	ok;
+}
+
+int test_strings(void *state) {
+	require(streq(both("[%s]", "abc"), "[abc]"));
+	require(streq(both("[%6s]", "abc"), "[   abc]"));
+	require(streq(both("[%-6s]", "abc"), "[abc   ]"));
+	require(streq(both("[%.2s]", "abc"), "[ab]"));
+	require(streq(both("[%-.*s]", 1, "abc"), "[a]"));
+	require(streq(both("[%*s]", -4, "ab"), "[ab  ]"));
+	require(streq(both("[%s]", NULL), "[]"));
+	require(streq(both("[%c%3c%-3c]", 'x', 'y', 'z'), "[x  yz  ]"));
+	require(streq(both("[%c%3c%-3c]", '\0', '\0', '\0'), "[  ]"));
+	require(streq(both("a%cb", '\0'), "ab"));
+	require(streq(both("[%ls]", L"wide"), "[wide]"));
+	require(streq(both("100%% %s", "sure"), "100% sure"));
+	ok;
+}
+
+int test_floats(void *state) {
+	char want[64];
+
+	snprintf(want, sizeof(want), "%f %.2f %8.3e %g", 1.5, -2.125, 12345.678, 0.0001);
+	require(streq(both("%f %.2f %8.3e %g", 1.5, -2.125, 12345.678, 0.0001), want));
+	ok;
+}
+
+int test_type_union(void *state) {
+	require(streq(both("%y/%y/%y", i2u(-5), s2u("five"), c2u('5')), "-5/five/5"));
+	require(streq(both("%.1y", f2u(2.25)), "2.2"));
+	ok;
+}
+
+int test_length(void *state) {
+	size_t n = 99;
+
+	require(streq(both("abc%ndef", &n), "abcdef"));
+	eq(n, 3);
+	ok;
+}
+
+int test_truncate(void *state) {
+	char buf[8];
+
+	eq(strnfmt(buf, sizeof(buf), "%d-%s", 12345, "abcdef"), 7);
+	require(streq(buf, "12345-a"));
+	eq(strnfmt_r(buf, sizeof(buf), "%d-%s", 12345, "abcdef"), 7);
+	require(streq(buf, "12345-a"));
+	eq(strnfmt(buf, 1, "%d", 5), 0);
+	require(streq(buf, ""));
+	ok;
+}
+
+int test_errors(void *state) {
+	char buf[32];
+
+	eq(strnfmt(buf, sizeof(buf), "abc %q"), 0);
+	require(streq(buf, ""));
+	eq(strnfmt(buf, sizeof(buf), "abc %"), 0);
+	require(streq(buf, ""));
+	eq(strnfmt(buf, sizeof(buf), "abc %ly", i2u(1)), 0);
+	require(streq(buf, ""));
+	eq(strnfmt_r(buf, sizeof(buf), "abc %q"), 0);
+	require(streq(buf, ""));
+	ok;
+}
+
+int test_reused_buffer(void *state) {
+	char fmt[16];
+
+	/* The same address with new contents must be parsed again */
+	my_strcpy(fmt, "<%d>", sizeof(fmt));
+	require(streq(both(fmt, 1), "<1>"));
+	my_strcpy(fmt, "[%s]", sizeof(fmt));
+	require(streq(both(fmt, "x"), "[x]"));
+	ok;
+}
+
+const char *suite_name = "z-form/form";
+struct test tests[] = {
+	{ "integers", test_integers },
+	{ "longs", test_longs },
+	{ "strings", test_strings },
+	{ "floats", test_floats },
+	{ "type-union", test_type_union },
+	{ "length", test_length },
+	{ "truncate", test_truncate },
+	{ "errors", test_errors },
+	{ "reused-buffer", test_reused_buffer },
+	{ NULL, NULL }
+};
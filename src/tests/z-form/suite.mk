@@ -0,0 +1 @@
+TESTPROGS += z-form/form
@@ -0,0 +1,120 @@
+/* z-rand/rand.c */
+
+#include "unit-test.h"
+#include "z-rand.h"
+
+NOSETUP
+NOTEARDOWN
+
+static void reseed(u32b seed) {
+	Rand_quick = FALSE;
+	state_i = 0;
+	Rand_state_init(seed);
+}
+
+int test_stream_matches_global(void *state) {
+	struct rand_stream s;
+	u32b a[64], b[64];
+	int i;
+
+	reseed(42);
+	rand_stream_init(&s, 42);
+
+	rand_fill_u32(NULL, a, 64);
+	rand_fill_u32(&s, b, 64);
+
+	for (i = 0; i < 64; i++)
+		eq(a[i], b[i]);
+	ok;
+}
+
+int test_stream_use(void *state) {
+	struct rand_stream s, t;
+	u32b saved[RAND_DEG];
+	int i;
+
+	reseed(7);
+	memcpy(saved, STATE, sizeof(saved));
+
+	rand_stream_init(&s, 99);
+	rand_stream_init(&t, 99);
+
+	/* Draws go to the stream, and leave the game's state alone */
+	require(rand_stream_use(&s) == NULL);
+	for (i = 0; i < 100; i++)
+		eq(randint0(1000), rand_stream_div(&t, 1000));
+	require(rand_stream_use(NULL) == &s);
+
+	require(!memcmp(saved, STATE, sizeof(saved)));
+	ok;
+}
+
+int test_split(void *state) {
+	struct rand_stream p, q, c1, c2, c3;
+	int i, same12 = 0, same13 = 0;
+
+	rand_stream_init(&p, 1234);
+	q = p;
+
+	/* The same parent state gives the same child */
+	rand_stream_split(&p, &c1);
+	rand_stream_split(&q, &c2);
+	for (i = 0; i < 100; i++)
+		eq(rand_stream_div(&c1, 0x10000000), rand_stream_div(&c2, 0x10000000));
+
+	/* Splitting again gives a different one */
+	rand_stream_split(&p, &c3);
+	rand_stream_split(&q, &c2);
+	for (i = 0; i < 100; i++) {
+		u32b x = rand_stream_div(&c1, 0x10000000);
+
+		if (x == rand_stream_div(&c2, 0x10000000)) same12++;
+		if (x == rand_stream_div(&c3, 0x10000000)) same13++;
+	}
+	require(same12 < 5);
+	require(same13 < 5);
+	ok;
+}
+
+int test_damroll(void *state) {
+	int sides[] = { 1, 2, 3, 6, 10, 100, 1000 };
+	int i, j, quick;
+
+	/* damroll() must roll exactly as a randint1() per die would */
+	for (quick = 0; quick < 2; quick++) {
+		for (i = 0; i < (int) N_ELEMENTS(sides); i++) {
+			int a, b = 0;
+			u32b next_a, next_b;
+
+			reseed(555 + i);
+			Rand_quick = quick;
+			Rand_value = 555 + i;
+			a = damroll(20, sides[i]);
+			next_a = randint0(0x10000000);
+
+			reseed(555 + i);
+			Rand_quick = quick;
+			Rand_value = 555 + i;
+			for (j = 0; j < 20; j++)
+				b += randint1(sides[i]);
+			next_b = randint0(0x10000000);
+
+			eq(a, b);
+			eq(next_a, next_b);
+		}
+	}
+
+	Rand_quick = FALSE;
+	eq(damroll(5, 0), 0);
+	eq(damroll(5, 1), 5);
+	ok;
+}
+
+const char *suite_name = "z-rand/rand";
+struct test tests[] = {
+	{ "stream_matches_global", test_stream_matches_global },
+	{ "stream_use", test_stream_use },
+	{ "split", test_split },
+	{ "damroll", test_damroll },
+	{ NULL, NULL }
+};
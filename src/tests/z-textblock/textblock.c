@@ -3,6 +3,9 @@
 #include "unit-test.h"
 #include "z-textblock.h"
 #include "z-term.h"
+#include "z-form.h"
+#include "z-util.h"
+#include "z-virt.h"
 
 int setup_tests(void **state) {
 	ok;
@@ -75,11 +78,88 @@ int test_length(void *state) {
 	ok;
 }
 
+/* Lines of a textblock at a width, as "start:length " pairs */
+static void layout_string(textblock *tb, size_t width, char *buf, size_t max) {
+	size_t *starts = NULL, *lengths = NULL;
+	size_t i, n, end = 0;
+
+	n = textblock_calculate_lines(tb, &starts, &lengths, width);
+	buf[0] = '\0';
+	for (i = 0; i < n; i++)
+		strnfcat(buf, max, &end, "%d:%d ", (int)starts[i], (int)lengths[i]);
+
+	mem_free(starts);
+	mem_free(lengths);
+}
+
+int test_wrap(void *state) {
+	textblock *tb = textblock_new();
+	struct textblock_line line;
+	char buf[256];
+
+	textblock_append(tb, "The quick brown fox\njumps over the lazy dog.\n");
+
+	layout_string(tb, 10, buf, sizeof(buf));
+	require(streq(buf, "0:9 10:9 20:5 26:8 35:9 "));
+
+	/* The lines can be read in place */
+	eq(textblock_lines(tb, 10), 5);
+	require(textblock_line(tb, 10, 1, &line));
+	eq(line.len, 9);
+	require(!wmemcmp(line.text, L"brown fox", 9));
+	require(!textblock_line(tb, 10, 5, &line));
+
+	/* Other widths are worked out separately */
+	layout_string(tb, 80, buf, sizeof(buf));
+	require(streq(buf, "0:19 20:24 "));
+
+	textblock_free(tb);
+	ok;
+}
+
+int test_wrap_append(void *state) {
+	static const char *parts[] = {
+		"Some words", " that arrive ", "in pieces,\n", "with a verylongwordthatmustbesliced",
+		" and more\n", "", "end\n",
+		/* A line filled by a space, with the text after it still to come */
+		"abcd ", " xy\n"
+	};
+	textblock *whole = textblock_new();
+	textblock *pieces = textblock_new();
+	char a[512], b[512];
+	size_t i, width;
+
+	for (i = 0; i < N_ELEMENTS(parts); i++)
+		textblock_append(whole, "%s", parts[i]);
+
+	for (width = 3; width < 30; width++) {
+		textblock_free(pieces);
+		pieces = textblock_new();
+
+		/* Lay out after every append, alternating with another width */
+		for (i = 0; i < N_ELEMENTS(parts); i++) {
+			textblock_append(pieces, "%s", parts[i]);
+			textblock_lines(pieces, width);
+			textblock_lines(pieces, width + 7);
+		}
+
+		layout_string(whole, width, a, sizeof(a));
+		layout_string(pieces, width, b, sizeof(b));
+		require(streq(a, b));
+	}
+
+	textblock_free(whole);
+	textblock_free(pieces);
+	ok;
+}
+
 const char *suite_name = "z-textblock/textblock";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "append", test_append },
 	{ "colour", test_colour },
 	{ "length", test_length },
+	{ "wrap", test_wrap },
+	{ "wrap-append", test_wrap_append },
 	{ NULL, NULL }
 };
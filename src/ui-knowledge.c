@@ -130,6 +130,89 @@ static int default_group(int oid) { return default_join[oid].gid; }
 
 static int *obj_group_order = NULL;
 
+
+/*
+ * The order members are listed in depends almost entirely on static data,
+ * so each category keeps a sorted view of every member it could list.  A
+ * view is only re-sorted when the stamp of the data its order depends on
+ * changes; opening a menu just filters the view down to what the player
+ * knows, which keeps it in order.
+ */
+typedef struct
+{
+	int *order;      /* Every possible member, in display order */
+	int count;
+	join_t *join;    /* Group joins, for many-to-many categories */
+	u32b stamp;      /* Stamp of the data the order was built from */
+	bool built;
+} know_view;
+
+static know_view monster_view;
+static know_view artifact_view;
+static know_view ego_view;
+static know_view kind_view;
+
+static void know_view_free(know_view *v)
+{
+	FREE(v->order);
+	FREE(v->join);
+	v->count = 0;
+	v->built = FALSE;
+}
+
+/* Fold a value or a string into a view stamp */
+static u32b stamp_add(u32b stamp, u32b val)
+{
+	return stamp * 31 + val;
+}
+
+static u32b stamp_add_str(u32b stamp, const char *s)
+{
+	if (s)
+		while (*s) stamp = stamp_add(stamp, (byte)*s++);
+
+	return stamp;
+}
+
+
+/*
+ * Row names, formatted the first time a row is drawn while a menu is open
+ * and reused every time the page is redrawn after that.
+ */
+static char **row_names;
+static int row_names_max;
+
+static void row_names_init(int n)
+{
+	row_names = C_ZNEW(n, char *);
+	row_names_max = n;
+}
+
+static void row_names_free(void)
+{
+	int i;
+
+	for (i = 0; i < row_names_max; i++)
+		string_free(row_names[i]);
+
+	FREE(row_names);
+	row_names_max = 0;
+}
+
+static const char *row_name_get(int oid)
+{
+	if (oid < 0 || oid >= row_names_max) return NULL;
+	return row_names[oid];
+}
+
+static void row_name_set(int oid, const char *name)
+{
+	if (oid < 0 || oid >= row_names_max) return;
+
+	string_free(row_names[oid]);
+	row_names[oid] = string_make(name);
+}
+
 /*
  * Description of each monster group.
  */
@@ -1253,7 +1336,6 @@ static void mon_lore(int oid)
 	int r_idx;
 	monster_race *r_ptr;
 	const monster_lore *l_ptr;
-	textblock *tb;
 
 	r_idx = default_join[oid].oid;
 
@@ -1265,10 +1347,7 @@ static void mon_lore(int oid)
 	monster_race_track(r_ptr);
 	handle_stuff(p_ptr);
 
-	tb = textblock_new();
-	lore_description(tb, r_ptr, l_ptr, FALSE);
-	textui_textblock_show(tb, SCREEN_REGION, NULL);
-	textblock_free(tb);
+	textui_textblock_show(lore_recall(r_ptr, l_ptr), SCREEN_REGION, NULL);
 }
 
 static void mon_summary(int gid, const int *object_list, int n, int top, int row, int col)
@@ -1300,68 +1379,38 @@ static void mon_summary(int gid, const int *object_list, int n, int top, int row
 	}
 }
 
-static int count_known_monsters(void)
-{
-	int m_count = 0;
-	int i;
-	size_t j;
-
-	for (i = 0; i < z_info->r_max; i++)
-	{
-		monster_race *r_ptr = &r_info[i];
-		if (!OPT(cheat_know) && !l_list[i].sights) continue;
-		if (!r_ptr->name) continue;
-
-		if (rf_has(r_ptr->flags, RF_UNIQUE)) m_count++;
-
-		for (j = 1; j < N_ELEMENTS(monster_group) - 1; j++)
-		{
-			const wchar_t *pat = monster_group[j].chars;
-			if (wcschr(pat, r_ptr->d_char)) m_count++;
-		}
-	}
-
-	return m_count;
-}
-
 /*
- * Display known monsters.
+ * Build the view of every (race, group) pair the monster menu could show.
+ * The order only depends on r_info, so it is built once.
  */
-static void do_cmd_knowledge_monsters(const char *name, int row)
+static void monster_view_build(void)
 {
-	group_funcs r_funcs = {N_ELEMENTS(monster_group), FALSE, race_name,
-							m_cmp_race, default_group, mon_summary};
-
-	member_funcs m_funcs = {display_monster, mon_lore, m_xchar, m_xattr, recall_prompt, 0, 0};
-
-	int *monsters;
-	int m_count = 0;
-	int i;
+	know_view *v = &monster_view;
+	int i, n = 0;
 	size_t j;
 
+	if (v->built) return;
+
 	for (i = 0; i < z_info->r_max; i++)
 	{
 		monster_race *r_ptr = &r_info[i];
-		if (!OPT(cheat_know) && !l_list[i].sights) continue;
 		if (!r_ptr->name) continue;
 
-		if (rf_has(r_ptr->flags, RF_UNIQUE)) m_count++;
+		if (rf_has(r_ptr->flags, RF_UNIQUE)) n++;
 
 		for (j = 1; j < N_ELEMENTS(monster_group) - 1; j++)
 		{
 			const wchar_t *pat = monster_group[j].chars;
-			if (wcschr(pat, r_ptr->d_char)) m_count++;
+			if (wcschr(pat, r_ptr->d_char)) n++;
 		}
 	}
 
-	default_join = C_ZNEW(m_count, join_t);
-	monsters = C_ZNEW(m_count, int);
+	v->join = C_ZNEW(n, join_t);
+	v->order = C_ZNEW(n, int);
 
-	m_count = 0;
 	for (i = 0; i < z_info->r_max; i++)
 	{
 		monster_race *r_ptr = &r_info[i];
-		if (!OPT(cheat_know) && !l_list[i].sights) continue;
 		if (!r_ptr->name) continue;
 
 		for (j = 0; j < N_ELEMENTS(monster_group)-1; j++)
@@ -1372,15 +1421,66 @@ static void do_cmd_knowledge_monsters(const char *name, int row)
 			else if (j > 0 && !wcschr(pat, r_ptr->d_char))
 				continue;
 
-			monsters[m_count] = m_count;
-			default_join[m_count].oid = i;
-			default_join[m_count++].gid = j;
+			v->order[v->count] = v->count;
+			v->join[v->count].oid = i;
+			v->join[v->count++].gid = j;
 		}
 	}
 
+	default_join = v->join;
+	sort(v->order, v->count, sizeof(*v->order), m_cmp_race);
+	default_join = NULL;
+
+	v->built = TRUE;
+}
+
+/*
+ * Collect the known monsters from the view into 'monsters', in display
+ * order, or just count them if 'monsters' is NULL.
+ */
+static int collect_known_monsters(int *monsters)
+{
+	int m_count = 0;
+	int i;
+
+	monster_view_build();
+
+	for (i = 0; i < monster_view.count; i++)
+	{
+		int oid = monster_view.order[i];
+		int r_idx = monster_view.join[oid].oid;
+
+		if (!OPT(cheat_know) && !l_list[r_idx].sights) continue;
+
+		if (monsters) monsters[m_count] = oid;
+		m_count++;
+	}
+
+	return m_count;
+}
+
+/*
+ * Display known monsters.
+ */
+static void do_cmd_knowledge_monsters(const char *name, int row)
+{
+	/* The view is already sorted */
+	group_funcs r_funcs = {N_ELEMENTS(monster_group), FALSE, race_name,
+							NULL, default_group, mon_summary};
+
+	member_funcs m_funcs = {display_monster, mon_lore, m_xchar, m_xattr, recall_prompt, 0, 0};
+
+	int *monsters;
+	int m_count;
+
+	monster_view_build();
+	monsters = C_ZNEW(monster_view.count, int);
+	m_count = collect_known_monsters(monsters);
+
+	default_join = monster_view.join;
 	display_knowledge("monsters", monsters, m_count, r_funcs, m_funcs,
 			"                   Sym  Kills");
-	FREE(default_join);
+	default_join = NULL;
 	FREE(monsters);
 }
 
@@ -1403,11 +1503,18 @@ static void get_artifact_display_name(char *o_name, size_t namelen, int a_idx)
 static void display_artifact(int col, int row, bool cursor, int oid)
 {
 	byte attr = curs_attrs[CURS_KNOWN][(int)cursor];
-	char o_name[80];
+	const char *name = row_name_get(oid);
 
-	get_artifact_display_name(o_name, sizeof o_name, oid);
+	if (!name)
+	{
+		char o_name[80];
 
-	c_prt(attr, o_name, row, col);
+		get_artifact_display_name(o_name, sizeof o_name, oid);
+		row_name_set(oid, o_name);
+		name = row_name_get(oid);
+	}
+
+	c_prt(attr, name ? name : "", row, col);
 }
 
 static object_type *find_artifact(struct artifact *artifact)
@@ -1501,11 +1608,51 @@ static int a_cmp_tval(const void *a, const void *b)
 static const char *kind_name(int gid) { return object_text_order[gid].name; }
 static int art2gid(int oid) { return obj_group_order[a_info[oid].tval]; }
 
-/* Check if the given artifact idx is something we should "Know" about */
-static bool artifact_is_known(int a_idx)
+/*
+ * Find where every artifact currently is in one pass over the object list,
+ * the inventory and the stores, in the same order find_artifact() looks.
+ * The caller frees the result.
+ */
+static object_type **locate_artifacts(void)
 {
+	object_type **where = C_ZNEW(z_info->a_max, object_type *);
 	object_type *o_ptr;
+	int i;
+	struct store *s;
+
+	for (i = 0; i < z_info->o_max; i++)
+	{
+		o_ptr = object_byid(i);
+		if (o_ptr->artifact && !where[o_ptr->artifact->aidx])
+			where[o_ptr->artifact->aidx] = o_ptr;
+	}
+
+	for (i = 0; i < INVEN_TOTAL; i++)
+	{
+		o_ptr = &p_ptr->inventory[i];
+		if (o_ptr->artifact && !where[o_ptr->artifact->aidx])
+			where[o_ptr->artifact->aidx] = o_ptr;
+	}
 
+	for (s = stores; s; s = s->next)
+	{
+		for (i = 0; i < s->stock_size; i++)
+		{
+			o_ptr = &s->stock[i];
+			if (o_ptr->artifact && !where[o_ptr->artifact->aidx])
+				where[o_ptr->artifact->aidx] = o_ptr;
+		}
+	}
+
+	return where;
+}
+
+/*
+ * Check if the given artifact idx is something we should "Know" about,
+ * given where it is (NULL if it isn't anywhere).
+ */
+static bool artifact_is_known_at(int a_idx, const object_type *o_ptr)
+{
 	if (!a_info[a_idx].name)
 		return FALSE;
 
@@ -1515,31 +1662,102 @@ static bool artifact_is_known(int a_idx)
 	if (!a_info[a_idx].created)
 		return FALSE;
 
-	/* Check all objects to see if it exists but hasn't been IDed */
-	o_ptr = find_artifact(&a_info[a_idx]);
+	/* It exists but hasn't been IDed */
 	if (o_ptr && !object_is_known_artifact(o_ptr))
 		return FALSE;
 
 	return TRUE;
 }
 
+/* Check if the given artifact idx is something we should "Know" about */
+static bool artifact_is_known(int a_idx)
+{
+	if (!a_info[a_idx].name || p_ptr->wizard || !a_info[a_idx].created)
+		return artifact_is_known_at(a_idx, NULL);
+
+	return artifact_is_known_at(a_idx, find_artifact(&a_info[a_idx]));
+}
+
+/* The artifact made from each special artifact kind, or -1 */
+static s16b *kind_artifact;
+
+/*
+ * Build the view of every artifact in display order, and the map from
+ * object kinds to their special artifacts.  Random artifacts change names
+ * and bases, so both are rebuilt whenever those change.
+ */
+static void artifact_view_build(void)
+{
+	know_view *v = &artifact_view;
+	u32b stamp = z_info->a_max;
+	int i;
+
+	for (i = 0; i < z_info->a_max; i++)
+	{
+		stamp = stamp_add(stamp, a_info[i].tval << 8 | a_info[i].sval);
+		stamp = stamp_add_str(stamp, a_info[i].name);
+	}
 
-/* If 'artifacts' is NULL, it counts the number of known artifacts, otherwise
-   it collects the list of known artifacts into 'artifacts' as well. */
+	if (v->built && v->stamp == stamp) return;
+
+	know_view_free(v);
+	v->order = C_ZNEW(z_info->a_max, int);
+
+	for (i = 0; i < z_info->a_max; i++)
+		if (a_info[i].name) v->order[v->count++] = i;
+
+	sort(v->order, v->count, sizeof(*v->order), a_cmp_tval);
+
+	/* Map special artifact kinds to the first artifact made from them */
+	FREE(kind_artifact);
+	kind_artifact = C_ZNEW(z_info->k_max, s16b);
+
+	for (i = 0; i < z_info->k_max; i++)
+	{
+		object_kind *kind = &k_info[i];
+		int j;
+
+		kind_artifact[i] = -1;
+		if (!of_has(kind->flags, OF_INSTA_ART)) continue;
+
+		for (j = 0; j < z_info->a_max; j++)
+		{
+			if (kind->tval == a_info[j].tval &&
+			    kind->sval == a_info[j].sval)
+			{
+				kind_artifact[i] = j;
+				break;
+			}
+		}
+	}
+
+	v->stamp = stamp;
+	v->built = TRUE;
+}
+
+
+/*
+ * If 'artifacts' is NULL, it counts the number of known artifacts, otherwise
+ * it collects the list of known artifacts into 'artifacts', in display order,
+ * as well.
+ */
 static int collect_known_artifacts(int *artifacts, size_t artifacts_len)
 {
 	int a_count = 0;
-	int j;
+	int i;
+	object_type **where;
 
 	if (artifacts)
 		assert(artifacts_len >= z_info->a_max);
 
-	for (j = 0; j < z_info->a_max; j++)
+	artifact_view_build();
+	where = locate_artifacts();
+
+	for (i = 0; i < artifact_view.count; i++)
 	{
-		/* Artifact doesn't exist */
-		if (!a_info[j].name) continue;
+		int j = artifact_view.order[i];
 
-		if (OPT(cheat_xtra) || artifact_is_known(j))
+		if (OPT(cheat_xtra) || artifact_is_known_at(j, where[j]))
 		{
 			if (artifacts)
 				artifacts[a_count++] = j;
@@ -1548,6 +1766,8 @@ static int collect_known_artifacts(int *artifacts, size_t artifacts_len)
 		}
 	}
 
+	FREE(where);
+
 	return a_count;
 }
 
@@ -1557,7 +1777,7 @@ static int collect_known_artifacts(int *artifacts, size_t artifacts_len)
 static void do_cmd_knowledge_artifacts(const char *name, int row)
 {
 	/* HACK -- should be TV_MAX */
-	group_funcs obj_f = {TV_GOLD, FALSE, kind_name, a_cmp_tval, art2gid, 0};
+	group_funcs obj_f = {TV_GOLD, FALSE, kind_name, NULL, art2gid, 0};
 	member_funcs art_f = {display_artifact, desc_art_fake, 0, 0, recall_prompt, 0, 0};
 
 	int *artifacts;
@@ -1565,10 +1785,12 @@ static void do_cmd_knowledge_artifacts(const char *name, int row)
 
 	artifacts = C_ZNEW(z_info->a_max, int);
 
-	/* Collect valid artifacts */
+	/* Collect valid artifacts, already sorted */
 	a_count = collect_known_artifacts(artifacts, z_info->a_max);
 
+	row_names_init(z_info->a_max);
 	display_knowledge("artifacts", artifacts, a_count, obj_f, art_f, NULL);
+	row_names_free();
 	FREE(artifacts);
 }
 
@@ -1622,45 +1844,75 @@ static int e_cmp_tval(const void *a, const void *b)
 	return strcmp(ea->name, eb->name);
 }
 
+/*
+ * Build the view of every (ego item, group) pair the ego menu could show.
+ * The order only depends on e_info, so it is built once.
+ */
+static void ego_view_build(void)
+{
+	know_view *v = &ego_view;
+	int i, j;
+
+	if (v->built) return;
+
+	/* HACK: currently no more than 3 tvals for one ego type */
+	v->order = C_ZNEW(z_info->e_max * EGO_TVALS_MAX, int);
+	v->join = C_ZNEW(z_info->e_max * EGO_TVALS_MAX, join_t);
+
+	for (i = 0; i < z_info->e_max; i++)
+	{
+		if (!e_info[i].name) continue;
+
+		for (j = 0; j < EGO_TVALS_MAX && e_info[i].tval[j]; j++)
+		{
+			int gid = obj_group_order[e_info[i].tval[j]];
+
+			/* Ignore duplicate gids */
+			if (j > 0 && gid == v->join[v->count - 1].gid) continue;
+
+			v->order[v->count] = v->count;
+			v->join[v->count].oid = i;
+			v->join[v->count++].gid = gid;
+		}
+	}
+
+	default_join = v->join;
+	sort(v->order, v->count, sizeof(*v->order), e_cmp_tval);
+	default_join = NULL;
+
+	v->built = TRUE;
+}
+
 /*
  * Display known ego_items
  */
 static void do_cmd_knowledge_ego_items(const char *name, int row)
 {
+	/* The view is already sorted */
 	group_funcs obj_f =
-		{TV_GOLD, FALSE, ego_grp_name, e_cmp_tval, default_group, 0};
+		{TV_GOLD, FALSE, ego_grp_name, NULL, default_group, 0};
 
 	member_funcs ego_f = {display_ego_item, desc_ego_fake, 0, 0, recall_prompt, 0, 0};
 
 	int *egoitems;
 	int e_count = 0;
-	int i, j;
+	int i;
 
-	/* HACK: currently no more than 3 tvals for one ego type */
-	egoitems = C_ZNEW(z_info->e_max * EGO_TVALS_MAX, int);
-	default_join = C_ZNEW(z_info->e_max * EGO_TVALS_MAX, join_t);
+	ego_view_build();
+	egoitems = C_ZNEW(ego_view.count, int);
 
-	for (i = 0; i < z_info->e_max; i++)
+	for (i = 0; i < ego_view.count; i++)
 	{
-		if (e_info[i].everseen || OPT(cheat_xtra))
-		{
-			for (j = 0; j < EGO_TVALS_MAX && e_info[i].tval[j]; j++)
-			{
-				int gid = obj_group_order[e_info[i].tval[j]];
-
-				/* Ignore duplicate gids */
-				if (j > 0 && gid == default_join[e_count - 1].gid) continue;
+		int oid = ego_view.order[i];
 
-				egoitems[e_count] = e_count;
-				default_join[e_count].oid = i;
-				default_join[e_count++].gid = gid;
-			}
-		}
+		if (e_info[ego_view.join[oid].oid].everseen || OPT(cheat_xtra))
+			egoitems[e_count++] = oid;
 	}
 
+	default_join = ego_view.join;
 	display_knowledge("ego items", egoitems, e_count, obj_f, ego_f, NULL);
+	default_join = NULL;
 
-	FREE(default_join);
 	FREE(egoitems);
 }
 
@@ -1674,22 +1926,13 @@ static void do_cmd_knowledge_ego_items(const char *name, int row)
  */
 static int get_artifact_from_kind(object_kind *kind)
 {
-	int i;
-
 	assert(of_has(kind->flags, OF_INSTA_ART));
 
 	/* Look for the corresponding artifact */
-	for (i = 0; i < z_info->a_max; i++)
-	{
-		if (kind->tval == a_info[i].tval &&
-		    kind->sval == a_info[i].sval)
-		{
-			break;
-		}
-	}
+	artifact_view_build();
 
-        assert(i < z_info->a_max);
-	return i;
+        assert(kind_artifact[kind->kidx] >= 0);
+	return kind_artifact[kind->kidx];
 }
 
 /*
@@ -1700,7 +1943,7 @@ static void display_object(int col, int row, bool cursor, int oid)
 	object_kind *kind = &k_info[oid];
 	const char *inscrip = get_autoinscription(kind);
 
-	char o_name[80];
+	const char *name = row_name_get(oid);
 
 	/* Choose a color */
 	bool aware = (!kind->flavor || kind->aware);
@@ -1712,18 +1955,26 @@ static void display_object(int col, int row, bool cursor, int oid)
 	byte a = use_flavour ? kind->flavor->x_attr : kind->x_attr;
 	wchar_t c = use_flavour ? kind->flavor->x_char : kind->x_char;
 
-	/* Display known artifacts differently */
-	if (of_has(kind->flags, OF_INSTA_ART) && artifact_is_known(get_artifact_from_kind(kind)))
-		get_artifact_display_name(o_name, sizeof(o_name), get_artifact_from_kind(kind));
-	else
- 		object_kind_name(o_name, sizeof(o_name), kind, OPT(cheat_xtra));
+	if (!name)
+	{
+		char o_name[80];
 
-	/* If the type is "tried", display that */
-	if (kind->tried && !aware)
-		my_strcat(o_name, " {tried}", sizeof(o_name));
+		/* Display known artifacts differently */
+		if (of_has(kind->flags, OF_INSTA_ART) && artifact_is_known(get_artifact_from_kind(kind)))
+			get_artifact_display_name(o_name, sizeof(o_name), get_artifact_from_kind(kind));
+		else
+			object_kind_name(o_name, sizeof(o_name), kind, OPT(cheat_xtra));
+
+		/* If the type is "tried", display that */
+		if (kind->tried && !aware)
+			my_strcat(o_name, " {tried}", sizeof(o_name));
+
+		row_name_set(oid, o_name);
+		name = row_name_get(oid);
+	}
 
 	/* Display the name */
-	c_prt(attr, o_name, row, col);
+	c_prt(attr, name ? name : "", row, col);
 
 	/* Show squelch status */
 	if ((aware && kind_is_squelched_aware(kind)) ||
@@ -1937,39 +2188,86 @@ static void o_xtra_act(struct keypress ch, int oid)
 
 
 
+/*
+ * Build the view of every object kind in display order.  Unaware and tried
+ * kinds sort differently, so the view is rebuilt when either changes.
+ */
+static void kind_view_build(void)
+{
+	know_view *v = &kind_view;
+	u32b stamp = z_info->k_max;
+	int i;
+
+	for (i = 0; i < z_info->k_max; i++)
+	{
+		object_kind *kind = &k_info[i];
+
+		stamp = stamp_add(stamp, (kind->aware ? 2 : 0) | (kind->tried ? 1 : 0));
+		if (kind->flavor) stamp = stamp_add(stamp, kind->flavor->fidx);
+	}
+
+	if (v->built && v->stamp == stamp) return;
+
+	know_view_free(v);
+	v->order = C_ZNEW(z_info->k_max, int);
+
+	for (i = 0; i < z_info->k_max; i++)
+		if (obj_group_order[k_info[i].tval] >= 0) v->order[v->count++] = i;
+
+	sort(v->order, v->count, sizeof(*v->order), o_cmp_tval);
+
+	v->stamp = stamp;
+	v->built = TRUE;
+}
+
 /*
  * Display known objects
  */
 void textui_browse_object_knowledge(const char *name, int row)
 {
-	group_funcs kind_f = {TV_GOLD, FALSE, kind_name, o_cmp_tval, obj2gid, 0};
+	/* The view is already sorted */
+	group_funcs kind_f = {TV_GOLD, FALSE, kind_name, NULL, obj2gid, 0};
 	member_funcs obj_f = {display_object, desc_obj_fake, o_xchar, o_xattr, o_xtra_prompt, o_xtra_act, 0};
 
 	int *objects;
 	int o_count = 0;
 	int i;
 	object_kind *kind;
+	object_type **where;
+
+	kind_view_build();
+	artifact_view_build();
+	where = locate_artifacts();
 
 	objects = C_ZNEW(z_info->k_max, int);
 
-	for (i = 0; i < z_info->k_max; i++)
+	for (i = 0; i < kind_view.count; i++)
 	{
-		kind = &k_info[i];
+		int k_idx = kind_view.order[i];
+
+		kind = &k_info[k_idx];
 		/* It's in the list if we've ever seen it, or it has a flavour,
 		 * and either it's not one of the special artifacts, or if it is,
 		 * we're not aware of it yet. This way the flavour appears in the list
 		 * until it is found.
 		 */
-		if ((kind->everseen || kind->flavor || OPT(cheat_xtra)) &&
-				(!of_has(kind->flags, OF_INSTA_ART) ||
-				 !artifact_is_known(get_artifact_from_kind(kind))))
+		if (kind->everseen || kind->flavor || OPT(cheat_xtra))
 		{
-			int c = obj_group_order[k_info[i].tval];
-			if (c >= 0) objects[o_count++] = i;
+			if (of_has(kind->flags, OF_INSTA_ART))
+			{
+				int a_idx = get_artifact_from_kind(kind);
+				if (artifact_is_known_at(a_idx, where[a_idx])) continue;
+			}
+
+			objects[o_count++] = k_idx;
 		}
 	}
 
+	FREE(where);
+
+	row_names_init(z_info->k_max);
 	display_knowledge("known objects", objects, o_count, kind_f, obj_f, "Squelch  Inscribed          Sym");
+	row_names_free();
 
 	FREE(objects);
 }
@@ -2138,6 +2436,12 @@ static menu_type knowledge_menu;
 /* Keep macro counts happy. */
 static void cleanup_cmds(void) {
 	mem_free(obj_group_order);
+
+	know_view_free(&monster_view);
+	know_view_free(&artifact_view);
+	know_view_free(&ego_view);
+	know_view_free(&kind_view);
+	FREE(kind_artifact);
 }
 
 void textui_knowledge_init(void)
@@ -2198,7 +2502,7 @@ void textui_browse_knowledge(void)
 		}
 	}
 
-	if (count_known_monsters() > 0)
+	if (collect_known_monsters(NULL) > 0)
 		knowledge_actions[3].flags = 0;
 	else
 		knowledge_actions[3].flags = MN_ACT_GRAYED;
@@ -87,22 +87,23 @@ bool region_inside(const region *loc, const ui_event *key)
  */
 
 /* Utility function */
-static void display_area(const wchar_t *text, const byte *attrs,
-		size_t *line_starts, size_t *line_lengths,
-		size_t n_lines,
+static void display_area(textblock *tb, size_t n_lines,
 		region area, size_t line_from)
 {
+	struct textblock_line line;
 	size_t i, j;
 
 	n_lines = MIN(n_lines, (size_t) area.page_rows);
 
 	for (i = 0; i < n_lines; i++) {
 		Term_erase(area.col, area.row + i, area.width);
-		for (j = 0; j < line_lengths[line_from + i]; j++) {
-			Term_putch(area.col + j, area.row + i,
-					attrs[line_starts[line_from + i] + j],
-					text[line_starts[line_from + i] + j]);
-		}
+
+		if (!textblock_line(tb, area.width, line_from + i, &line))
+			continue;
+
+		for (j = 0; j < line.len; j++)
+			Term_putch(area.col + j, area.row + i, line.attrs[j],
+					line.text[j]);
 	}
 }
 
@@ -114,11 +115,7 @@ void textui_textblock_place(textblock *tb, region orig_area, const char *header)
 	/* xxx on resize this should be recalculated */
 	region area = region_calculate(orig_area);
 
-	size_t *line_starts = NULL, *line_lengths = NULL;
-	size_t n_lines;
-
-	n_lines = textblock_calculate_lines(tb,
-			&line_starts, &line_lengths, area.width);
+	size_t n_lines = textblock_lines(tb, area.width);
 
 	if (header != NULL) {
 		area.page_rows--;
@@ -129,11 +126,7 @@ void textui_textblock_place(textblock *tb, region orig_area, const char *header)
 	if (n_lines > (size_t) area.page_rows)
 		n_lines = area.page_rows;
 
-	display_area(textblock_text(tb), textblock_attrs(tb), line_starts,
-	             line_lengths, n_lines, area, 0);
-
-	mem_free(line_starts);
-	mem_free(line_lengths);
+	display_area(tb, n_lines, area, 0);
 }
 
 /*
@@ -144,11 +137,7 @@ void textui_textblock_show(textblock *tb, region orig_area, const char *header)
 	/* xxx on resize this should be recalculated */
 	region area = region_calculate(orig_area);
 
-	size_t *line_starts = NULL, *line_lengths = NULL;
-	size_t n_lines;
-
-	n_lines = textblock_calculate_lines(tb,
-			&line_starts, &line_lengths, area.width);
+	size_t n_lines = textblock_lines(tb, area.width);
 
 	screen_save();
 
@@ -172,8 +161,7 @@ void textui_textblock_show(textblock *tb, region orig_area, const char *header)
 		while (1) {
 			struct keypress ch;
 
-			display_area(textblock_text(tb), textblock_attrs(tb), line_starts,
-					line_lengths, n_lines, area, start_line);
+			display_area(tb, n_lines, area, start_line);
 
 			ch = inkey();
 			if (ch.code == ARROW_UP)
@@ -191,8 +179,7 @@ void textui_textblock_show(textblock *tb, region orig_area, const char *header)
 				start_line = n_lines - area.page_rows;
 		}
 	} else {
-		display_area(textblock_text(tb), textblock_attrs(tb), line_starts,
-				line_lengths, n_lines, area, 0);
+		display_area(tb, n_lines, area, 0);
 
 		c_prt(TERM_WHITE, "", area.row + n_lines, area.col);
 		c_prt(TERM_L_BLUE, "(Press any key to continue.)",
@@ -200,9 +187,6 @@ void textui_textblock_show(textblock *tb, region orig_area, const char *header)
 		inkey();
 	}
 
-	mem_free(line_starts);
-	mem_free(line_lengths);
-
 	screen_load();
 
 	return;
@@ -252,6 +252,9 @@ ui_event inkey_ex(void)
 			/* Hack -- activate proper term */
 			Term_activate(old);
 
+			/* Deliver any redraws still held back */
+			event_flush();
+
 			/* Flush output */
 			Term_fresh();
 
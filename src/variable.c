@@ -41,6 +41,7 @@ const char *copyright =
  */
 bool arg_wizard;			/* Command arg -- Request wizard mode */
 bool arg_rebalance;			/* Command arg -- Rebalance monsters */
+bool arg_journal;			/* Command arg -- Record a command journal */
 int arg_graphics;			/* Command arg -- Request graphics mode */
 bool arg_graphics_nice;			/* Command arg -- Request nice graphics mode */
 
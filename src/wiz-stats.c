@@ -2122,6 +2122,9 @@ static void clearing_stats(void)
 			
 			/* regen randarts */
 			do_randart(seed_randart,TRUE);
+
+			/* artifact names have changed */
+			object_desc_invalidate();
 		
 		}
 		
@@ -2574,6 +2577,70 @@ void disconnect_stats(void)
 }
 
 
+/* Running totals for level_stats() */
+struct level_totals {
+	int levels;
+	long objects, held, monsters, vaults;
+	int vault_levels;
+	int obj_feelings[11];
+	int mon_feelings[10];
+};
+
+static void level_stats_add(const struct level_summary *sum, void *data)
+{
+	struct level_totals *t = data;
+
+	t->levels++;
+	t->objects += sum->objects;
+	t->held += sum->held;
+	t->monsters += sum->monsters;
+	t->vaults += sum->vaults;
+	if (sum->vaults) t->vault_levels++;
+
+	t->obj_feelings[MIN(sum->obj_feeling, 10)]++;
+	t->mon_feelings[MIN(sum->mon_feeling, 9)]++;
+}
+
+/* Build a batch of levels off to the side and summarise them, leaving
+ * the current level alone
+ */
+void level_stats(void)
+{
+	struct level_totals totals;
+	char tmp_val[100];
+	int count = 100;
+	int depth;
+	int i;
+
+	strnfmt(tmp_val, sizeof(tmp_val), "%d", count);
+	if (!get_string("Num of levels: ", tmp_val, 7)) return;
+	count = atoi(tmp_val);
+	if (count < 1) count = 1;
+
+	strnfmt(tmp_val, sizeof(tmp_val), "%d", p_ptr->depth);
+	if (!get_string("Depth: ", tmp_val, 7)) return;
+	depth = atoi(tmp_val);
+	if (depth < 1) depth = 1;
+	if (depth > MAX_DEPTH - 1) depth = MAX_DEPTH - 1;
+
+	WIPE(&totals, struct level_totals);
+	generate_levels(depth, count, level_stats_add, &totals);
+
+	msg("%d levels at depth %d:", totals.levels, depth);
+	msg("Average objects %ld (+%ld carried), monsters %ld.",
+		totals.objects / totals.levels, totals.held / totals.levels,
+		totals.monsters / totals.levels);
+	msg("Vaults: %ld on %d levels.", totals.vaults, totals.vault_levels);
+
+	for (i = 1; i < 11; i++)
+		if (totals.obj_feelings[i])
+			msg("Object feeling %d: %d levels.", i, totals.obj_feelings[i]);
+	for (i = 1; i < 10; i++)
+		if (totals.mon_feelings[i])
+			msg("Monster feeling %d: %d levels.", i, totals.mon_feelings[i]);
+}
+
+
 #else /* USE_STATS */
 
 void stats_collect(void)
@@ -2590,4 +2657,9 @@ void pit_stats(void)
 {
 	msg("Statistics generation not turned on in this build.");
 }
+
+void level_stats(void)
+{
+	msg("Statistics generation not turned on in this build.");
+}
 #endif /* USE_STATS */
@@ -1724,6 +1724,13 @@ void do_cmd_debug(void)
 			break;
 		}
 
+		/* Level feeling stats */
+		case 'F':
+		{
+			level_stats();
+			break;
+		}
+
 		/* Good Objects */
 		case 'g':
 		{
@@ -8,6 +8,7 @@ extern void do_cmd_debug(void);
 void stats_collect(void);
 void disconnect_stats(void);
 void pit_stats(void);
+void level_stats(void);
 
 /* wiz-spoil.c */
 void do_cmd_spoilers(void);
@@ -1821,10 +1821,16 @@ static void ui_enter_game(game_event_type type, game_event_data *data, void *use
 	/* Check if the panel should shift when the player's moved */
 	event_add_handler(EVENT_PLAYERMOVED, check_panel, NULL);
 	event_add_handler(EVENT_SEEFLOOR, see_floor_items, NULL);
+
+	/* Merge redraw requests between screen updates */
+	event_set_coalescing(TRUE);
 }
 
 static void ui_leave_game(game_event_type type, game_event_data *data, void *user)
 {
+	/* Deliver any held-back redraws while the handlers are still here */
+	event_set_coalescing(FALSE);
+
 	/* Because of the "flexible" sidebar, all these things trigger
 	   the same function. */
 	event_remove_handler_set(player_events, N_ELEMENTS(player_events),
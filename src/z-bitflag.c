@@ -19,44 +19,57 @@
 #include "z-bitflag.h"
 
 
-/**
- * Tests if a flag is "on" in a bitflag set.
- *
- * TRUE is returned when `flag` is on in `flags`, and FALSE otherwise.
- * The flagset size is supplied in `size`.
+/*
+ * Bit scanning and counting, using the compiler's builtins where there are
+ * any.
  */
-bool flag_has(const bitflag *flags, const size_t size, const int flag)
-{
-	const size_t flag_offset = FLAG_OFFSET(flag);
-	const int flag_binary = FLAG_BINARY(flag);
+#if defined(__GNUC__)
 
-	if (flag == FLAG_END) return FALSE;
+#define byte_ctz(b)	__builtin_ctz(b)
+#ifdef HAVE_STDINT_H
+#define word_popcount(w)	__builtin_popcountll(w)
+#else
+#define word_popcount(w)	__builtin_popcountl(w)
+#endif
 
-	assert(flag_offset < size);
+#else
 
-	if (flags[flag_offset] & flag_binary) return TRUE;
+static int byte_ctz(unsigned int b)
+{
+	int n = 0;
 
-	return FALSE;
+	while (!(b & 1)) {
+		b >>= 1;
+		n++;
+	}
+
+	return n;
 }
 
-bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag, const char *fi, const char *fl)
+static int word_popcount(flag_word w)
 {
-	const size_t flag_offset = FLAG_OFFSET(flag);
-	const int flag_binary = FLAG_BINARY(flag);
+	int n = 0;
 
-	if (flag == FLAG_END) return FALSE;
-
-	if (flag_offset >= size)
-	{
-		quit_fmt("Error in flag_has(%s, %s): FlagID[%d] Size[%u] FlagOff[%u] FlagBV[%d]\n",
-		         fi, fl, flag, (unsigned int) size, (unsigned int) flag_offset, flag_binary);
+	while (w) {
+		w &= w - 1;
+		n++;
 	}
 
-	assert(flag_offset < size);
+	return n;
+}
+
+#endif
 
-	if (flags[flag_offset] & flag_binary) return TRUE;
 
-	return FALSE;
+/**
+ * Reports a flag outside the bounds of its bitfield, for flag_has_dbg() and
+ * flag_on_dbg().
+ */
+void flag_bounds_error(const char *fn, const char *fi, const char *fl, int flag, size_t size)
+{
+	quit_fmt("Error in %s(%s, %s): FlagID[%d] Size[%u] FlagOff[%u] FlagBV[%d]\n",
+	         fn, fi, fl, flag, (unsigned int) size,
+	         (unsigned int) FLAG_OFFSET(flag), FLAG_BINARY(flag));
 }
 
 
@@ -70,35 +83,53 @@ bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag, const
  */
 int flag_next(const bitflag *flags, const size_t size, const int flag)
 {
-	const int max_flags = FLAG_MAX(size);
-	int f, flag_offset, flag_binary;
+	/* Bit offset of the flag, counted from FLAG_START */
+	const unsigned int f = (flag < FLAG_START) ? 0 : flag - FLAG_START;
+	size_t i;
+	unsigned int b;
 
-	for (f = flag; f < max_flags; f++)
-	{
-		flag_offset = FLAG_OFFSET(f);
-		flag_binary = FLAG_BINARY(f);
+	if (f >= size * FLAG_WIDTH) return FLAG_END;
 
-		if (flags[flag_offset] & flag_binary) return f;
-	}
+	/* The flag itself, then the rest of its byte */
+	i = f / FLAG_WIDTH;
+	b = flags[i] >> (f % FLAG_WIDTH);
+	if (b & 1) return FLAG_START + (int) f;
+	if (b) return FLAG_START + (int) f + byte_ctz(b);
+
+	/* The rest of the word; in dense sets the next flag is usually here */
+	for (i++; i < size && i % FLAG_WORD_BYTES; i++)
+		if (flags[i])
+			return FLAG_START + (int) (i * FLAG_WIDTH) + byte_ctz(flags[i]);
+
+	/* Skip empty words, then find the first byte with something in it */
+	for (; i + FLAG_WORD_BYTES <= size; i += FLAG_WORD_BYTES)
+		if (flag_word_load(flags + i, FLAG_WORD_BYTES)) break;
+
+	for (; i < size; i++)
+		if (flags[i])
+			return FLAG_START + (int) (i * FLAG_WIDTH) + byte_ctz(flags[i]);
 
 	return FLAG_END;
 }
 
 
 /**
- * Tests a bitfield for emptiness.
+ * Counts the flags which are "on" in a bitflag set.
  *
- * TRUE is returned when no flags are set in `flags`, and FALSE otherwise.
  * The bitfield size is supplied in `size`.
  */
-bool flag_is_empty(const bitflag *flags, const size_t size)
+int flag_count(const bitflag *flags, const size_t size)
 {
-	size_t i;
+	size_t i, n;
+	int count = 0;
 
-	for (i = 0; i < size; i++)
-		if (flags[i] > 0) return FALSE;
+	/* Words here must not overlap, or flags would be counted twice */
+	for (i = 0; i < size; i += n) {
+		n = (size - i < FLAG_WORD_BYTES) ? size - i : FLAG_WORD_BYTES;
+		count += word_popcount(flag_word_load(flags + i, n));
+	}
 
-	return TRUE;
+	return count;
 }
 
 
@@ -119,40 +150,6 @@ bool flag_is_full(const bitflag *flags, const size_t size)
 }
 
 
-/**
- * Tests two bitfields for intersection.
- *
- * TRUE is returned when any flag is set in both `flags1` and `flags2`, and
- * FALSE otherwise. The size of the bitfields is supplied in `size`.
- */
-bool flag_is_inter(const bitflag *flags1, const bitflag *flags2, const size_t size)
-{
-	size_t i;
-
-	for (i = 0; i < size; i++)
-		if (flags1[i] & flags2[i]) return TRUE;
-
-	return FALSE;
-}
-
-
-/**
- * Test if one bitfield is a subset of another.
- *
- * TRUE is returned when every set flag in `flags2` is also set in `flags1`,
- * and FALSE otherwise. The size of the bitfields is supplied in `size`.
- */
-bool flag_is_subset(const bitflag *flags1, const bitflag *flags2, const size_t size)
-{
-	size_t i;
-
-	for (i = 0; i < size; i++)
-		if (~flags1[i] & flags2[i]) return FALSE;
-
-	return TRUE;
-}
-
-
 /**
  * Tests two bitfields for equality.
  *
@@ -165,70 +162,6 @@ bool flag_is_equal(const bitflag *flags1, const bitflag *flags2, const size_t si
 }
 
 
-/**
- * Sets one bitflag in a bitfield.
- *
- * The bitflag identified by `flag` is set in `flags`. The bitfield size is
- * supplied in `size`.  TRUE is returned when changes were made, FALSE
- * otherwise.
- */
-bool flag_on(bitflag *flags, const size_t size, const int flag)
-{
-	const size_t flag_offset = FLAG_OFFSET(flag);
-	const int flag_binary = FLAG_BINARY(flag);
-
-	assert(flag_offset < size);
-
-	if (flags[flag_offset] & flag_binary) return FALSE;
-
-	flags[flag_offset] |= flag_binary;
-
-	return TRUE;
-}
-
-bool flag_on_dbg(bitflag *flags, const size_t size, const int flag, const char *fi, const char *fl)
-{
-	const size_t flag_offset = FLAG_OFFSET(flag);
-	const int flag_binary = FLAG_BINARY(flag);
-
-	if (flag_offset >= size)
-	{
-		quit_fmt("Error in flag_on(%s, %s): FlagID[%d] Size[%u] FlagOff[%u] FlagBV[%d]\n",
-		         fi, fl, flag, (unsigned int) size, (unsigned int) flag_offset, flag_binary);
-	}
-
-	assert(flag_offset < size);
-
-	if (flags[flag_offset] & flag_binary) return FALSE;
-
-	flags[flag_offset] |= flag_binary;
-
-	return TRUE;
-}
-
-
-/**
- * Clears one flag in a bitfield.
- *
- * The bitflag identified by `flag` is cleared in `flags`. The bitfield size
- * is supplied in `size`.  TRUE is returned when changes were made, FALSE
- * otherwise.
- */
-bool flag_off(bitflag *flags, const size_t size, const int flag)
-{
-	const size_t flag_offset = FLAG_OFFSET(flag);
-	const int flag_binary = FLAG_BINARY(flag);
-
-	assert(flag_offset < size);
-
-	if (!(flags[flag_offset] & flag_binary)) return FALSE;
-
-	flags[flag_offset] &= ~flag_binary;
-
-	return TRUE;
-}
-
-
 /**
  * Clears all flags in a bitfield.
  *
@@ -277,30 +210,6 @@ void flag_copy(bitflag *flags1, const bitflag *flags2, const size_t size)
 }
 
 
-/**
- * Computes the union of two bitfields.
- *
- * For every set flag in `flags2`, the corresponding flag is set in `flags1`.
- * The size of the bitfields is supplied in `size`. TRUE is returned when
- * changes were made, and FALSE otherwise.
- */
-bool flag_union(bitflag *flags1, const bitflag *flags2, const size_t size)
-{
-	size_t i;
-	bool delta = FALSE;
-
-	for (i = 0; i < size; i++)
-	{
-		/* !flag_is_subset() */
-		if (~flags1[i] & flags2[i]) delta = TRUE;
-
-		flags1[i] |= flags2[i];
-	}
-
-	return delta;
-}
-
-
 /**
  * Computes the union of one bitfield and the complement of another.
  *
@@ -310,73 +219,30 @@ bool flag_union(bitflag *flags1, const bitflag *flags2, const size_t size)
  */
 bool flag_comp_union(bitflag *flags1, const bitflag *flags2, const size_t size)
 {
-	size_t i;
-	bool delta = FALSE;
-
-	for (i = 0; i < size; i++)
-	{
-		/* no equivalent fn */
-		if (!(~flags1[i] & ~flags2[i])) delta = TRUE;
-
-		flags1[i] |= ~flags2[i];
-	}
-
-	return delta;
-}
-
-
-/**
- * Computes the intersection of two bitfields.
- *
- * For every unset flag in `flags2`, the corresponding flag is cleared in
- * `flags1`. The size of the bitfields is supplied in `size`. TRUE is returned
- * when changes were made, and FALSE otherwise.
- */
-bool flag_inter(bitflag *flags1, const bitflag *flags2, const size_t size)
-{
-	size_t i;
-	bool delta = FALSE;
-
-	for (i = 0; i < size; i++)
-	{
-		/* !flag_is_equal() */
-		if (!(flags1[i] == flags2[i])) delta = TRUE;
+	const size_t n = FLAG_WORD_LEN(size);
+	size_t i, at;
+	flag_word delta = 0, mask = 0;
 
-		flags1[i] &= flags2[i];
-	}
-
-	return delta;
-
-}
+	/* Only the bytes that are really there can change */
+	memset(&mask, 255, n);
 
+	for (i = 0; i < size; i += n) {
+		flag_word w1, w2;
 
-/**
- * Computes the difference of two bitfields.
- *
- * For every set flag in `flags2`, the corresponding flag is cleared in
- * `flags1`. The size of the bitfields is supplied in `size`. TRUE is returned
- * when changes were made, and FALSE otherwise.
- */
-bool flag_diff(bitflag *flags1, const bitflag *flags2, const size_t size)
-{
-	size_t i;
-	bool delta = FALSE;
+		at = FLAG_WORD_AT(size, i, n);
+		w1 = flag_word_load(flags1 + at, n);
+		w2 = flag_word_load(flags2 + at, n);
 
-	for (i = 0; i < size; i++)
-	{
-		/* flag_is_inter() */
-		if (flags1[i] & flags2[i]) delta = TRUE;
+		/* no equivalent fn */
+		delta |= ~w1 & ~w2 & mask;
 
-		flags1[i] &= ~flags2[i];
+		flag_word_store(flags1 + at, w1 | ~w2, n);
 	}
 
-	return delta;
+	return delta ? TRUE : FALSE;
 }
 
 
-
-
-
 /**
  * Tests if any of multiple bitflags are set in a bitfield.
  *
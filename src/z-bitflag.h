@@ -49,25 +49,29 @@ typedef byte bitflag;
 #define FLAG_BINARY(id)   (1 << ((id) - FLAG_START) % FLAG_WIDTH)
 
 
-bool flag_has       (const bitflag *flags, const size_t size, const int flag);
-bool flag_has_dbg   (const bitflag *flags, const size_t size, const int flag, const char *fi, const char *fl);
+/*
+ * The set operations work a word at a time. Flag arrays are plain bytes with
+ * no particular alignment, so words are moved with memcpy(), which compilers
+ * turn into ordinary loads and stores.
+ */
+#ifdef HAVE_STDINT_H
+typedef u64b flag_word;
+#else
+typedef u32b flag_word;
+#endif
+
+#define FLAG_WORD_BYTES   sizeof(flag_word)
+
+
 int  flag_next      (const bitflag *flags, const size_t size, const int flag);
-bool flag_is_empty  (const bitflag *flags, const size_t size);
+int  flag_count     (const bitflag *flags, const size_t size);
 bool flag_is_full   (const bitflag *flags, const size_t size);
-bool flag_is_inter  (const bitflag *flags1, const bitflag *flags2, const size_t size);
-bool flag_is_subset (const bitflag *flags1, const bitflag *flags2, const size_t size);
 bool flag_is_equal  (const bitflag *flags1, const bitflag *flags2, const size_t size);
-bool flag_on        (bitflag *flags, const size_t size, const int flag);
-bool flag_on_dbg    (bitflag *flags, const size_t size, const int flag, const char *fi, const char *fl);
-bool flag_off       (bitflag *flags, const size_t size, const int flag);
 void flag_wipe      (bitflag *flags, const size_t size);
 void flag_setall    (bitflag *flags, const size_t size);
 void flag_negate    (bitflag *flags, const size_t size);
 void flag_copy      (bitflag *flags1, const bitflag *flags2, const size_t size);
-bool flag_union     (bitflag *flags1, const bitflag *flags2, const size_t size);
 bool flag_comp_union(bitflag *flags1, const bitflag *flags2, const size_t size);
-bool flag_inter     (bitflag *flags1, const bitflag *flags2, const size_t size);
-bool flag_diff      (bitflag *flags1, const bitflag *flags2, const size_t size);
 
 bool flags_test     (const bitflag *flags, const size_t size, ...);
 bool flags_test_all (const bitflag *flags, const size_t size, ...);
@@ -76,4 +80,276 @@ bool flags_set      (bitflag *flags, const size_t size, ...);
 void flags_init     (bitflag *flags, const size_t size, ...);
 bool flags_mask     (bitflag *flags, const size_t size, ...);
 
+void flag_bounds_error(const char *fn, const char *fi, const char *fl, int flag, size_t size);
+
+
+/*
+ * The rest are small and used in hot loops, so they are defined here to be
+ * inlined. The of_*, rf_*, rsf_* and ff_* macros pass sizes known at compile
+ * time, so each of these compiles down to a fixed handful of word operations
+ * for that flag set.
+ */
+
+/**
+ * Load `n` (at most FLAG_WORD_BYTES) bytes of a bitfield as a word.
+ */
+static inline flag_word flag_word_load(const bitflag *flags, size_t n)
+{
+	flag_word w = 0;
+
+	memcpy(&w, flags, n);
+	return w;
+}
+
+/**
+ * Store the first `n` bytes of a word into a bitfield.
+ */
+static inline void flag_word_store(bitflag *flags, flag_word w, size_t n)
+{
+	memcpy(flags, &w, n);
+}
+
+/* Bytes handled at a time in a bitfield of `size` bytes */
+#define FLAG_WORD_LEN(size) \
+	(((size) < FLAG_WORD_BYTES) ? (size) : FLAG_WORD_BYTES)
+
+/*
+ * Where the word covering byte `i` starts. The last word is moved back to end
+ * with the bitfield, overlapping the one before it; every operation here
+ * gives the same answer for a byte however many times it is visited.
+ */
+#define FLAG_WORD_AT(size, i, n) \
+	(((i) + (n) > (size)) ? (size) - (n) : (i))
+
+/**
+ * Tests if a flag is "on" in a bitflag set.
+ *
+ * TRUE is returned when `flag` is on in `flags`, and FALSE otherwise.
+ * The flagset size is supplied in `size`.
+ */
+static inline bool flag_has(const bitflag *flags, const size_t size, const int flag)
+{
+	if (flag == FLAG_END) return FALSE;
+
+	assert((size_t) FLAG_OFFSET(flag) < size);
+
+	return (flags[FLAG_OFFSET(flag)] & FLAG_BINARY(flag)) ? TRUE : FALSE;
+}
+
+static inline bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag, const char *fi, const char *fl)
+{
+	if (flag == FLAG_END) return FALSE;
+
+	/* flag_bounds_error() doesn't return, but the compiler can't tell */
+	if ((size_t) FLAG_OFFSET(flag) >= size) {
+		flag_bounds_error("flag_has", fi, fl, flag, size);
+		return FALSE;
+	}
+
+	return (flags[FLAG_OFFSET(flag)] & FLAG_BINARY(flag)) ? TRUE : FALSE;
+}
+
+/**
+ * Sets one bitflag in a bitfield.
+ *
+ * The bitflag identified by `flag` is set in `flags`. The bitfield size is
+ * supplied in `size`.  TRUE is returned when changes were made, FALSE
+ * otherwise.
+ */
+static inline bool flag_on(bitflag *flags, const size_t size, const int flag)
+{
+	const size_t flag_offset = FLAG_OFFSET(flag);
+	const int flag_binary = FLAG_BINARY(flag);
+
+	assert(flag_offset < size);
+
+	if (flags[flag_offset] & flag_binary) return FALSE;
+
+	flags[flag_offset] |= flag_binary;
+
+	return TRUE;
+}
+
+static inline bool flag_on_dbg(bitflag *flags, const size_t size, const int flag, const char *fi, const char *fl)
+{
+	const size_t flag_offset = FLAG_OFFSET(flag);
+	const int flag_binary = FLAG_BINARY(flag);
+
+	if (flag_offset >= size) {
+		flag_bounds_error("flag_on", fi, fl, flag, size);
+		return FALSE;
+	}
+
+	if (flags[flag_offset] & flag_binary) return FALSE;
+
+	flags[flag_offset] |= flag_binary;
+
+	return TRUE;
+}
+
+/**
+ * Clears one flag in a bitfield.
+ *
+ * The bitflag identified by `flag` is cleared in `flags`. The bitfield size
+ * is supplied in `size`.  TRUE is returned when changes were made, FALSE
+ * otherwise.
+ */
+static inline bool flag_off(bitflag *flags, const size_t size, const int flag)
+{
+	const size_t flag_offset = FLAG_OFFSET(flag);
+	const int flag_binary = FLAG_BINARY(flag);
+
+	assert(flag_offset < size);
+
+	if (!(flags[flag_offset] & flag_binary)) return FALSE;
+
+	flags[flag_offset] &= ~flag_binary;
+
+	return TRUE;
+}
+
+/**
+ * Tests a bitfield for emptiness.
+ *
+ * TRUE is returned when no flags are set in `flags`, and FALSE otherwise.
+ * The bitfield size is supplied in `size`.
+ */
+static inline bool flag_is_empty(const bitflag *flags, const size_t size)
+{
+	const size_t n = FLAG_WORD_LEN(size);
+	size_t i;
+
+	for (i = 0; i < size; i += n)
+		if (flag_word_load(flags + FLAG_WORD_AT(size, i, n), n)) return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * Tests two bitfields for intersection.
+ *
+ * TRUE is returned when any flag is set in both `flags1` and `flags2`, and
+ * FALSE otherwise. The size of the bitfields is supplied in `size`.
+ */
+static inline bool flag_is_inter(const bitflag *flags1, const bitflag *flags2, const size_t size)
+{
+	const size_t n = FLAG_WORD_LEN(size);
+	size_t i, at;
+
+	for (i = 0; i < size; i += n) {
+		at = FLAG_WORD_AT(size, i, n);
+		if (flag_word_load(flags1 + at, n) & flag_word_load(flags2 + at, n))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ * Test if one bitfield is a subset of another.
+ *
+ * TRUE is returned when every set flag in `flags2` is also set in `flags1`,
+ * and FALSE otherwise. The size of the bitfields is supplied in `size`.
+ */
+static inline bool flag_is_subset(const bitflag *flags1, const bitflag *flags2, const size_t size)
+{
+	const size_t n = FLAG_WORD_LEN(size);
+	size_t i, at;
+
+	for (i = 0; i < size; i += n) {
+		at = FLAG_WORD_AT(size, i, n);
+		if (~flag_word_load(flags1 + at, n) & flag_word_load(flags2 + at, n))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Computes the union of two bitfields.
+ *
+ * For every set flag in `flags2`, the corresponding flag is set in `flags1`.
+ * The size of the bitfields is supplied in `size`. TRUE is returned when
+ * changes were made, and FALSE otherwise.
+ */
+static inline bool flag_union(bitflag *flags1, const bitflag *flags2, const size_t size)
+{
+	const size_t n = FLAG_WORD_LEN(size);
+	size_t i, at;
+	flag_word delta = 0;
+
+	for (i = 0; i < size; i += n) {
+		flag_word w1, w2;
+
+		at = FLAG_WORD_AT(size, i, n);
+		w1 = flag_word_load(flags1 + at, n);
+		w2 = flag_word_load(flags2 + at, n);
+
+		/* !flag_is_subset() */
+		delta |= ~w1 & w2;
+
+		flag_word_store(flags1 + at, w1 | w2, n);
+	}
+
+	return delta ? TRUE : FALSE;
+}
+
+/**
+ * Computes the intersection of two bitfields.
+ *
+ * For every unset flag in `flags2`, the corresponding flag is cleared in
+ * `flags1`. The size of the bitfields is supplied in `size`. TRUE is returned
+ * when changes were made, and FALSE otherwise.
+ */
+static inline bool flag_inter(bitflag *flags1, const bitflag *flags2, const size_t size)
+{
+	const size_t n = FLAG_WORD_LEN(size);
+	size_t i, at;
+	flag_word delta = 0;
+
+	for (i = 0; i < size; i += n) {
+		flag_word w1, w2;
+
+		at = FLAG_WORD_AT(size, i, n);
+		w1 = flag_word_load(flags1 + at, n);
+		w2 = flag_word_load(flags2 + at, n);
+
+		/* !flag_is_equal() */
+		delta |= w1 ^ w2;
+
+		flag_word_store(flags1 + at, w1 & w2, n);
+	}
+
+	return delta ? TRUE : FALSE;
+}
+
+/**
+ * Computes the difference of two bitfields.
+ *
+ * For every set flag in `flags2`, the corresponding flag is cleared in
+ * `flags1`. The size of the bitfields is supplied in `size`. TRUE is returned
+ * when changes were made, and FALSE otherwise.
+ */
+static inline bool flag_diff(bitflag *flags1, const bitflag *flags2, const size_t size)
+{
+	const size_t n = FLAG_WORD_LEN(size);
+	size_t i, at;
+	flag_word delta = 0;
+
+	for (i = 0; i < size; i += n) {
+		flag_word w1, w2;
+
+		at = FLAG_WORD_AT(size, i, n);
+		w1 = flag_word_load(flags1 + at, n);
+		w2 = flag_word_load(flags2 + at, n);
+
+		/* flag_is_inter() */
+		delta |= w1 & w2;
+
+		flag_word_store(flags1 + at, w1 & ~w2, n);
+	}
+
+	return delta ? TRUE : FALSE;
+}
+
 #endif
@@ -423,6 +423,14 @@ bool file_close(ang_file *f)
 	return TRUE;
 }
 
+/*
+ * Flush any buffered output for a file.
+ */
+bool file_flush(ang_file *f)
+{
+	return fflush(f->fh) == 0;
+}
+
 
 
 /** Locking functions **/
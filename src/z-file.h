@@ -137,6 +137,14 @@ extern void (*file_open_hook)(const char *path, file_type ftype);
 bool file_close(ang_file *f);
 
 
+/**
+ * Write out any data buffered for the file handle `f`.
+ *
+ * Returns TRUE if successful, FALSE otherwise.
+ */
+bool file_flush(ang_file *f);
+
+
 /** File locking **/
 
 /**
@@ -32,13 +32,8 @@
  * as a few "special" sequences, including the "capilitization" sequences of
  * "%C" and "%S".
  *
- * Note that some "limitations" are enforced by the current implementation,
- * for example, no "format sequence" can exceed 100 characters, including any
- * "length" restrictions, and the result of combining and "format sequence"
- * with the relevent "arguments" must not exceed 1000 characters.
- *
- * These limitations could be fixed by stealing some of the code from,
- * say, "vsprintf()" and placing it into my "vstrnfmt()" function.
+ * Note that floats and pointers are still formatted by "sprintf()", so
+ * their width and precision are limited to 200 characters.
  *
  * Legal format characters: %,b,n,p,c,s,d,i,o,u,X,x,E,e,F,f,G,g,r,v.
  *
@@ -128,475 +123,736 @@
 
 
 /*
- * Basic "vararg" format function.
- *
- * This function takes a buffer, a max byte count, a format string, and
- * a va_list of arguments to the format string, and uses the format string
- * and the arguments to create a string to the buffer.  The string is
- * derived from the format string and the arguments in the manner of the
- * "sprintf()" function, but with some extra "format" commands.  Note that
- * this function will never use more than the given number of bytes in the
- * buffer, preventing messy invalid memory references.  This function then
- * returns the total number of non-null bytes written into the buffer.
- *
- * Method: Let "str" be the (unlimited) created string, and let "len" be the
- * smaller of "max-1" and "strlen(str)".  We copy the first "len" chars of
- * "str" into "buf", place "\0" into buf[len], and return "len".
- *
- * In English, we do a sprintf() into "buf", a buffer with size "max",
- * and we return the resulting value of "strlen(buf)", but we allow some
- * special format commands, and we are more careful than "sprintf()".
- *
- * Typically, "max" is in fact the "size" of "buf", and thus represents
- * the "number" of chars in "buf" which are ALLOWED to be used.  An
- * alternative definition would have required "buf" to hold at least
- * "max+1" characters, and would have used that extra character only
- * in the case where "buf" was too short for the result.  This would
- * give an easy test for "overflow", but a less "obvious" semantics.
- *
- * Note that if the buffer was "too short" to hold the result, we will
- * always return "max-1", but we also return "max-1" if the buffer was
- * "just long enough".  We could have returned "max" if the buffer was
- * too short, not written a null, and forced the programmer to deal with
- * this special case, but I felt that it is better to at least give a
- * "usable" result when the buffer was too long instead of either giving
- * a memory overwrite like "sprintf()" or a non-terminted string like
- * "strncpy()".  Note that "strncpy()" also "null-pads" the result.
- *
- * Note that in most cases "just long enough" is probably "too short".
- *
- * We should also consider extracting and processing the "width" and other
- * "flags" by hand, it might be more "accurate", and it would allow us to
- * remove the limit (1000 chars) on the result of format sequences.
- *
- * Also, some sequences, such as "%+d" by hand, do not work on all machines,
- * and could thus be correctly handled here.
- *
- * Error detection in this routine is not very graceful, in particular,
- * if an error is detected in the format string, we simply "pre-terminate"
- * the given buffer to a length of zero, and return a "length" of zero.
- * The contents of "buf", except for "buf[0]", may then be undefined.
+ * Flags of a format sequence
  */
-size_t vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp)
-{
-	const char *s;
-	int i = 0, len = 0;
+#define FMT_LEFT   0x01	/* "-", left justify */
+#define FMT_PLUS   0x02	/* "+", always show the sign */
+#define FMT_SPACE  0x04	/* " ", space for a positive sign */
+#define FMT_ZERO   0x08	/* "0", pad numbers with zeros */
+#define FMT_ALT    0x10	/* "#", alternate form */
 
-	/* The argument is "long" */
-	bool do_long;
+/*
+ * Width or precision values which are not numbers
+ */
+#define FMT_NONE   -1	/* Not given */
+#define FMT_STAR   -2	/* Taken from the arguments ("*") */
 
-	/* Bytes used in buffer */
-	size_t n;
+/*
+ * Longest width or precision handed to sprintf() for floats and pointers
+ */
+#define FMT_LIBC_MAX 200
 
-	/* Bytes used in format sequence */
-	size_t q;
+/*
+ * One piece of a parsed format string: either a run of literal text, or
+ * a single format sequence.
+ */
+struct fmt_spec
+{
+	char conv;		/* Format character, or 0 for literal text */
+	byte flags;		/* FMT_* flags */
+	bool is_long;		/* An "l" was given */
+	int width;		/* Width, FMT_NONE or FMT_STAR */
+	int prec;		/* Precision, FMT_NONE or FMT_STAR */
 
-	/* Format sequence */
-	char aux[128];
+	const char *text;	/* Literal text */
+	size_t len;		/* Length of the literal text */
+};
 
-	/* Resulting string */
-	char tmp[1024];
+/*
+ * Where formatted output goes
+ */
+struct fmt_out
+{
+	char *buf;		/* The buffer */
+	size_t n;		/* Bytes used */
+	size_t end;		/* Bytes usable, leaving room for the terminator */
+};
 
-	assert(max);
-	assert(fmt);
 
-	/* Begin the buffer */
-	n = 0;
+/*
+ * Parse the literal text or format sequence at "s" into "spec".
+ *
+ * Returns the position after it, or NULL if the format sequence is bad.
+ */
+static const char *fmt_parse(const char *s, struct fmt_spec *spec)
+{
+	spec->conv = 0;
+	spec->flags = 0;
+	spec->is_long = FALSE;
+	spec->width = FMT_NONE;
+	spec->prec = FMT_NONE;
+
+	/* Literal text runs up to the next "%" */
+	if (*s != '%')
+	{
+		spec->text = s;
+		spec->len = strcspn(s, "%");
+		return s + spec->len;
+	}
+
+	/* Skip the "percent" */
+	s++;
 
-	/* Begin the format string */
-	s = fmt;
+	/* "%%" is a literal "%" */
+	if (*s == '%')
+	{
+		spec->text = s;
+		spec->len = 1;
+		return s + 1;
+	}
 
-	/* Scan the format string */
+	/* Flags */
 	while (TRUE)
 	{
-		type_union tval = END;
-
-		/* All done */
-		if (!*s) break;
+		if (*s == '-') spec->flags |= FMT_LEFT;
+		else if (*s == '+') spec->flags |= FMT_PLUS;
+		else if (*s == ' ') spec->flags |= FMT_SPACE;
+		else if (*s == '0') spec->flags |= FMT_ZERO;
+		else if (*s == '#') spec->flags |= FMT_ALT;
+		else break;
+		s++;
+	}
 
-		/* Normal character */
-		if (*s != '%')
-		{
-			/* Check total length */
-			if (n == max-1) break;
+	/* Width */
+	if (*s == '*')
+	{
+		spec->width = FMT_STAR;
+		s++;
+	}
+	else if (isdigit((unsigned char)*s))
+	{
+		spec->width = 0;
+		while (isdigit((unsigned char)*s))
+			spec->width = spec->width * 10 + (*s++ - '0');
+	}
 
-			/* Save the character */
-			buf[n++] = *s++;
+	/* Precision */
+	if (*s == '.')
+	{
+		s++;
+		spec->prec = 0;
 
-			/* Continue */
-			continue;
+		if (*s == '*')
+		{
+			spec->prec = FMT_STAR;
+			s++;
+		}
+		else
+		{
+			while (isdigit((unsigned char)*s))
+				spec->prec = spec->prec * 10 + (*s++ - '0');
 		}
+	}
 
-		/* Skip the "percent" */
+	/* Hack -- handle "long" request */
+	while (*s == 'l')
+	{
+		spec->is_long = TRUE;
 		s++;
+	}
 
-		/* Pre-process "%%" */
-		if (*s == '%')
+	/* The format character */
+	switch (*s)
+	{
+		case 'c': case 'd': case 'i': case 'u': case 'o': case 'x':
+		case 'X': case 'e': case 'E': case 'f': case 'F': case 'g':
+		case 'G': case 'p': case 's': case 'n':
 		{
-			/* Check total length */
-			if (n == max-1) break;
+			break;
+		}
 
-			/* Save the percent */
-			buf[n++] = '%';
+		case 'y':
+		{
+			/* Error -- illegal type_union argument */
+			if (spec->is_long) return NULL;
+			break;
+		}
 
-			/* Skip the "%" */
-			s++;
+		/* Error -- illegal or missing format char */
+		default: return NULL;
+	}
 
-			/* Continue */
-			continue;
-		}
+	spec->conv = *s;
+	return s + 1;
+}
 
-		/* Pre-process "%n" */
-		if (*s == 'n')
-		{
-			size_t *arg;
 
-			/* Get the next argument */
-			arg = va_arg(vp, size_t *);
+/*
+ * Append "len" bytes of "str", as far as they fit.
+ */
+static void fmt_put(struct fmt_out *out, const char *str, size_t len)
+{
+	if (len > out->end - out->n) len = out->end - out->n;
+	memcpy(out->buf + out->n, str, len);
+	out->n += len;
+}
 
-			/* Save the current length */
-			(*arg) = n;
+/*
+ * Append "count" copies of "c", as far as they fit.
+ */
+static void fmt_pad(struct fmt_out *out, char c, size_t count)
+{
+	if (count > out->end - out->n) count = out->end - out->n;
+	memset(out->buf + out->n, c, count);
+	out->n += count;
+}
 
-			/* Skip the "n" */
-			s++;
+/*
+ * Append an integer in the format "conv" with the given width and
+ * precision.  "value" is its magnitude, and "negative" says whether it
+ * had a minus sign.
+ */
+static void fmt_integer(struct fmt_out *out, const struct fmt_spec *spec,
+		char conv, int width, int prec, unsigned long value, bool negative)
+{
+	static const char lower[] = "0123456789abcdef";
+	static const char upper[] = "0123456789ABCDEF";
 
-			/* Continue */
-			continue;
-		}
+	char digits[3 * sizeof(unsigned long) + 1];
+	char *d = digits + sizeof(digits);
+	size_t num, zeros = 0, total;
+	const char *prefix = "";
+	char sign = 0;
 
+	/* Digits, written backwards; the bases get their own loops */
+	switch (conv)
+	{
+		case 'o':
+			for (; value; value >>= 3) *--d = (char)('0' + (value & 7));
+			break;
 
-		/* Begin the "aux" string */
-		q = 0;
+		case 'x':
+			for (; value; value >>= 4) *--d = lower[value & 15];
+			break;
 
-		/* Save the "percent" */
-		aux[q++] = '%';
+		case 'X':
+			for (; value; value >>= 4) *--d = upper[value & 15];
+			break;
 
-		do_long = FALSE;
+		default:
+			for (; value; value /= 10) *--d = (char)('0' + value % 10);
+			break;
+	}
+	num = digits + sizeof(digits) - d;
 
-		/* Build the "aux" string */
-		while (TRUE)
-		{
-			/* Error -- format sequence is not terminated */
-			if (!*s)
-			{
-				/* Terminate the buffer */
-				buf[0] = '\0';
+	/* Zero has a digit unless the precision says otherwise */
+	if (!num && prec < 0) *--d = '0', num = 1;
 
-				/* Return "error" */
-				return (0);
-			}
+	/* Precision is the minimum number of digits */
+	if (prec >= 0 && (size_t)prec > num) zeros = prec - num;
 
-			/* Error -- format sequence may be too long */
-			if (q > 100)
-			{
-				/* Terminate the buffer */
-				buf[0] = '\0';
+	/* Signs, for signed conversions only */
+	if (conv == 'd' || conv == 'i')
+	{
+		if (negative) sign = '-';
+		else if (spec->flags & FMT_PLUS) sign = '+';
+		else if (spec->flags & FMT_SPACE) sign = ' ';
+	}
 
-				/* Return "error" */
-				return (0);
-			}
+	/* Alternate forms */
+	if (spec->flags & FMT_ALT)
+	{
+		if (conv == 'o' && !zeros && (!num || *d != '0'))
+			zeros = 1;
+		else if (conv == 'x' && num && *d != '0')
+			prefix = "0x";
+		else if (conv == 'X' && num && *d != '0')
+			prefix = "0X";
+	}
 
-			/* Handle "alphabetic" chars */
-			if (isalpha((unsigned char)*s))
-			{
-				/* Hack -- handle "long" request */
-				if (*s == 'l')
-				{
-					/* Save the character */
-					aux[q++] = *s++;
+	total = (sign ? 1 : 0) + strlen(prefix) + zeros + num;
 
-					/* Note the "long" flag */
-					do_long = TRUE;
-				}
+	/* Pad with zeros after the sign, or spaces before it */
+	if (width > 0 && (size_t)width > total && !(spec->flags & FMT_LEFT))
+	{
+		if ((spec->flags & FMT_ZERO) && prec < 0)
+			zeros += width - total;
+		else
+			fmt_pad(out, ' ', width - total);
+	}
 
-				/* Handle normal end of format sequence */
-				else
-				{
-					/* Save the character */
-					aux[q++] = *s++;
+	if (sign) fmt_put(out, &sign, 1);
+	fmt_put(out, prefix, strlen(prefix));
+	fmt_pad(out, '0', zeros);
+	fmt_put(out, d, num);
 
-					/* Stop processing the format sequence */
-					break;
-				}
-			}
+	/* Left justified */
+	if (width > 0 && (size_t)width > total && (spec->flags & FMT_LEFT))
+		fmt_pad(out, ' ', width - total);
+}
 
-			/* Handle "non-alphabetic" chars */
-			else
-			{
-				/* Hack -- Handle 'star' (for "variable length" argument) */
-				if (*s == '*')
-				{
-					int arg;
+/*
+ * Append "len" bytes of "str" padded to the given width.
+ */
+static void fmt_string(struct fmt_out *out, const struct fmt_spec *spec,
+		int width, const char *str, size_t len)
+{
+	size_t pad = (width > 0 && (size_t)width > len) ? width - len : 0;
 
-					/* Get the next argument */
-					arg = va_arg(vp, int);
+	if (!(spec->flags & FMT_LEFT)) fmt_pad(out, ' ', pad);
+	fmt_put(out, str, len);
+	if (spec->flags & FMT_LEFT) fmt_pad(out, ' ', pad);
+}
 
-					/* Hack -- append the "length" */
-					sprintf(aux + q, "%d", arg);
+/*
+ * Rebuild the format sequence for sprintf(), with the width and
+ * precision already known.
+ */
+static void fmt_libc_spec(char *aux, const struct fmt_spec *spec,
+		int width, int prec)
+{
+	char *a = aux;
 
-					/* Hack -- accept the "length" */
-					while (aux[q]) q++;
+	*a++ = '%';
+	if (spec->flags & FMT_LEFT) *a++ = '-';
+	if (spec->flags & FMT_PLUS) *a++ = '+';
+	if (spec->flags & FMT_SPACE) *a++ = ' ';
+	if (spec->flags & FMT_ZERO) *a++ = '0';
+	if (spec->flags & FMT_ALT) *a++ = '#';
 
-					/* Skip the "*" */
-					s++;
-				}
+	/* Keep the result of sprintf() inside its buffer */
+	if (width > FMT_LIBC_MAX) width = FMT_LIBC_MAX;
+	if (prec > FMT_LIBC_MAX) prec = FMT_LIBC_MAX;
 
-				/* Collect "normal" characters (digits, "-", "+", ".", etc) */
-				else
-				{
-					/* Save the character */
-					aux[q++] = *s++;
-				}
-			}
-		}
+	if (width > 0) a += sprintf(a, "%d", width);
+	if (prec >= 0) a += sprintf(a, ".%d", prec);
+
+	*a++ = (spec->conv == 'y') ? 'f' : spec->conv;
+	*a = '\0';
+}
+
+/*
+ * Append the result of one format sequence, taking its arguments from
+ * "vp".  Returns FALSE if the arguments can't be used.
+ */
+static bool fmt_apply(struct fmt_out *out, const struct fmt_spec *spec,
+		va_list *vp)
+{
+	type_union tval = END;
+	struct fmt_spec left;
+	int width = spec->width;
+	int prec = spec->prec;
+	char conv = spec->conv;
+
+	/* Literal text */
+	if (!conv)
+	{
+		fmt_put(out, spec->text, spec->len);
+		return TRUE;
+	}
 
+	/* Save the current length */
+	if (conv == 'n')
+	{
+		size_t *arg = va_arg(*vp, size_t *);
+		*arg = out->n;
+		return TRUE;
+	}
 
-		/* Terminate "aux" */
-		aux[q] = '\0';
+	/* Width and precision from the arguments */
+	if (width == FMT_STAR)
+	{
+		width = va_arg(*vp, int);
 
-		/* Clear "tmp" */
-		tmp[0] = '\0';
+		/* A negative width means left justification */
+		if (width < 0)
+		{
+			left = *spec;
+			left.flags |= FMT_LEFT;
+			spec = &left;
+			width = -width;
+		}
+	}
+	if (prec == FMT_STAR) prec = va_arg(*vp, int);
 
-		/* Parse a type_union */
-		if (aux[q-1] == 'y')
+	/* Parse a type_union */
+	if (conv == 'y')
+	{
+		tval = va_arg(*vp, type_union);
+
+		if (tval.t == T_CHAR) conv = 'c';
+		else if (tval.t == T_INT) conv = 'd';
+		else if (tval.t == T_FLOAT) conv = 'f';
+		else if (tval.t == T_STRING) conv = 's';
+		else return FALSE;
+	}
+
+	switch (conv)
+	{
+		/* Simple Character */
+		case 'c':
 		{
-			tval = va_arg(vp, type_union);
+			char arg = (char)(tval.t == T_END ? va_arg(*vp, int) : tval.u.c);
 
-			if (do_long)
+			/* A NUL is dropped, with any padding after it, as sprintf()
+			 * ended the text there */
+			if (!arg)
 			{
-				/* Error -- illegal type_union argument */
-				buf[0] = '\0';
-
-				/* Return "error" */
-				return (0);
+				if (!(spec->flags & FMT_LEFT) && width > 1)
+					fmt_pad(out, ' ', width - 1);
+				return TRUE;
 			}
 
-			/* Replace aux terminator with proper printf char */
-			if (tval.t == T_CHAR) aux[q-1] = 'c';
-			else if (tval.t == T_INT) aux[q-1] = 'd';
-			else if (tval.t == T_FLOAT) aux[q-1] = 'f';
-			else if (tval.t == T_STRING) aux[q-1] = 's';
+			fmt_string(out, spec, width, &arg, 1);
+			return TRUE;
+		}
+
+		/* Signed Integers */
+		case 'd': case 'i':
+		{
+			long arg;
+
+			if (spec->is_long)
+				arg = va_arg(*vp, long);
 			else
-			{ 
-				buf[0] = '\0';
-				return (0);
-			}
+				arg = tval.t == T_END ? va_arg(*vp, int) : tval.u.i;
+
+			if (arg < 0)
+				fmt_integer(out, spec, conv, width, prec,
+						0UL - (unsigned long)arg, TRUE);
+			else
+				fmt_integer(out, spec, conv, width, prec,
+						(unsigned long)arg, FALSE);
+			return TRUE;
 		}
 
-		/* Process the "format" symbol */
-		switch (aux[q-1])
+		/* Unsigned Integers -- various formats */
+		case 'u': case 'o': case 'x': case 'X':
 		{
-			/* Simple Character -- standard format */
-			case 'c':
-			{
-				int arg;
+			unsigned long arg;
 
-				/* Get the next argument */
-				arg = tval.t == T_END ? va_arg(vp, int) : tval.u.c;
+			if (spec->is_long)
+				arg = va_arg(*vp, unsigned long);
+			else
+				arg = va_arg(*vp, unsigned int);
 
-				/* Format the argument */
-				sprintf(tmp, aux, arg);
+			fmt_integer(out, spec, conv, width, prec, arg, FALSE);
+			return TRUE;
+		}
 
-				/* Done */
-				break;
-			}
+		/* String */
+		case 's':
+		{
+			size_t len = 0;
 
-			/* Signed Integers -- standard format */
-			case 'd': case 'i':
+			if (spec->is_long)
 			{
-				if (do_long)
-				{
-					long arg;
+				const wchar_t *arg = va_arg(*vp, const wchar_t *);
+				size_t pad;
 
-					/* Get the next argument */
-					arg = va_arg(vp, long);
+				/* Hack -- convert NULL to EMPTY */
+				if (!arg) arg = L"";
 
-					/* Format the argument */
-					sprintf(tmp, aux, arg);
-				}
-				else
-				{
-					int arg;
+				while ((prec < 0 || len < (size_t)prec) && arg[len])
+					len++;
 
-					/* Get the next argument */
-					arg = tval.t == T_END ? va_arg(vp, int) : tval.u.i;
+				pad = (width > 0 && (size_t)width > len) ? width - len : 0;
+				if (!(spec->flags & FMT_LEFT)) fmt_pad(out, ' ', pad);
 
-					/* Format the argument */
-					sprintf(tmp, aux, arg);
+				/* This really should use a wcstombs type function */
+				for (; *arg && len; arg++, len--)
+				{
+					char c = (char)*arg;
+					fmt_put(out, &c, 1);
 				}
 
-				/* Done */
-				break;
+				if (spec->flags & FMT_LEFT) fmt_pad(out, ' ', pad);
 			}
-
-			/* Unsigned Integers -- various formats */
-			case 'u': case 'o': case 'x': case 'X':
+			else
 			{
-				if (do_long)
-				{
-					unsigned long arg;
+				const char *arg;
 
-					/* Get the next argument */
-					arg = va_arg(vp, unsigned long);
+				arg = tval.t == T_END ? va_arg(*vp, const char *) : tval.u.s;
 
-					/* Format the argument */
-					sprintf(tmp, aux, arg);
-				}
+				/* Hack -- convert NULL to EMPTY */
+				if (!arg) arg = "";
+
+				/* Don't look past the precision */
+				if (prec < 0)
+					len = strlen(arg);
 				else
-				{
-					unsigned int arg;
+					while (len < (size_t)prec && arg[len]) len++;
 
-					/* Get the next argument */
-					arg = va_arg(vp, unsigned int);
+				fmt_string(out, spec, width, arg, len);
+			}
 
-					/* Format the argument */
-					sprintf(tmp, aux, arg);
-				}
+			return TRUE;
+		}
 
-				/* Done */
-				break;
-			}
+		/* Floating Point -- various formats */
+		case 'f': case 'F':
+		case 'e': case 'E':
+		case 'g': case 'G':
+		{
+			double arg = tval.t == T_END ? va_arg(*vp, double) : tval.u.f;
+			char aux[32];
+			char tmp[FMT_LIBC_MAX + 330];
 
-			/* Floating Point -- various formats */
-			case 'f':
-			case 'e': case 'E':
-			case 'g': case 'G':
-			{
-				double arg;
+			fmt_libc_spec(aux, spec, width, prec);
+			fmt_put(out, tmp, sprintf(tmp, aux, arg));
+			return TRUE;
+		}
 
-				/* Get the next argument */
-				arg = tval.t == T_END ? va_arg(vp, double) : tval.u.f;
+		/* Pointer -- implementation varies */
+		case 'p':
+		{
+			void *arg = va_arg(*vp, void *);
+			char aux[32];
+			char tmp[FMT_LIBC_MAX + 64];
 
-				/* Format the argument */
-				sprintf(tmp, aux, arg);
+			fmt_libc_spec(aux, spec, width, prec);
+			fmt_put(out, tmp, sprintf(tmp, aux, arg));
+			return TRUE;
+		}
+	}
 
-				/* Done */
-				break;
-			}
+	return FALSE;
+}
 
-			/* Pointer -- implementation varies */
-			case 'p':
-			{
-				void *arg;
 
-				/* Get the next argument */
-				arg = va_arg(vp, void*);
+/*
+ * A format string parsed by fmt_compile()
+ */
+struct fmt_compiled
+{
+	const char *key;		/* The format string it was parsed from */
+	char *text;			/* Copy of the format string */
+	struct fmt_spec *specs;		/* Its pieces, pointing into "text" */
+	size_t num;			/* Number of pieces */
+	bool bad;			/* The format string has an error */
+};
 
-				/* Format the argument */
-				sprintf(tmp, aux, arg);
+/*
+ * Number of parsed format strings kept, by address
+ */
+#define FMT_CACHE_SIZE 256
 
-				/* Done */
-				break;
-			}
+static struct fmt_compiled fmt_cache[FMT_CACHE_SIZE];
 
-			/* String */
-			case 's':
-			{
-				if (do_long)
-				{
-					const wchar_t *arg;
-					char arg2[1024];
-
-					/* XXX There is a big bug here: if one
-					 * passes "%.0s" to strnfmt, then really we
-					 * should not dereference the arg at all.
-					 * But it does.  See bug #666.
-					 */
-
-					/* Get the next argument */
-					arg = va_arg(vp, const wchar_t *);
-
-					/* Hack -- convert NULL to EMPTY */
-					if (!arg) arg = L"";
-
-					/* Format the argument */
-					/* snprintf should not be used in a snprintf replacement function
-					snprintf(tmp, sizeof(tmp), aux, arg); */
-					/* Prevent buffer overflows and convert string to char */
-					/* this really should use a wcstombs type function */
-					len = wcslen(arg);
-					if (len >= 768) {
-						len = 767;
-					}
-					for (i = 0; i < len; ++i) {
-						arg2[i] = (char)arg[i];
-					}
-					arg2[len] = '\0';
-
-					/* Remove the l from aux, since we no longer have wchar_t as input */
-					aux[q-2] = 's';
-					aux[q-1] = '\0';
-
-					/* Format the argument */
-					sprintf(tmp, aux, arg2);
-
-					/*if (my_strcpy((char*)arg2, (char*)arg, sizeof(arg2)) < 1024) {
-						sprintf(tmp, aux, arg2);
-					}*/
-
-					/* Done */
-					break;
-				}
-				else
-				{
-					const char *arg;
-					char arg2[1024];
+/*
+ * Forget a parsed format string.
+ */
+static void fmt_forget(struct fmt_compiled *c)
+{
+	string_free(c->text);
+	FREE(c->specs);
+	WIPE(c, struct fmt_compiled);
+}
 
-					/* XXX There is a big bug here: if one
-					 * passes "%.0s" to strnfmt, then really we
-					 * should not dereference the arg at all.
-					 * But it does.  See bug #666.
-					 */
+/*
+ * Parse "fmt" into "c".
+ */
+static void fmt_compile(struct fmt_compiled *c, const char *fmt)
+{
+	const char *s;
+	size_t alloc = 8;
 
-					/* Get the next argument */
-					arg = tval.t == T_END ? va_arg(vp, const char *) : tval.u.s;
+	fmt_forget(c);
 
-					/* Hack -- convert NULL to EMPTY */
-					if (!arg) arg = "";
+	c->key = fmt;
+	c->text = string_make(fmt);
+	c->specs = mem_zalloc(alloc * sizeof(*c->specs));
 
-					/* Format the argument */
-					/* snprintf should not be used in a snprintf replacement function
-					snprintf(tmp, sizeof(tmp), aux, arg); */
+	for (s = c->text; *s; )
+	{
+		if (c->num == alloc)
+		{
+			alloc *= 2;
+			c->specs = mem_realloc(c->specs, alloc * sizeof(*c->specs));
+		}
 
-					/* Prevent buffer overflows */
-					(void)my_strcpy(arg2, arg, sizeof(arg2));
+		s = fmt_parse(s, &c->specs[c->num]);
+		if (!s)
+		{
+			c->bad = TRUE;
+			return;
+		}
 
-					/* Format the argument */
-					sprintf(tmp, aux, arg2);
+		c->num++;
+	}
+}
 
-					/* Done */
-					break;
-				}
-			}
+/*
+ * Find the parsed form of "fmt", parsing it if it hasn't been seen.
+ *
+ * Format strings are nearly always string constants, so they are looked
+ * up by address; the copy of the text catches a buffer whose contents
+ * have changed since.
+ */
+static const struct fmt_compiled *fmt_lookup(const char *fmt)
+{
+	struct fmt_compiled *c;
 
-			/* Oops */
-			default:
-			{
-				/* Error -- illegal format char */
-				buf[0] = '\0';
+	c = &fmt_cache[((size_t)fmt >> 2) % FMT_CACHE_SIZE];
 
-				/* Return "error" */
-				return (0);
-			}
-		}
+	if (c->key != fmt || strcmp(c->text, fmt))
+		fmt_compile(c, fmt);
+
+	return c;
+}
+
+/*
+ * Forget all parsed format strings.
+ */
+static void fmt_cache_kill(void)
+{
+	int i;
+
+	for (i = 0; i < FMT_CACHE_SIZE; i++)
+		fmt_forget(&fmt_cache[i]);
+}
 
-		/* Now append "tmp" to "buf" */
-		for (q = 0; tmp[q]; q++)
+
+/*
+ * Basic "vararg" format function.
+ *
+ * This function takes a buffer, a max byte count, a format string, and
+ * a va_list of arguments to the format string, and uses the format string
+ * and the arguments to create a string to the buffer.  The string is
+ * derived from the format string and the arguments in the manner of the
+ * "sprintf()" function, but with some extra "format" commands.  Note that
+ * this function will never use more than the given number of bytes in the
+ * buffer, preventing messy invalid memory references.  This function then
+ * returns the total number of non-null bytes written into the buffer.
+ *
+ * Method: Let "str" be the (unlimited) created string, and let "len" be the
+ * smaller of "max-1" and "strlen(str)".  We copy the first "len" chars of
+ * "str" into "buf", place "\0" into buf[len], and return "len".
+ *
+ * In English, we do a sprintf() into "buf", a buffer with size "max",
+ * and we return the resulting value of "strlen(buf)", but we allow some
+ * special format commands, and we are more careful than "sprintf()".
+ *
+ * Typically, "max" is in fact the "size" of "buf", and thus represents
+ * the "number" of chars in "buf" which are ALLOWED to be used.  An
+ * alternative definition would have required "buf" to hold at least
+ * "max+1" characters, and would have used that extra character only
+ * in the case where "buf" was too short for the result.  This would
+ * give an easy test for "overflow", but a less "obvious" semantics.
+ *
+ * Note that if the buffer was "too short" to hold the result, we will
+ * always return "max-1", but we also return "max-1" if the buffer was
+ * "just long enough".  We could have returned "max" if the buffer was
+ * too short, not written a null, and forced the programmer to deal with
+ * this special case, but I felt that it is better to at least give a
+ * "usable" result when the buffer was too long instead of either giving
+ * a memory overwrite like "sprintf()" or a non-terminted string like
+ * "strncpy()".  Note that "strncpy()" also "null-pads" the result.
+ *
+ * Note that in most cases "just long enough" is probably "too short".
+ *
+ * Format strings are parsed once and kept by address (see fmt_lookup()),
+ * and integers, characters and strings are converted by hand, so only
+ * floats and pointers go through "sprintf()".  The cache makes this
+ * function unsafe to call from more than one thread; "vstrnfmt_r()"
+ * gives the same results without it.
+ *
+ * Error detection in this routine is not very graceful, in particular,
+ * if an error is detected in the format string, we simply "pre-terminate"
+ * the given buffer to a length of zero, and return a "length" of zero.
+ * The contents of "buf", except for "buf[0]", may then be undefined.
+ */
+size_t vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp)
+{
+	const struct fmt_compiled *c;
+	struct fmt_out out;
+	va_list args;
+	size_t i;
+
+	assert(max);
+	assert(fmt);
+
+	c = fmt_lookup(fmt);
+
+	/* Error -- bad format string */
+	if (c->bad)
+	{
+		buf[0] = '\0';
+		return (0);
+	}
+
+	out.buf = buf;
+	out.n = 0;
+	out.end = max - 1;
+
+	VA_COPY(args, vp);
+
+	for (i = 0; i < c->num && out.n < out.end; i++)
+	{
+		/* Error -- bad argument */
+		if (!fmt_apply(&out, &c->specs[i], &args))
 		{
-			/* Check total length */
-			if (n == max-1) break;
+			out.n = 0;
+			break;
+		}
+	}
+
+	va_end(args);
+
+	/* Terminate buffer */
+	buf[out.n] = '\0';
+
+	/* Return length */
+	return (out.n);
+}
+
+
+/*
+ * As "vstrnfmt()", but parsing the format string as it goes rather than
+ * keeping it, so that it touches nothing but "buf" and may be called
+ * from any thread.
+ */
+size_t vstrnfmt_r(char *buf, size_t max, const char *fmt, va_list vp)
+{
+	struct fmt_spec spec;
+	struct fmt_out out;
+	va_list args;
+	const char *s = fmt;
+
+	assert(max);
+	assert(fmt);
+
+	out.buf = buf;
+	out.n = 0;
+	out.end = max - 1;
+
+	VA_COPY(args, vp);
 
-			/* Save the character */
-			buf[n++] = tmp[q];
+	while (*s && out.n < out.end)
+	{
+		s = fmt_parse(s, &spec);
+
+		/* Error -- bad format string or argument */
+		if (!s || !fmt_apply(&out, &spec, &args))
+		{
+			out.n = 0;
+			break;
 		}
 	}
 
+	va_end(args);
 
 	/* Terminate buffer */
-	buf[n] = '\0';
+	buf[out.n] = '\0';
 
 	/* Return length */
-	return (n);
+	return (out.n);
+}
+
+
+/*
+ * Do a vstrnfmt_r() into a buffer of a given size.
+ */
+size_t strnfmt_r(char *buf, size_t max, const char *fmt, ...)
+{
+	size_t len;
+	va_list vp;
+
+	va_start(vp, fmt);
+	len = vstrnfmt_r(buf, max, fmt, vp);
+	va_end(vp);
+
+	return (len);
 }
 
 
@@ -670,9 +926,13 @@ char *vformat(const char *fmt, va_list vp)
 	return (format_buf);
 }
 
+/*
+ * Free the format buffer and the parsed format strings.
+ */
 void vformat_kill(void)
 {
 	FREE(format_buf);
+	fmt_cache_kill();
 }
 
 
@@ -31,6 +31,12 @@ extern size_t vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp);
 /* Simple interface to "vstrnfmt()" */
 extern size_t strnfmt(char *buf, size_t max, const char *fmt, ...);
 
+/* As "vstrnfmt()", but safe to call from any thread */
+extern size_t vstrnfmt_r(char *buf, size_t max, const char *fmt, va_list vp);
+
+/* Simple interface to "vstrnfmt_r()" */
+extern size_t strnfmt_r(char *buf, size_t max, const char *fmt, ...);
+
 /* Format arguments into a static resizing buffer */
 extern char *vformat(const char *fmt, va_list vp);
 
@@ -74,6 +74,27 @@ static u32b WELLRNG1024a (void){
 	state_i = (state_i + 31) & 0x0000001fU;
 	return STATE[state_i];
 }
+
+/*
+ * The same generator, working on a stream's state rather than the globals.
+ */
+#define SV0    s->state[s->i]
+#define SVM1   s->state[(s->i + M1) & 0x0000001fU]
+#define SVM2   s->state[(s->i + M2) & 0x0000001fU]
+#define SVM3   s->state[(s->i + M3) & 0x0000001fU]
+#define SVRm1  s->state[(s->i + 31) & 0x0000001fU]
+
+static u32b rand_stream_next(struct rand_stream *s) {
+	u32b t0, t1, t2;
+
+	t0      = SVRm1;
+	t1      = Identity(SV0) ^ MAT0POS (8, SVM1);
+	t2      = MAT0NEG (-19, SVM2) ^ MAT0NEG(-14,SVM3);
+	SV0     = t1 ^ t2;
+	SVRm1   = MAT0NEG (-11,t0) ^ MAT0NEG(-7,t1) ^ MAT0NEG(-13,t2);
+	s->i    = (s->i + 31) & 0x0000001fU;
+	return s->state[s->i];
+}
 /* end WELL RNG */
 
 /*
@@ -95,6 +116,19 @@ u32b Rand_value;
 static bool rand_fixed = FALSE;
 static u32b rand_fixval = 0;
 
+/**
+ * The stream the "complex" RNG draws from, or NULL for the game's own state.
+ */
+static struct rand_stream *Rand_stream = NULL;
+
+/**
+ * Get the next number from the "complex" RNG.
+ */
+static u32b rand_next(void) {
+	if (Rand_stream) return rand_stream_next(Rand_stream);
+	return WELLRNG1024a();
+}
+
 /**
  * Initialize the complex RNG using a new seed.
  */
@@ -165,7 +199,7 @@ u32b Rand_div(u32b m) {
 		/* Use a complex RNG */
 		while (1) {
 			/* Get the next pseudorandom number */
-			r = WELLRNG1024a();
+			r = rand_next();
 
 			/* Mutate a 28-bit "random" number */
 			r = ((r >> 4) & 0x0FFFFFFF) / n;
@@ -289,15 +323,48 @@ s16b Rand_normal(int mean, int stand) {
 
 /**
  * Generates damage for "2d6" style dice rolls
+ *
+ * This rolls the dice exactly as a randint1(sides) per die would, but works
+ * out the partition once and draws straight from the generator.
  */
 int damroll(int num, int sides) {
 	int i;
 	int sum = 0;
+	u32b n, r;
 
 	if (sides <= 0) return 0;
 
-	for (i = 0; i < num; i++)
-		sum += randint1(sides);
+	/* Hack -- no randomness to be had */
+	if (sides == 1) return MAX(num, 0);
+
+	if (rand_fixed) {
+		for (i = 0; i < num; i++)
+			sum += randint1(sides);
+		return sum;
+	}
+
+	assert((u32b)sides <= 0x10000000);
+	n = 0x10000000 / sides;
+
+	if (Rand_quick) {
+		for (i = 0; i < num; i++) {
+			do {
+				r = (Rand_value = LCRNG(Rand_value));
+				r = ((r >> 4) & 0x0FFFFFFF) / n;
+			} while (r >= (u32b)sides);
+
+			sum += r + 1;
+		}
+	} else {
+		for (i = 0; i < num; i++) {
+			do {
+				r = ((rand_next() >> 4) & 0x0FFFFFFF) / n;
+			} while (r >= (u32b)sides);
+
+			sum += r + 1;
+		}
+	}
+
 	return sum;
 }
 
@@ -468,6 +535,106 @@ void rand_fix(u32b val) {
 	rand_fixval = val;
 }
 
+
+/**
+ * Initialise a stream from a seed, in the same way as Rand_state_init().
+ */
+void rand_stream_init(struct rand_stream *s, u32b seed) {
+	int i, j;
+
+	s->i = 0;
+	s->state[0] = seed;
+
+	for (i = 1; i < RAND_DEG; i++)
+		s->state[i] = LCRNG(s->state[i - 1]);
+
+	for (i = 0; i < RAND_DEG * 10; i++) {
+		j = (s->i + 1) % RAND_DEG;
+		s->state[j] += s->state[s->i];
+		s->i = j;
+	}
+}
+
+/**
+ * Scramble a 32-bit number (the finaliser of MurmurHash3).
+ */
+static u32b rand_mix(u32b x) {
+	x ^= x >> 16;
+	x *= 0x85ebca6bU;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35U;
+	x ^= x >> 16;
+	return x;
+}
+
+/**
+ * Split a new stream off `s`, seeding all of its state from `s`.
+ *
+ * Each word of the new state is scrambled separately, so that the child's
+ * state isn't a stretch of the parent's output, and the child is run for a
+ * while before use.  Splitting the same stream in the same state always gives
+ * the same child, so a set of streams split off one seed is reproducible.
+ */
+void rand_stream_split(struct rand_stream *s, struct rand_stream *child) {
+	int i;
+
+	child->i = 0;
+	for (i = 0; i < RAND_DEG; i++)
+		child->state[i] = rand_mix(rand_stream_next(s) + 0x9e3779b9U * i);
+
+	for (i = 0; i < RAND_DEG * 10; i++)
+		(void)rand_stream_next(child);
+}
+
+/**
+ * Extract a number from 0 to m - 1 from a stream, as Rand_div() does.
+ */
+u32b rand_stream_div(struct rand_stream *s, u32b m) {
+	u32b r, n;
+
+	assert(m <= 0x10000000);
+	if (m <= 1) return 0;
+
+	n = 0x10000000 / m;
+	do {
+		r = ((rand_stream_next(s) >> 4) & 0x0FFFFFFF) / n;
+	} while (r >= m);
+
+	return r;
+}
+
+/**
+ * Fill `buf` with `n` raw 32-bit numbers from a stream, or from the
+ * "complex" RNG if `s` is NULL.
+ */
+void rand_fill_u32(struct rand_stream *s, u32b *buf, size_t n) {
+	size_t k;
+
+	if (!s) s = Rand_stream;
+
+	if (s) {
+		for (k = 0; k < n; k++)
+			buf[k] = rand_stream_next(s);
+	} else {
+		for (k = 0; k < n; k++)
+			buf[k] = WELLRNG1024a();
+	}
+}
+
+/**
+ * Make the "complex" RNG draw from `s` (or from the game's own state if `s`
+ * is NULL), returning the stream it drew from before.
+ *
+ * This lets a subsystem such as level generation keep its own stream without
+ * any of the code it calls having to know about it.
+ */
+struct rand_stream *rand_stream_use(struct rand_stream *s) {
+	struct rand_stream *old = Rand_stream;
+
+	Rand_stream = s;
+	return old;
+}
+
 int getpid(void);
 
 /**
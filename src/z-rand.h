@@ -22,6 +22,15 @@ typedef struct random {
  */
 #define RAND_DEG 32
 
+/**
+ * A random number stream, using the same generator as the "complex" RNG but
+ * with state of its own.
+ */
+struct rand_stream {
+	u32b i;
+	u32b state[RAND_DEG];
+};
+
 /* Random aspects used by damcalc, m_bonus_calc, and ranvals */
 typedef enum {
 	MINIMISE,
@@ -151,4 +160,31 @@ bool randcalc_varies(random_value v);
 
 extern void rand_fix(u32b val);
 
+/**
+ * Initialise a stream from a seed.
+ */
+void rand_stream_init(struct rand_stream *s, u32b seed);
+
+/**
+ * Seed `child` from `s`, giving a new stream independent of its parent.
+ */
+void rand_stream_split(struct rand_stream *s, struct rand_stream *child);
+
+/**
+ * Generates a random number X from a stream where "0 <= X < M" holds.
+ */
+u32b rand_stream_div(struct rand_stream *s, u32b m);
+
+/**
+ * Fill a buffer with raw random numbers from a stream (or the "complex" RNG
+ * if `s` is NULL).
+ */
+void rand_fill_u32(struct rand_stream *s, u32b *buf, size_t n);
+
+/**
+ * Make the "complex" RNG use a stream (NULL for the game's own state),
+ * returning the stream it used before.
+ */
+struct rand_stream *rand_stream_use(struct rand_stream *s);
+
 #endif /* INCLUDED_Z_RAND_H */
@@ -29,12 +29,38 @@
 #define TEXTBLOCK_LEN_INITIAL		128
 #define TEXTBLOCK_LEN_INCR(x)		((x) + 128)
 
+/* Number of widths a textblock keeps line breaks for */
+#define TEXTBLOCK_LAYOUTS		2
+
+/**
+ * Line breaks for one width.  Text is only ever appended, so the breaks
+ * are worked out as far as "scanned" and the scan picks up from there
+ * when more text arrives.
+ */
+struct textblock_layout {
+	size_t width;		/* Zero if unused */
+	unsigned int used;	/* When it was last asked for */
+
+	size_t *line_starts;
+	size_t *line_lengths;
+	size_t n_lines;
+	size_t size;		/* Room in line_starts and line_lengths */
+
+	/* Where the scan got to, and its state there */
+	size_t scanned;
+	size_t line_start, line_length;
+	size_t word_start, word_length;
+};
+
 struct textblock {
 	wchar_t *text;
 	byte *attrs;
 
 	size_t strlen;
 	size_t size;
+
+	struct textblock_layout layouts[TEXTBLOCK_LAYOUTS];
+	unsigned int layout_clock;
 };
 
 
@@ -57,6 +83,13 @@ textblock *textblock_new(void)
  */
 void textblock_free(textblock *tb)
 {
+	int i;
+
+	for (i = 0; i < TEXTBLOCK_LAYOUTS; i++) {
+		mem_free(tb->layouts[i].line_starts);
+		mem_free(tb->layouts[i].line_lengths);
+	}
+
 	mem_free(tb->text);
 	mem_free(tb->attrs);
 	mem_free(tb);
@@ -202,53 +235,50 @@ const byte *textblock_attrs(textblock *tb)
 	return tb->attrs;
 }
 
-static void new_line(size_t **line_starts, size_t **line_lengths,
-		size_t *n_lines, size_t *cur_line,
-		size_t start, size_t len)
+static void new_line(struct textblock_layout *layout, size_t start, size_t len)
 {
-	if (*cur_line == *n_lines) {
+	if (layout->n_lines == layout->size) {
 		/* this number is not arbitrary: it's the height of a "standard" term */
-		(*n_lines) += 24;
+		layout->size += 24;
 
-		*line_starts = mem_realloc(*line_starts,
-				*n_lines * sizeof **line_starts);
-		*line_lengths = mem_realloc(*line_lengths,
-				*n_lines * sizeof **line_lengths);
+		layout->line_starts = mem_realloc(layout->line_starts,
+				layout->size * sizeof *layout->line_starts);
+		layout->line_lengths = mem_realloc(layout->line_lengths,
+				layout->size * sizeof *layout->line_lengths);
 	}
 
-	(*line_starts)[*cur_line] = start;
-	(*line_lengths)[*cur_line] = len;
+	layout->line_starts[layout->n_lines] = start;
+	layout->line_lengths[layout->n_lines] = len;
 
-	(*cur_line)++;
+	layout->n_lines++;
 }
 
 /**
- * Given a certain width, split a textblock into wrapped lines of text.
- *
- * \returns Number of lines in output.
+ * Carry on splitting a textblock into wrapped lines from wherever the
+ * layout got to last time.
  */
-size_t textblock_calculate_lines(textblock *tb,
-		size_t **line_starts, size_t **line_lengths, size_t width)
+static void textblock_scan(textblock *tb, struct textblock_layout *layout)
 {
 	const wchar_t *text = tb->text;
-
-	size_t cur_line = 0, n_lines = 0;
+	size_t width = layout->width;
 
 	size_t len = tb->strlen;
 	size_t text_offset;
 
-	size_t line_start = 0, line_length = 0;
-	size_t word_start = 0, word_length = 0;
-
-	assert(width > 0);
+	size_t line_start = layout->line_start;
+	size_t line_length = layout->line_length;
+	size_t word_start = layout->word_start;
+	size_t word_length = layout->word_length;
 
-	for (text_offset = 0; text_offset < len; text_offset++) {
+	for (text_offset = layout->scanned; text_offset < len; text_offset++) {
 		if (text[text_offset] == L'\n') {
-			new_line(line_starts, line_lengths, &n_lines, &cur_line,
-					line_start, line_length);
+			new_line(layout, line_start, line_length);
 
 			line_start = text_offset + 1;
 			line_length = 0;
+
+			/* words don't carry over a newline */
+			word_start = word_length = 0;
 		} else if (text[text_offset] == L' ') {
 			line_length++;
 
@@ -261,28 +291,135 @@ size_t textblock_calculate_lines(textblock *tb,
 
 		/* special case: if we have a very long word, just slice it */
 		if (word_length == width) {
-			new_line(line_starts, line_lengths, &n_lines, &cur_line,
-					line_start, line_length);
+			new_line(layout, line_start, line_length);
 
 			line_start += line_length;
 			line_length = 0;
+
+			/* the rest of the word starts afresh */
+			word_start = word_length = 0;
 		}
 
 		/* normal wrapping: wrap text at last word */
 		if (line_length == width) {
-			size_t last_word_offset = word_start;
+			/* a space that fills the line is the last one; don't look
+			 * past it at text that may not be there yet */
+			size_t last_word_offset = word_length ? word_start : word_start - 1;
 			while (text[line_start + last_word_offset] != L' ')
 				last_word_offset--;
 
-			new_line(line_starts, line_lengths, &n_lines, &cur_line,
-					line_start, last_word_offset);
+			new_line(layout, line_start, last_word_offset);
 
 			line_start += word_start;
 			line_length = word_length;
+
+			/* the new line starts with the current word */
+			word_start = 0;
 		}
 	}
 
-	return cur_line;
+	layout->scanned = len;
+	layout->line_start = line_start;
+	layout->line_length = line_length;
+	layout->word_start = word_start;
+	layout->word_length = word_length;
+}
+
+/**
+ * Find the line breaks of a textblock for a given width, working out any
+ * that haven't been yet.  The least recently used width is dropped to make
+ * room for a new one.
+ */
+static struct textblock_layout *textblock_layout(textblock *tb, size_t width)
+{
+	struct textblock_layout *layout = NULL;
+	int i;
+
+	assert(width > 0);
+
+	for (i = 0; i < TEXTBLOCK_LAYOUTS; i++) {
+		struct textblock_layout *l = &tb->layouts[i];
+
+		if (l->width == width) {
+			layout = l;
+			break;
+		}
+
+		if (!layout || l->used < layout->used)
+			layout = l;
+	}
+
+	/* Start again at the new width */
+	if (layout->width != width) {
+		layout->width = width;
+		layout->n_lines = 0;
+		layout->scanned = 0;
+		layout->line_start = layout->line_length = 0;
+		layout->word_start = layout->word_length = 0;
+	}
+
+	layout->used = ++tb->layout_clock;
+
+	if (layout->scanned < tb->strlen)
+		textblock_scan(tb, layout);
+
+	return layout;
+}
+
+/**
+ * Given a certain width, split a textblock into wrapped lines of text.
+ *
+ * The caller gets its own copy of the line breaks, and must free them;
+ * textblock_lines() and textblock_line() read them in place.
+ *
+ * \returns Number of lines in output.
+ */
+size_t textblock_calculate_lines(textblock *tb,
+		size_t **line_starts, size_t **line_lengths, size_t width)
+{
+	struct textblock_layout *layout = textblock_layout(tb, width);
+	size_t n_lines = layout->n_lines;
+
+	if (n_lines) {
+		*line_starts = mem_realloc(*line_starts, n_lines * sizeof **line_starts);
+		*line_lengths = mem_realloc(*line_lengths, n_lines * sizeof **line_lengths);
+
+		memcpy(*line_starts, layout->line_starts, n_lines * sizeof **line_starts);
+		memcpy(*line_lengths, layout->line_lengths, n_lines * sizeof **line_lengths);
+	}
+
+	return n_lines;
+}
+
+/**
+ * Return the number of lines a textblock wraps to at a given width.
+ */
+size_t textblock_lines(textblock *tb, size_t width)
+{
+	return textblock_layout(tb, width)->n_lines;
+}
+
+/**
+ * Point `line` at line `n` of a textblock wrapped to a given width,
+ * without copying it.  The pointers stay good until the textblock is
+ * next appended to.
+ *
+ * \returns FALSE if there is no such line.
+ */
+bool textblock_line(textblock *tb, size_t width, size_t n,
+		struct textblock_line *line)
+{
+	struct textblock_layout *layout = textblock_layout(tb, width);
+	size_t start;
+
+	if (n >= layout->n_lines) return FALSE;
+
+	start = layout->line_starts[n];
+	line->text = tb->text + start;
+	line->attrs = tb->attrs + start;
+	line->len = layout->line_lengths[n];
+
+	return TRUE;
 }
 
 /**
@@ -290,24 +427,17 @@ size_t textblock_calculate_lines(textblock *tb,
  */
 void textblock_to_file(textblock *tb, ang_file *f, int indent, int wrap_at)
 {
-	size_t *line_starts = NULL;
-	size_t *line_lengths = NULL;
-
-	size_t n_lines, i;
+	struct textblock_line line;
+	size_t i;
 
 	int width = wrap_at - indent;
 	assert(width > 0);
 
-	n_lines = textblock_calculate_lines(tb, &line_starts, &line_lengths, width);
-
-	for (i = 0; i < n_lines; i++) {
+	for (i = 0; textblock_line(tb, width, i, &line); i++) {
 		/* For some reason, the %*c part of the format string was still indenting, even when indent was zero */
 		if (indent == 0)
-			file_putf(f, "%.*ls\n", line_lengths[i], tb->text + line_starts[i]);
+			file_putf(f, "%.*ls\n", line.len, line.text);
 		else
-			file_putf(f, "%*c%.*ls\n", indent, ' ', line_lengths[i], tb->text + line_starts[i]);
+			file_putf(f, "%*c%.*ls\n", indent, ' ', line.len, line.text);
 	}
-
-	mem_free(line_starts);
-	mem_free(line_lengths);
 }
@@ -7,6 +7,13 @@
 /** Opaque text_block type */
 typedef struct textblock textblock;
 
+/** One wrapped line of a textblock, pointing into its text */
+struct textblock_line {
+	const wchar_t *text;
+	const byte *attrs;
+	size_t len;
+};
+
 
 textblock *textblock_new(void);
 void textblock_free(textblock *tb);
@@ -20,6 +27,8 @@ const wchar_t *textblock_text(textblock *tb);
 const byte *textblock_attrs(textblock *tb);
 
 size_t textblock_calculate_lines(textblock *tb, size_t **line_starts, size_t **line_lengths, size_t width);
+size_t textblock_lines(textblock *tb, size_t width);
+bool textblock_line(textblock *tb, size_t width, size_t n, struct textblock_line *line);
 
 void textblock_to_file(textblock *tb, ang_file *f, int indent, int wrap_at);
 